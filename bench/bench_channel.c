@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <triggerfish.h>
+
+#define MESSAGES    1000000
+#define CAPACITY    1024
+#define BATCH       16
+
+static void on_destroy(void *instance) {
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/* mutex protected queue which retains on enqueue and releases on dequeue */
+struct queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    struct triggerfish_strong *items[CAPACITY];
+    uintmax_t head;
+    uintmax_t tail;
+};
+
+static void queue_push(struct queue *queue, struct triggerfish_strong *item) {
+    triggerfish_strong_retain(item);
+    pthread_mutex_lock(&queue->lock);
+    while (queue->tail - queue->head == CAPACITY) {
+        pthread_cond_wait(&queue->not_full, &queue->lock);
+    }
+    queue->items[queue->tail++ % CAPACITY] = item;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+static void queue_pop(struct queue *queue) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->tail == queue->head) {
+        pthread_cond_wait(&queue->not_empty, &queue->lock);
+    }
+    struct triggerfish_strong *item = queue->items[queue->head++ % CAPACITY];
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+    triggerfish_strong_release(item);
+}
+
+enum kind {
+    MUTEX,
+    CHANNEL,
+    CHANNEL_BATCH,
+    UNBOUNDED,
+    UNBOUNDED_BATCH
+};
+
+struct run {
+    enum kind kind;
+    uintmax_t messages;
+    struct triggerfish_strong **items;
+    struct queue *queue;
+    struct triggerfish_channel *channel;
+    struct triggerfish_unbounded_channel *unbounded;
+};
+
+static void *produce(void *arg) {
+    struct run *run = arg;
+    for (uintmax_t i = 0; i < run->messages;) {
+        uintmax_t count = 1;
+        switch (run->kind) {
+            case MUTEX: {
+                queue_push(run->queue, run->items[i]);
+                break;
+            }
+            case CHANNEL: {
+                while (triggerfish_channel_send(run->channel, run->items[i])) {
+                    sched_yield();
+                }
+                break;
+            }
+            case CHANNEL_BATCH: {
+                const uintmax_t left = run->messages - i;
+                while (triggerfish_channel_send_batch(
+                        run->channel, run->items + i,
+                        left < BATCH ? left : BATCH, &count)) {
+                    sched_yield();
+                }
+                break;
+            }
+            case UNBOUNDED: {
+                triggerfish_unbounded_channel_send(run->unbounded,
+                                                   run->items[i]);
+                break;
+            }
+            case UNBOUNDED_BATCH: {
+                const uintmax_t left = run->messages - i;
+                count = left < BATCH ? left : BATCH;
+                triggerfish_unbounded_channel_send_batch(
+                        run->unbounded, run->items + i, count);
+                break;
+            }
+        }
+        i += count;
+    }
+    return NULL;
+}
+
+static void *consume(void *arg) {
+    struct run *run = arg;
+    struct triggerfish_strong *items[BATCH];
+    for (uintmax_t i = 0; i < run->messages;) {
+        const uintmax_t left = run->messages - i;
+        const uintmax_t batch = left < BATCH ? left : BATCH;
+        uintmax_t count = 1;
+        switch (run->kind) {
+            case MUTEX: {
+                queue_pop(run->queue);
+                break;
+            }
+            case CHANNEL: {
+                while (triggerfish_channel_receive(run->channel, items)) {
+                    sched_yield();
+                }
+                break;
+            }
+            case CHANNEL_BATCH: {
+                while (triggerfish_channel_receive_batch(
+                        run->channel, items, batch, &count)) {
+                    sched_yield();
+                }
+                break;
+            }
+            case UNBOUNDED: {
+                while (triggerfish_unbounded_channel_receive(
+                        run->unbounded, items)) {
+                    sched_yield();
+                }
+                break;
+            }
+            case UNBOUNDED_BATCH: {
+                while (triggerfish_unbounded_channel_receive_batch(
+                        run->unbounded, items, batch, &count)) {
+                    sched_yield();
+                }
+                break;
+            }
+        }
+        i += count;
+    }
+    return NULL;
+}
+
+static void measure(const char *name, const enum kind kind,
+                    const uintmax_t producers, const uintmax_t consumers) {
+    struct queue queue = {
+            .lock = PTHREAD_MUTEX_INITIALIZER,
+            .not_empty = PTHREAD_COND_INITIALIZER,
+            .not_full = PTHREAD_COND_INITIALIZER
+    };
+    struct run run = {
+            .kind = kind,
+            .queue = &queue
+    };
+    if (triggerfish_channel_of(CAPACITY, &run.channel)
+        || triggerfish_unbounded_channel_of(&run.unbounded)
+        || !(run.items = malloc(MESSAGES * sizeof(*run.items)))) {
+        abort();
+    }
+    for (uintmax_t i = 0; i < MESSAGES; i++) {
+        if (triggerfish_strong_of(malloc(1), on_destroy, &run.items[i])) {
+            abort();
+        }
+    }
+    struct run producer[producers];
+    struct run consumer[consumers];
+    pthread_t threads[producers + consumers];
+    const double start = now();
+    for (uintmax_t i = 0; i < producers; i++) {
+        producer[i] = run;
+        producer[i].messages = MESSAGES / producers;
+        producer[i].items += i * producer[i].messages;
+        pthread_create(&threads[i], NULL, produce, &producer[i]);
+    }
+    for (uintmax_t i = 0; i < consumers; i++) {
+        consumer[i] = run;
+        consumer[i].messages = MESSAGES / consumers;
+        pthread_create(&threads[producers + i], NULL, consume, &consumer[i]);
+    }
+    for (uintmax_t i = 0; i < producers + consumers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    const double elapsed = now() - start;
+    printf("%-24s %ju:%ju %10.2f ns/message\n", name, producers, consumers,
+           elapsed * 1e9 / MESSAGES);
+    /* the channels only moved the references, they are still owned here */
+    for (uintmax_t i = 0; i < MESSAGES; i++) {
+        triggerfish_strong_release(run.items[i]);
+    }
+    free(run.items);
+    triggerfish_unbounded_channel_destroy(run.unbounded);
+    triggerfish_channel_destroy(run.channel);
+}
+
+int main(int argc, char *argv[]) {
+    printf("%d messages, capacity %d, batch %d\n", MESSAGES, CAPACITY, BATCH);
+    measure("mutex queue", MUTEX, 1, 1);
+    measure("channel", CHANNEL, 1, 1);
+    measure("channel batch", CHANNEL_BATCH, 1, 1);
+    measure("mutex queue", MUTEX, 4, 4);
+    measure("channel", CHANNEL, 4, 4);
+    measure("channel batch", CHANNEL_BATCH, 4, 4);
+    measure("mutex queue", MUTEX, 4, 1);
+    measure("unbounded channel", UNBOUNDED, 4, 1);
+    measure("unbounded batch", UNBOUNDED_BATCH, 4, 1);
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <triggerfish.h>
+
+#define ITERATIONS  1000000
+#define SHARES      4
+
+static void on_destroy(void *instance) {
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, const double start) {
+    const double elapsed = now() - start;
+    printf("%-24s %10.2f ns/op\n", name, elapsed * 1e9 / ITERATIONS);
+}
+
+static void strong_lifecycle(void) {
+    const double start = now();
+    for (uintmax_t i = 0; i < ITERATIONS; i++) {
+        struct triggerfish_strong *object;
+        if (triggerfish_strong_of(malloc(1), on_destroy, &object)) {
+            abort();
+        }
+        for (uintmax_t j = 0; j < SHARES; j++) {
+            triggerfish_strong_retain(object);
+        }
+        for (uintmax_t j = 0; j < SHARES; j++) {
+            triggerfish_strong_release(object);
+        }
+        triggerfish_strong_release(object);
+    }
+    report("strong", start);
+}
+
+static void local_lifecycle(void) {
+    const double start = now();
+    for (uintmax_t i = 0; i < ITERATIONS; i++) {
+        struct triggerfish_local *object;
+        if (triggerfish_local_of(malloc(1), on_destroy, &object)) {
+            abort();
+        }
+        for (uintmax_t j = 0; j < SHARES; j++) {
+            triggerfish_local_retain(object);
+        }
+        for (uintmax_t j = 0; j < SHARES; j++) {
+            triggerfish_local_release(object);
+        }
+        triggerfish_local_release(object);
+    }
+    report("local", start);
+}
+
+static void unique_lifecycle(void) {
+    const double start = now();
+    for (uintmax_t i = 0; i < ITERATIONS; i++) {
+        struct triggerfish_unique *object;
+        if (triggerfish_unique_of(malloc(1), on_destroy, &object)) {
+            abort();
+        }
+        triggerfish_unique_destroy(object);
+    }
+    report("unique", start);
+}
+
+static void unique_published_lifecycle(void) {
+    const double start = now();
+    for (uintmax_t i = 0; i < ITERATIONS; i++) {
+        struct triggerfish_unique *object;
+        if (triggerfish_unique_of(malloc(1), on_destroy, &object)) {
+            abort();
+        }
+        struct triggerfish_strong *strong;
+        if (triggerfish_unique_strong(object, &strong)) {
+            abort();
+        }
+        triggerfish_strong_release(strong);
+    }
+    report("unique -> strong", start);
+}
+
+int main(int argc, char *argv[]) {
+    printf("create, %d x retain/release, destroy\n", SHARES);
+    strong_lifecycle();
+    local_lifecycle();
+    unique_lifecycle();
+    unique_published_lifecycle();
+    return 0;
+}
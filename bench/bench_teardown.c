@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <triggerfish.h>
+
+#define FANOUT      8
+#define DEPTH       6
+#define ROUNDS      5
+
+struct node {
+    struct triggerfish_strong *children[FANOUT];
+    /* some work per instance, as a destructor would */
+    unsigned char payload[64];
+};
+
+static void on_destroy(void *instance) {
+    struct node *const node = instance;
+    for (size_t i = 0; i < FANOUT; i++) {
+        if (node->children[i]) {
+            triggerfish_strong_release(node->children[i]);
+        }
+    }
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static struct triggerfish_strong *tree_of(const uintmax_t depth,
+                                          uintmax_t *const count) {
+    struct node *const node = calloc(1, sizeof(*node));
+    struct triggerfish_strong *out;
+    if (triggerfish_strong_of(node, on_destroy, &out)) {
+        abort();
+    }
+    (*count)++;
+    for (size_t i = 0; depth && i < FANOUT; i++) {
+        node->children[i] = tree_of(depth - 1, count);
+    }
+    return out;
+}
+
+static void report(const char *name, const size_t workers,
+                   const double elapsed, const double baseline,
+                   const uintmax_t count) {
+    printf("%-10s %2zu workers %10.2f ms %8.2f ns/instance %6.2fx\n",
+           name, workers, elapsed * 1e3 / ROUNDS,
+           elapsed * 1e9 / ROUNDS / (double) count, baseline / elapsed);
+}
+
+static double plain(uintmax_t *const count) {
+    double elapsed = 0;
+    for (uintmax_t i = 0; i < ROUNDS; i++) {
+        *count = 0;
+        struct triggerfish_strong *const strong = tree_of(DEPTH, count);
+        const double start = now();
+        triggerfish_strong_release(strong);
+        elapsed += now() - start;
+    }
+    return elapsed;
+}
+
+static double teardown(const size_t workers) {
+    struct triggerfish_teardown *object;
+    if (triggerfish_teardown_of(workers, &object)) {
+        abort();
+    }
+    double elapsed = 0;
+    for (uintmax_t i = 0; i < ROUNDS; i++) {
+        uintmax_t count = 0;
+        struct triggerfish_strong *const strong = tree_of(DEPTH, &count);
+        const double start = now();
+        triggerfish_teardown_release(object, strong);
+        elapsed += now() - start;
+    }
+    triggerfish_teardown_destroy(object);
+    return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    uintmax_t count;
+    const double baseline = plain(&count);
+    printf("release tree of %ju instances\n", count);
+    report("release", 1, baseline, baseline, count);
+    for (size_t workers = 1; workers <= 8; workers *= 2) {
+        report("teardown", workers, teardown(workers), baseline, count);
+    }
+    return 0;
+}
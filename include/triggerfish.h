@@ -6,6 +6,24 @@
 #include <stdint.h>
 
 #include <triggerfish/strong.h>
+#ifndef TRIGGERFISH_NO_WEAK
 #include <triggerfish/weak.h>
+#include <triggerfish/soft_cache.h>
+#include <triggerfish/soft.h>
+#include <triggerfish/reference_queue.h>
+#endif
+#include <triggerfish/region.h>
+#include <triggerfish/local.h>
+#include <triggerfish/unique.h>
+#include <triggerfish/weighted.h>
+#include <triggerfish/pool.h>
+#include <triggerfish/lazy.h>
+#include <triggerfish/teardown.h>
+#include <triggerfish/channel.h>
+#include <triggerfish/unbounded_channel.h>
+#include <triggerfish/vector.h>
+#include <triggerfish/map.h>
+#include <triggerfish/shared.h>
+#include <triggerfish/heap.h>
 
 #endif /* _TRIGGERFISH_TRIGGERFISH_H_ */
@@ -0,0 +1,143 @@
+#ifndef _TRIGGERFISH_CHANNEL_H_
+#define _TRIGGERFISH_CHANNEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_CHANNEL_ERROR_CAPACITY_IS_ZERO \
+    SEA_URCHIN_ERROR_VALUE_IS_ZERO
+#define TRIGGERFISH_CHANNEL_ERROR_CAPACITY_IS_TOO_LARGE \
+    SEA_URCHIN_ERROR_VALUE_IS_TOO_LARGE
+#define TRIGGERFISH_CHANNEL_ERROR_STRONG_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_CHANNEL_ERROR_ITEMS_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_CHANNEL_ERROR_COUNT_IS_ZERO \
+    SEA_URCHIN_ERROR_VALUE_IS_ZERO
+#define TRIGGERFISH_CHANNEL_ERROR_CHANNEL_IS_FULL \
+    SEA_URCHIN_ERROR_IS_FULL
+#define TRIGGERFISH_CHANNEL_ERROR_CHANNEL_IS_EMPTY \
+    SEA_URCHIN_ERROR_IS_EMPTY
+#define TRIGGERFISH_CHANNEL_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+#define TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+
+struct triggerfish_strong;
+struct triggerfish_channel;
+
+/**
+ * @brief Create new bounded multi-producer multi-consumer channel.
+ * @param [in] capacity minimum number of strong references the channel can
+ * hold, it is rounded up to the next power of two which is at least
+ * <i>2</i>.
+ * @param [out] out receive the newly created channel.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_CAPACITY_IS_ZERO if capacity is
+ * <i>0</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_CAPACITY_IS_TOO_LARGE if capacity is too
+ * large.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the channel.
+ * @note <b>out</b> must be destroyed once done with it.
+ */
+int triggerfish_channel_of(uintmax_t capacity,
+                           struct triggerfish_channel **out);
+
+/**
+ * @brief Destroy channel, releasing the strong references it still holds.
+ * @param [in] object channel instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @note There must be no concurrent sends or receives.
+ */
+int triggerfish_channel_destroy(struct triggerfish_channel *object);
+
+/**
+ * @brief Retrieve the capacity.
+ * @param [in] object channel instance.
+ * @param [out] out receive the capacity.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+int triggerfish_channel_capacity(const struct triggerfish_channel *object,
+                                 uintmax_t *out);
+
+/**
+ * @brief Send strong reference through the channel.
+ * @param [in] object channel instance.
+ * @param [in] strong reference whose ownership is handed over to the channel.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_STRONG_IS_NULL if strong is <i>NULL</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_CHANNEL_IS_FULL if there is no room left
+ * in the channel.
+ * @note The reference count is not touched, on error the caller still owns
+ * <b>strong</b>.
+ */
+int triggerfish_channel_send(struct triggerfish_channel *object,
+                             struct triggerfish_strong *strong);
+
+/**
+ * @brief Send strong references through the channel.
+ * @param [in] object channel instance.
+ * @param [in] items strong references whose ownership is handed over to the
+ * channel in order.
+ * @param [in] count number of items.
+ * @param [out] out receive the number of items that were sent.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_ITEMS_IS_NULL if items is <i>NULL</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_COUNT_IS_ZERO if count is <i>0</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_CHANNEL_IS_FULL if there is no room left
+ * in the channel.
+ * @note Only the first <b>out</b> items are handed over, the caller still owns
+ * the rest of them.
+ */
+int triggerfish_channel_send_batch(struct triggerfish_channel *object,
+                                   struct triggerfish_strong *const *items,
+                                   uintmax_t count,
+                                   uintmax_t *out);
+
+/**
+ * @brief Receive strong reference from the channel.
+ * @param [in] object channel instance.
+ * @param [out] out receive the strong reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_CHANNEL_IS_EMPTY if there is nothing to
+ * receive.
+ * @note <b>out</b> must be released once done with it.
+ */
+int triggerfish_channel_receive(struct triggerfish_channel *object,
+                                struct triggerfish_strong **out);
+
+/**
+ * @brief Receive strong references from the channel.
+ * @param [in] object channel instance.
+ * @param [out] items receive the strong references in order.
+ * @param [in] count maximum number of items to receive.
+ * @param [out] out receive the number of items that were received.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_ITEMS_IS_NULL if items is <i>NULL</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_COUNT_IS_ZERO if count is <i>0</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_CHANNEL_ERROR_CHANNEL_IS_EMPTY if there is nothing to
+ * receive.
+ * @note The received items must be released once done with them.
+ */
+int triggerfish_channel_receive_batch(struct triggerfish_channel *object,
+                                      struct triggerfish_strong **items,
+                                      uintmax_t count,
+                                      uintmax_t *out);
+
+#endif /* _TRIGGERFISH_CHANNEL_H_ */
@@ -0,0 +1,89 @@
+#ifndef _TRIGGERFISH_HEAP_H_
+#define _TRIGGERFISH_HEAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_HEAP_ERROR_ON_DESTROY_IS_NULL \
+    SEA_URCHIN_ERROR_FUNCTION_IS_NULL
+#define TRIGGERFISH_HEAP_ERROR_NAME_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_HEAP_ERROR_NAME_IS_TOO_LARGE \
+    SEA_URCHIN_ERROR_VALUE_IS_TOO_LARGE
+#define TRIGGERFISH_HEAP_ERROR_TYPE_ALREADY_REGISTERED \
+    SEA_URCHIN_ERROR_VALUE_ALREADY_EXISTS
+#define TRIGGERFISH_HEAP_ERROR_FD_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+#define TRIGGERFISH_HEAP_ERROR_HEAP_IS_NOT_TRACKED \
+    SEA_URCHIN_ERROR_VALUE_NOT_FOUND
+#define TRIGGERFISH_HEAP_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+
+#define TRIGGERFISH_HEAP_NAME_LENGTH_MAX    UINT16_MAX
+
+struct triggerfish_strong;
+
+/**
+ * @brief Register a type of instance for heap dumps.
+ * @param [in] on_destroy the strong references of the type are created with,
+ * which identifies the type.
+ * @param [in] name of the type.
+ * @param [in] size optional function which returns the size in bytes of an
+ * instance of the type.
+ * @param [in] traverse optional function which invokes visit with context
+ * for every strong reference held by an instance of the type.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_HEAP_ERROR_ON_DESTROY_IS_NULL if on_destroy is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_HEAP_ERROR_NAME_IS_NULL if name is <i>NULL</i>.
+ * @throws TRIGGERFISH_HEAP_ERROR_NAME_IS_TOO_LARGE if name is longer than
+ * <i>TRIGGERFISH_HEAP_NAME_LENGTH_MAX</i>.
+ * @throws TRIGGERFISH_HEAP_ERROR_TYPE_ALREADY_REGISTERED if on_destroy was
+ * already registered.
+ * @throws TRIGGERFISH_HEAP_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to register the type.
+ * @note size and traverse are invoked while the instance is kept from being
+ * destroyed but not from being mutated, they must only read what is safe to
+ * read concurrently and must not create or destroy strong references.
+ */
+int triggerfish_heap_register(
+        void (*on_destroy)(void *instance),
+        const char *name,
+        size_t (*size)(const void *instance),
+        void (*traverse)(const void *instance,
+                         void (*visit)(const struct triggerfish_strong *child,
+                                       void *context),
+                         void *context));
+
+/**
+ * @brief Write a snapshot of the live strong references and the strong
+ * references their instances hold.
+ * @param [in] fd file descriptor to write the snapshot to.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_HEAP_ERROR_FD_IS_INVALID if fd could not be written
+ * to.
+ * @throws TRIGGERFISH_HEAP_ERROR_HEAP_IS_NOT_TRACKED if the library was
+ * built without <i>TRIGGERFISH_HEAP_DUMP</i>.
+ * @throws TRIGGERFISH_HEAP_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to buffer the snapshot.
+ * @note The snapshot is written in chunks through a buffer which only grows
+ * if a chunk does not fit. Creating and destroying strong references only
+ * stalls while a chunk is taken, never while it is written, so the snapshot
+ * is not atomic; strong references created during the dump may be missing.
+ * Strong references allocated in a region are not tracked.
+ * @note The snapshot is a little endian stream which starts with the bytes
+ * <i>TFHD</i> and a version byte, followed by records which start with a tag
+ * byte:
+ * <ul>
+ * <li><i>T</i> type: u32 id, u16 name length, name.</li>
+ * <li><i>N</i> node: u64 id, u32 type id or 0, u64 size, u64 count.</li>
+ * <li><i>E</i> edge: u64 id of the holder, u64 id of the held. Aliases
+ * hold the strong reference they were created from.</li>
+ * <li><i>Z</i> end of the snapshot.</li>
+ * </ul>
+ */
+int triggerfish_heap_dump(int fd);
+
+#endif /* _TRIGGERFISH_HEAP_H_ */
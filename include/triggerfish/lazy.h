@@ -0,0 +1,78 @@
+#ifndef _TRIGGERFISH_LAZY_H_
+#define _TRIGGERFISH_LAZY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_LAZY_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_LAZY_ERROR_FACTORY_IS_NULL \
+    SEA_URCHIN_ERROR_FUNCTION_IS_NULL
+#define TRIGGERFISH_LAZY_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+#define TRIGGERFISH_LAZY_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+
+struct triggerfish_strong;
+struct triggerfish_lazy;
+
+/**
+ * @brief Create new lazy cell which creates its strong reference on first
+ * use.
+ * @param [in] factory which will be invoked with context to create the
+ * strong reference, it must return <i>0</i> on success, otherwise an error
+ * code.
+ * @param [in] context passed to factory.
+ * @param [out] out receive the newly created lazy cell.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_LAZY_ERROR_FACTORY_IS_NULL if factory is <i>NULL</i>.
+ * @throws TRIGGERFISH_LAZY_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_LAZY_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the lazy cell.
+ * @note <b>out</b> must be destroyed once done with it.
+ */
+int triggerfish_lazy_of(int (*factory)(void *context,
+                                       struct triggerfish_strong **out),
+                        void *context,
+                        struct triggerfish_lazy **out);
+
+/**
+ * @brief Destroy lazy cell and release its strong reference if it has one.
+ * @param [in] object lazy cell instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_LAZY_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @note No other thread may be using the lazy cell.
+ */
+int triggerfish_lazy_destroy(struct triggerfish_lazy *object);
+
+/**
+ * @brief Receive the strong reference, creating it first if needed.
+ * @param [in] object lazy cell instance.
+ * @param [out] out receive the strong reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_LAZY_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_LAZY_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws any error code returned by factory, in which case the lazy cell is
+ * left empty and the next call invokes factory again.
+ * @note Factory is invoked by exactly one caller at a time while every other
+ * caller sleeps until it is done, so it must not use the lazy cell itself.
+ * Once the strong reference exists it is handed out without taking a lock.
+ * @note <b>out</b> must be released once done with it.
+ */
+int triggerfish_lazy_get(struct triggerfish_lazy *object,
+                         struct triggerfish_strong **out);
+
+/**
+ * @brief Release the strong reference so that the next get creates a new
+ * one.
+ * @param [in] object lazy cell instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_LAZY_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @note Waits for a factory that is running to finish first. Strong
+ * references already handed out keep their instance alive.
+ */
+int triggerfish_lazy_reset(struct triggerfish_lazy *object);
+
+#endif /* _TRIGGERFISH_LAZY_H_ */
@@ -0,0 +1,107 @@
+#ifndef _TRIGGERFISH_LOCAL_H_
+#define _TRIGGERFISH_LOCAL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_LOCAL_ERROR_INSTANCE_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_LOCAL_ERROR_ON_DESTROY_IS_NULL \
+    SEA_URCHIN_ERROR_FUNCTION_IS_NULL
+#define TRIGGERFISH_LOCAL_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+#define TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+#define TRIGGERFISH_LOCAL_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+
+struct triggerfish_strong;
+struct triggerfish_local;
+
+/**
+ * @brief Create new local reference.
+ * @param [in] instance whose lifetime will be managed by the local reference.
+ * @param [in] on_destroy which will be invoked with the reference is being
+ * destroyed.
+ * @param [out] out receive the newly created local reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_LOCAL_ERROR_INSTANCE_IS_NULL if instance is <i>NULL</i>.
+ * @throws TRIGGERFISH_LOCAL_ERROR_ON_DESTROY_IS_NULL if on_destroy is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_LOCAL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_LOCAL_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the local reference.
+ * @note <b>out</b> must be released once done with it.
+ * @note A local reference is not thread-safe, its reference count is a plain
+ * integer and it has no lock. It must only be used by one thread at a time.
+ */
+int triggerfish_local_of(void *instance,
+                         void (*on_destroy)(void *instance),
+                         struct triggerfish_local **out);
+
+/**
+ * @brief Retrieve the reference count.
+ * @param [in] object local reference.
+ * @param [out] out receive the reference count.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_LOCAL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+int triggerfish_local_count(const struct triggerfish_local *object,
+                            uintmax_t *out);
+
+/**
+ * @brief Increase the reference count.
+ * @param [in] object local reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_INVALID if the local reference
+ * has been invalidated.
+ */
+int triggerfish_local_retain(struct triggerfish_local *object);
+
+/**
+ * @brief Decrease the reference count.
+ * @param [in] object local reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ */
+int triggerfish_local_release(struct triggerfish_local *object);
+
+/**
+ * @brief Retrieve referenced object instance.
+ * @param [in] object local reference.
+ * @param [out] out receive referenced object instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_LOCAL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_INVALID if the local reference
+ * instance has been invalidated.
+ */
+int triggerfish_local_instance(const struct triggerfish_local *object,
+                               void **out);
+
+/**
+ * @brief Receive strong reference for the local reference.
+ * @param [in] object local reference.
+ * @param [out] out receive the strong reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_LOCAL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_INVALID if the local reference
+ * has been invalidated.
+ * @throws TRIGGERFISH_LOCAL_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the strong reference.
+ * @note The first call hands the instance over to a newly created strong
+ * reference which the local reference then holds on to, this cannot be
+ * undone. Later calls only retain that strong reference.
+ * @note <b>out</b> must be released once done with it.
+ */
+int triggerfish_local_strong(struct triggerfish_local *object,
+                             struct triggerfish_strong **out);
+
+#endif /* _TRIGGERFISH_LOCAL_H_ */
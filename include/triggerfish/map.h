@@ -0,0 +1,138 @@
+#ifndef _TRIGGERFISH_MAP_H_
+#define _TRIGGERFISH_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_MAP_ERROR_HASH_IS_NULL \
+    SEA_URCHIN_ERROR_FUNCTION_IS_NULL
+#define TRIGGERFISH_MAP_ERROR_COMPARE_IS_NULL \
+    SEA_URCHIN_ERROR_FUNCTION_IS_NULL
+#define TRIGGERFISH_MAP_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+#define TRIGGERFISH_MAP_ERROR_KEY_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_MAP_ERROR_VALUE_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_MAP_ERROR_KEY_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+#define TRIGGERFISH_MAP_ERROR_VALUE_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+#define TRIGGERFISH_MAP_ERROR_KEY_NOT_FOUND \
+    SEA_URCHIN_ERROR_VALUE_NOT_FOUND
+#define TRIGGERFISH_MAP_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+
+struct triggerfish_strong;
+struct triggerfish_map;
+
+/**
+ * @brief Create new empty persistent hash map of strong references.
+ * @param [in] hash which will be invoked with a key instance.
+ * @param [in] compare which will be invoked with two key instances and must
+ * return <i>0</i> if they are equal.
+ * @param [out] out receive the newly created map.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_MAP_ERROR_HASH_IS_NULL if hash is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_COMPARE_IS_NULL if compare is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the map.
+ * @note <b>out</b> must be destroyed once done with it.
+ * @note A map is a single version of the collection. Its nodes are strong
+ * references which are shared with the versions copied from it, an update
+ * copies the shared nodes on the path to the entry and changes the nodes
+ * that no other version refers to in place.
+ */
+int triggerfish_map_of(uintmax_t (*hash)(const void *instance),
+                       int (*compare)(const void *first, const void *second),
+                       struct triggerfish_map **out);
+
+/**
+ * @brief Destroy map, releasing the nodes no other version refers to.
+ * @param [in] object map instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ */
+int triggerfish_map_destroy(struct triggerfish_map *object);
+
+/**
+ * @brief Create new version of the map sharing all of its nodes.
+ * @param [in] object map instance.
+ * @param [out] out receive the newly created map.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the map.
+ * @note <b>out</b> must be destroyed once done with it.
+ */
+int triggerfish_map_copy_of(const struct triggerfish_map *object,
+                            struct triggerfish_map **out);
+
+/**
+ * @brief Retrieve the number of entries.
+ * @param [in] object map instance.
+ * @param [out] out receive the number of entries.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+int triggerfish_map_count(const struct triggerfish_map *object,
+                          uintmax_t *out);
+
+/**
+ * @brief Associate value with key.
+ * @param [in] object map instance.
+ * @param [in] key reference that will be retained by the map.
+ * @param [in] value reference that will be retained by the map.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_KEY_IS_NULL if key is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_VALUE_IS_NULL if value is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_KEY_IS_INVALID if key has been invalidated.
+ * @throws TRIGGERFISH_MAP_ERROR_VALUE_IS_INVALID if value has been
+ * invalidated.
+ * @throws TRIGGERFISH_MAP_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to copy or add the nodes on the path to the entry.
+ * @note If there already is an equal key then only its value is replaced.
+ */
+int triggerfish_map_put(struct triggerfish_map *object,
+                        struct triggerfish_strong *key,
+                        struct triggerfish_strong *value);
+
+/**
+ * @brief Remove entry with key.
+ * @param [in] object map instance.
+ * @param [in] key instance to look for.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_KEY_IS_NULL if key is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_KEY_NOT_FOUND if there is no entry for key.
+ * @throws TRIGGERFISH_MAP_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to copy the nodes on the path to the entry.
+ */
+int triggerfish_map_remove(struct triggerfish_map *object,
+                           const void *key);
+
+/**
+ * @brief Retrieve value associated with key.
+ * @param [in] object map instance.
+ * @param [in] key instance to look for.
+ * @param [out] out receive the value.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_KEY_IS_NULL if key is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_MAP_ERROR_KEY_NOT_FOUND if there is no entry for key.
+ * @note <b>out</b> must be released once done with it.
+ */
+int triggerfish_map_get(const struct triggerfish_map *object,
+                        const void *key,
+                        struct triggerfish_strong **out);
+
+#endif /* _TRIGGERFISH_MAP_H_ */
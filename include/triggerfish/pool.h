@@ -0,0 +1,74 @@
+#ifndef _TRIGGERFISH_POOL_H_
+#define _TRIGGERFISH_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_POOL_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_POOL_ERROR_SIZE_IS_ZERO \
+    SEA_URCHIN_ERROR_VALUE_IS_ZERO
+#define TRIGGERFISH_POOL_ERROR_ON_DESTROY_IS_NULL \
+    SEA_URCHIN_ERROR_FUNCTION_IS_NULL
+#define TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+#define TRIGGERFISH_POOL_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+
+struct triggerfish_strong;
+struct triggerfish_pool;
+
+/**
+ * @brief Create new pool which recycles instances of the same size together
+ * with their strong reference.
+ * @param [in] size of the instances.
+ * @param [in] reset optional function which will be invoked to prepare an
+ * instance for reuse once its on_destroy has been invoked.
+ * @param [out] out receive the newly created pool.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_POOL_ERROR_SIZE_IS_ZERO if size is <i>0</i>.
+ * @throws TRIGGERFISH_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the pool.
+ * @note <b>out</b> must be destroyed once done with it.
+ */
+int triggerfish_pool_of(size_t size,
+                        void (*reset)(void *instance),
+                        struct triggerfish_pool **out);
+
+/**
+ * @brief Destroy pool and free the instances it holds for reuse.
+ * @param [in] object pool instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @note Every strong reference created from the pool must have been
+ * destroyed and no other thread may be using the pool.
+ */
+int triggerfish_pool_destroy(struct triggerfish_pool *object);
+
+/**
+ * @brief Create new strong reference with an instance from the pool.
+ * @param [in] object pool from which the instance is taken.
+ * @param [in] on_destroy function which will be invoked when the strong
+ * reference is being destroyed.
+ * @param [out] out receive the newly created strong reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_POOL_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_POOL_ERROR_ON_DESTROY_IS_NULL if on_destroy is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_POOL_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the strong reference.
+ * @note The instance is zero-filled if it was newly allocated, otherwise it
+ * is as reset left it. Once the strong reference is destroyed the instance
+ * and the strong reference are returned to a cache of the releasing thread
+ * instead of being freed, and are taken from there first. Caches which grow
+ * too large or whose thread exits are handed over to the pool.
+ */
+int triggerfish_pool_strong_of(struct triggerfish_pool *object,
+                               void (*on_destroy)(void *instance),
+                               struct triggerfish_strong **out);
+
+#endif /* _TRIGGERFISH_POOL_H_ */
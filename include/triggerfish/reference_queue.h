@@ -0,0 +1,73 @@
+#ifndef _TRIGGERFISH_REFERENCE_QUEUE_H_
+#define _TRIGGERFISH_REFERENCE_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_REFERENCE_QUEUE_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_REFERENCE_QUEUE_ERROR_COOKIES_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_REFERENCE_QUEUE_ERROR_COUNT_IS_ZERO \
+    SEA_URCHIN_ERROR_VALUE_IS_ZERO
+#define TRIGGERFISH_REFERENCE_QUEUE_ERROR_QUEUE_IS_EMPTY \
+    SEA_URCHIN_ERROR_IS_EMPTY
+#define TRIGGERFISH_REFERENCE_QUEUE_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+#define TRIGGERFISH_REFERENCE_QUEUE_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+
+struct triggerfish_reference_queue;
+
+/**
+ * @brief Create new reference queue.
+ * @param [out] out receive the newly created reference queue.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_REFERENCE_QUEUE_ERROR_OUT_IS_NULL if out is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_REFERENCE_QUEUE_ERROR_MEMORY_ALLOCATION_FAILED if there
+ * is not enough memory to create the reference queue.
+ * @note <b>out</b> must be destroyed once done with it.
+ */
+int triggerfish_reference_queue_of(struct triggerfish_reference_queue **out);
+
+/**
+ * @brief Destroy reference queue.
+ * @param [in] object reference queue instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_REFERENCE_QUEUE_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @note Cookies that were not polled yet are discarded. Every weak reference
+ * bound to the queue must either have been destroyed or been invalidated.
+ */
+int triggerfish_reference_queue_destroy(
+        struct triggerfish_reference_queue *object);
+
+/**
+ * @brief Retrieve the cookies of weak references that were invalidated.
+ * @param [in] object reference queue instance.
+ * @param [out] cookies receive up to count cookies, oldest first.
+ * @param [in] count of cookies that fit into cookies.
+ * @param [out] out receive the number of cookies retrieved.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_REFERENCE_QUEUE_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_REFERENCE_QUEUE_ERROR_COOKIES_IS_NULL if cookies is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_REFERENCE_QUEUE_ERROR_COUNT_IS_ZERO if count is
+ * <i>0</i>.
+ * @throws TRIGGERFISH_REFERENCE_QUEUE_ERROR_OUT_IS_NULL if out is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_REFERENCE_QUEUE_ERROR_QUEUE_IS_EMPTY if no weak
+ * reference bound to the queue was invalidated since the last poll.
+ * @note Invalidating a strong reference enqueues without taking any lock of
+ * the queue, only consumers polling the queue serialize among each other.
+ */
+int triggerfish_reference_queue_poll(struct triggerfish_reference_queue *object,
+                                     void **cookies,
+                                     uintmax_t count,
+                                     uintmax_t *out);
+
+#endif /* _TRIGGERFISH_REFERENCE_QUEUE_H_ */
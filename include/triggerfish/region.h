@@ -0,0 +1,92 @@
+#ifndef _TRIGGERFISH_REGION_H_
+#define _TRIGGERFISH_REGION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_REGION_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_REGION_ERROR_SIZE_IS_ZERO \
+    SEA_URCHIN_ERROR_VALUE_IS_ZERO
+#define TRIGGERFISH_REGION_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+#define TRIGGERFISH_REGION_ERROR_OBJECT_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+#define TRIGGERFISH_REGION_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+
+struct triggerfish_strong;
+struct triggerfish_region;
+
+/**
+ * @brief Create new region.
+ * @param [out] out receive the newly created region.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_REGION_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_REGION_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the region.
+ * @note <b>out</b> must be released once done with it.
+ */
+int triggerfish_region_of(struct triggerfish_region **out);
+
+/**
+ * @brief Retrieve the reference count.
+ * @param [in] object region.
+ * @param [out] out receive the reference count.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_REGION_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_REGION_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+int triggerfish_region_count(struct triggerfish_region *object,
+                             uintmax_t *out);
+
+/**
+ * @brief Increase the reference count.
+ * @param [in] object region.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_REGION_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_REGION_ERROR_OBJECT_IS_INVALID if the region has been
+ * invalidated.
+ */
+int triggerfish_region_retain(struct triggerfish_region *object);
+
+/**
+ * @brief Decrease the reference count.
+ * @param [in] object region.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_REGION_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @note When the reference count reaches zero all the weak references into
+ * the region are invalidated, the <i>on_destroy</i> of every strong reference
+ * in the region is invoked (newest first) and then the region's memory is
+ * freed in bulk.
+ */
+int triggerfish_region_release(struct triggerfish_region *object);
+
+/**
+ * @brief Create new strong reference inside the region.
+ * @param [in] object region in which the instance will be allocated.
+ * @param [in] size of the zero-filled instance to allocate.
+ * @param [in] on_destroy optional function which will be invoked when the
+ * region is being destroyed.
+ * @param [out] out receive the newly created strong reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_REGION_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_REGION_ERROR_SIZE_IS_ZERO if size is <i>0</i>.
+ * @throws TRIGGERFISH_REGION_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_REGION_ERROR_OBJECT_IS_INVALID if the region has been
+ * invalidated.
+ * @throws TRIGGERFISH_REGION_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the strong reference.
+ * @note <b>out</b> shares the reference count of the region; retaining or
+ * releasing it retains or releases the region. It holds a reference to the
+ * region of its own and must be released once done with it. References
+ * between instances of the same region need not be retained at all.
+ */
+int triggerfish_region_strong_of(struct triggerfish_region *object,
+                                 size_t size,
+                                 void (*on_destroy)(void *instance),
+                                 struct triggerfish_strong **out);
+
+#endif /* _TRIGGERFISH_REGION_H_ */
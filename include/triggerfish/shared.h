@@ -0,0 +1,214 @@
+#ifndef _TRIGGERFISH_SHARED_H_
+#define _TRIGGERFISH_SHARED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_SHARED_ERROR_NAME_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_SHARED_ERROR_NAME_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+#define TRIGGERFISH_SHARED_ERROR_NAME_ALREADY_EXISTS \
+    SEA_URCHIN_ERROR_VALUE_ALREADY_EXISTS
+#define TRIGGERFISH_SHARED_ERROR_SEGMENT_NOT_FOUND \
+    SEA_URCHIN_ERROR_VALUE_NOT_FOUND
+#define TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+#define TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_FULL \
+    SEA_URCHIN_ERROR_IS_FULL
+#define TRIGGERFISH_SHARED_ERROR_PROCESSES_ARE_FULL \
+    SEA_URCHIN_ERROR_IS_FULL
+#define TRIGGERFISH_SHARED_ERROR_SIZE_IS_ZERO \
+    SEA_URCHIN_ERROR_VALUE_IS_ZERO
+#define TRIGGERFISH_SHARED_ERROR_COUNT_IS_ZERO \
+    SEA_URCHIN_ERROR_VALUE_IS_ZERO
+#define TRIGGERFISH_SHARED_ERROR_PROCESSES_IS_ZERO \
+    SEA_URCHIN_ERROR_VALUE_IS_ZERO
+#define TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_TOO_LARGE \
+    SEA_URCHIN_ERROR_VALUE_IS_TOO_LARGE
+#define TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+#define TRIGGERFISH_SHARED_ERROR_BLOCK_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+#define TRIGGERFISH_SHARED_ERROR_BLOCK_IS_NOT_HELD \
+    SEA_URCHIN_ERROR_VALUE_NOT_FOUND
+#define TRIGGERFISH_SHARED_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+#define TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+
+struct triggerfish_shared;
+
+/**
+ * @brief Create new named shared memory segment holding reference counted
+ * blocks and attach the calling process to it.
+ * @param [in] name of the segment as accepted by <i>shm_open</i>.
+ * @param [in] size of each block in bytes.
+ * @param [in] count of blocks in the segment.
+ * @param [in] processes maximum number of concurrently attached processes.
+ * @param [out] out receive the attached segment.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SHARED_ERROR_NAME_IS_NULL if name is <i>NULL</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_SIZE_IS_ZERO if size is <i>0</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_COUNT_IS_ZERO if count is <i>0</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_PROCESSES_IS_ZERO if processes is
+ * <i>0</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_TOO_LARGE if the segment
+ * would be too large.
+ * @throws TRIGGERFISH_SHARED_ERROR_NAME_IS_INVALID if name is not a valid or
+ * accessible shared memory object name.
+ * @throws TRIGGERFISH_SHARED_ERROR_NAME_ALREADY_EXISTS if a segment with
+ * the same name already exists.
+ * @throws TRIGGERFISH_SHARED_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the segment.
+ * @note <b>out</b> must be closed once done with it and the segment
+ * unlinked once no further process needs to attach to it.
+ */
+int triggerfish_shared_of(const char *name,
+                          size_t size,
+                          uintmax_t count,
+                          uintmax_t processes,
+                          struct triggerfish_shared **out);
+
+/**
+ * @brief Attach the calling process to an existing shared memory segment.
+ * @param [in] name of the segment.
+ * @param [out] out receive the attached segment.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SHARED_ERROR_NAME_IS_NULL if name is <i>NULL</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_NAME_IS_INVALID if name is not a valid or
+ * accessible shared memory object name.
+ * @throws TRIGGERFISH_SHARED_ERROR_SEGMENT_NOT_FOUND if there is no segment
+ * with that name.
+ * @throws TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_INVALID if the shared memory
+ * object is not a segment or is still being created.
+ * @throws TRIGGERFISH_SHARED_ERROR_PROCESSES_ARE_FULL if the maximum number
+ * of processes are already attached.
+ * @throws TRIGGERFISH_SHARED_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to attach to the segment.
+ * @note <b>out</b> must be closed once done with it.
+ */
+int triggerfish_shared_open(const char *name,
+                            struct triggerfish_shared **out);
+
+/**
+ * @brief Detach the calling process from the segment.
+ * @param [in] object attached segment.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @note Every reference still held through <b>object</b> is released.
+ */
+int triggerfish_shared_close(struct triggerfish_shared *object);
+
+/**
+ * @brief Remove the name of a shared memory segment.
+ * @param [in] name of the segment.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SHARED_ERROR_NAME_IS_NULL if name is <i>NULL</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_NAME_IS_INVALID if name is not a valid or
+ * accessible shared memory object name.
+ * @throws TRIGGERFISH_SHARED_ERROR_SEGMENT_NOT_FOUND if there is no segment
+ * with that name.
+ * @note Attached processes keep using the segment until they close it.
+ */
+int triggerfish_shared_unlink(const char *name);
+
+/**
+ * @brief Allocate a zeroed block with a reference count of <i>1</i> held by
+ * the calling process.
+ * @param [in] object attached segment.
+ * @param [out] out receive the offset of the block from the start of the
+ * segment, which is the same in every attached process.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_FULL if every block is in
+ * use.
+ */
+int triggerfish_shared_alloc(struct triggerfish_shared *object,
+                             uintmax_t *out);
+
+/**
+ * @brief Retrieve the address of a block in the calling process.
+ * @param [in] object attached segment.
+ * @param [in] offset of the block.
+ * @param [out] out receive the address of the block.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID if offset is not the
+ * offset of a block.
+ * @throws TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+int triggerfish_shared_at(const struct triggerfish_shared *object,
+                          uintmax_t offset,
+                          void **out);
+
+/**
+ * @brief Retrieve the reference count of a block across all processes.
+ * @param [in] object attached segment.
+ * @param [in] offset of the block.
+ * @param [out] out receive the reference count.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID if offset is not the
+ * offset of a block.
+ * @throws TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+int triggerfish_shared_count(const struct triggerfish_shared *object,
+                             uintmax_t offset,
+                             uintmax_t *out);
+
+/**
+ * @brief Retain a block on behalf of the calling process.
+ * @param [in] object attached segment.
+ * @param [in] offset of the block.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID if offset is not the
+ * offset of a block.
+ * @throws TRIGGERFISH_SHARED_ERROR_BLOCK_IS_INVALID if the block has been
+ * freed.
+ * @note The offset is typically received from another process which must
+ * keep holding the block until this call returns.
+ */
+int triggerfish_shared_retain(struct triggerfish_shared *object,
+                              uintmax_t offset);
+
+/**
+ * @brief Release a block held by the calling process.
+ * @param [in] object attached segment.
+ * @param [in] offset of the block.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID if offset is not the
+ * offset of a block.
+ * @throws TRIGGERFISH_SHARED_ERROR_BLOCK_IS_NOT_HELD if the calling process
+ * does not hold a reference to the block.
+ * @note Once the last reference of any process is released the block is
+ * returned to the segment.
+ */
+int triggerfish_shared_release(struct triggerfish_shared *object,
+                               uintmax_t offset);
+
+/**
+ * @brief Reclaim the references held by processes that exited without
+ * closing the segment.
+ * @param [in] object attached segment.
+ * @param [out] out receive the number of processes reclaimed.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @note A process which died in the middle of a retain, release or alloc
+ * may leak a block, but never causes a block that is still in use to be
+ * freed.
+ */
+int triggerfish_shared_recover(struct triggerfish_shared *object,
+                               uintmax_t *out);
+
+#endif /* _TRIGGERFISH_SHARED_H_ */
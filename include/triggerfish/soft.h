@@ -0,0 +1,87 @@
+#ifndef _TRIGGERFISH_SOFT_H_
+#define _TRIGGERFISH_SOFT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_SOFT_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_SOFT_ERROR_CACHE_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_SOFT_ERROR_STRONG_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_SOFT_ERROR_STRONG_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+#define TRIGGERFISH_SOFT_ERROR_SIZE_IS_ZERO \
+    SEA_URCHIN_ERROR_VALUE_IS_ZERO
+#define TRIGGERFISH_SOFT_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+#define TRIGGERFISH_SOFT_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+
+struct triggerfish_strong;
+struct triggerfish_soft_cache;
+struct triggerfish_soft;
+
+/**
+ * @brief Create new soft reference.
+ * @param [in] cache whose memory budget the soft reference counts against.
+ * @param [in] strong from which a soft reference is to be created.
+ * @param [in] size in bytes which the instance is accounted for.
+ * @param [out] out receive the newly created soft reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SOFT_ERROR_CACHE_IS_NULL if cache is <i>NULL</i>.
+ * @throws TRIGGERFISH_SOFT_ERROR_STRONG_IS_NULL if strong is <i>NULL</i>.
+ * @throws TRIGGERFISH_SOFT_ERROR_SIZE_IS_ZERO if size is <i>0</i>.
+ * @throws TRIGGERFISH_SOFT_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_SOFT_ERROR_STRONG_IS_INVALID if the strong reference
+ * was invalidated.
+ * @throws TRIGGERFISH_SOFT_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to create the soft reference.
+ * @note The soft reference keeps the instance alive like a strong reference
+ * until it is cleared by the cache, from then on it behaves like a weak
+ * reference. Adding it may clear other soft references to stay within the
+ * budget.
+ */
+int triggerfish_soft_of(struct triggerfish_soft_cache *cache,
+                        struct triggerfish_strong *strong,
+                        size_t size,
+                        struct triggerfish_soft **out);
+
+/**
+ * @brief Destroy a soft reference.
+ * @param [in] object soft reference instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SOFT_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ */
+int triggerfish_soft_destroy(struct triggerfish_soft *object);
+
+/**
+ * @brief Check whether the soft reference has been cleared by its cache.
+ * @param [in] object soft reference instance.
+ * @param [out] out receive <i>true</i> if cleared, otherwise <i>false</i>.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SOFT_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_SOFT_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+int triggerfish_soft_is_cleared(struct triggerfish_soft *object,
+                                bool *out);
+
+/**
+ * @brief Receive strong reference for the soft reference.
+ * @param [in] object soft reference instance.
+ * @param [out] out receive the strong reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SOFT_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_SOFT_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_SOFT_ERROR_STRONG_IS_INVALID if the soft reference was
+ * cleared and the strong reference has since been invalidated.
+ * @note Marks the soft reference as recently used.
+ * @note <b>out</b> must be released once done with it.
+ */
+int triggerfish_soft_strong(struct triggerfish_soft *object,
+                            struct triggerfish_strong **out);
+
+#endif /* _TRIGGERFISH_SOFT_H_ */
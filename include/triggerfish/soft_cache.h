@@ -0,0 +1,120 @@
+#ifndef _TRIGGERFISH_SOFT_CACHE_H_
+#define _TRIGGERFISH_SOFT_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_SOFT_CACHE_ERROR_PATH_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_SOFT_CACHE_ERROR_PATH_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+#define TRIGGERFISH_SOFT_CACHE_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+#define TRIGGERFISH_SOFT_CACHE_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+
+struct triggerfish_soft_cache;
+
+/**
+ * @brief Create new cache which soft references share a memory budget in.
+ * @param [in] budget in bytes which the soft references may keep alive.
+ * @param [out] out receive the newly created cache.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SOFT_CACHE_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_SOFT_CACHE_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * not enough memory to create the cache.
+ * @note <b>out</b> must be destroyed once done with it.
+ */
+int triggerfish_soft_cache_of(size_t budget,
+                              struct triggerfish_soft_cache **out);
+
+/**
+ * @brief Destroy cache.
+ * @param [in] object cache instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @note Every soft reference of the cache must have been destroyed.
+ */
+int triggerfish_soft_cache_destroy(struct triggerfish_soft_cache *object);
+
+/**
+ * @brief Retrieve the memory budget.
+ * @param [in] object cache instance.
+ * @param [out] out receive the budget in bytes.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_SOFT_CACHE_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+int triggerfish_soft_cache_budget(struct triggerfish_soft_cache *object,
+                                  size_t *out);
+
+/**
+ * @brief Change the memory budget.
+ * @param [in] object cache instance.
+ * @param [in] budget in bytes which the soft references may keep alive.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @note Lowering the budget below the current usage clears soft references
+ * until it fits.
+ */
+int triggerfish_soft_cache_set_budget(struct triggerfish_soft_cache *object,
+                                      size_t budget);
+
+/**
+ * @brief Retrieve the memory kept alive by the soft references.
+ * @param [in] object cache instance.
+ * @param [out] out receive the usage in bytes.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_SOFT_CACHE_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+int triggerfish_soft_cache_usage(struct triggerfish_soft_cache *object,
+                                 size_t *out);
+
+/**
+ * @brief Clear soft references until the memory they keep alive fits in
+ * usage bytes.
+ * @param [in] object cache instance.
+ * @param [in] usage in bytes to shrink to.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @note Soft references are cleared in approximately least recently used
+ * order using a clock sweep, a soft reference which was used since the hand
+ * last passed it is skipped once.
+ */
+int triggerfish_soft_cache_shrink(struct triggerfish_soft_cache *object,
+                                  size_t usage);
+
+/**
+ * @brief Check a memory pressure source and halve the usage if there was
+ * pressure since the last check.
+ * @param [in] object cache instance.
+ * @param [in] path of either a pressure stall information file such as
+ * <i>/proc/pressure/memory</i> or a cgroup <i>memory.events</i> file.
+ * @param [out] out receive <i>true</i> if there was pressure, otherwise
+ * <i>false</i>.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_SOFT_CACHE_ERROR_PATH_IS_NULL if path is <i>NULL</i>.
+ * @throws TRIGGERFISH_SOFT_CACHE_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_SOFT_CACHE_ERROR_PATH_IS_INVALID if path could not be
+ * read or is not a memory pressure source.
+ * @note The first check only records the state of the source. Pressure is a
+ * growing stall total or a growing count of high, max or oom events, so a
+ * cache should be polled from a single source.
+ */
+int triggerfish_soft_cache_poll(struct triggerfish_soft_cache *object,
+                                const char *path,
+                                bool *out);
+
+#endif /* _TRIGGERFISH_SOFT_CACHE_H_ */
@@ -4,6 +4,8 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <time.h>
+#include <errno.h>
 #include <sea-urchin.h>
 
 #define TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL \
@@ -18,6 +20,15 @@
     SEA_URCHIN_ERROR_VALUE_IS_INVALID
 #define TRIGGERFISH_STRONG_ERROR_OUT_IS_NULL \
     SEA_URCHIN_ERROR_OUT_IS_NULL
+#define TRIGGERFISH_STRONG_ERROR_CLONE_IS_NULL \
+    SEA_URCHIN_ERROR_FUNCTION_IS_NULL
+#define TRIGGERFISH_STRONG_ERROR_TIMEOUT_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+/* sea-urchin has no code for an expired timeout */
+#define TRIGGERFISH_STRONG_ERROR_TIMED_OUT \
+    ETIMEDOUT
+#define TRIGGERFISH_STRONG_ERROR_OBJECT_IS_ALIAS \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
 
 struct triggerfish_strong;
 
@@ -40,6 +51,34 @@ int triggerfish_strong_of(void *instance,
                           void (*on_destroy)(void *instance),
                           struct triggerfish_strong **out);
 
+/**
+ * @brief Create new strong reference to a part of the instance of another.
+ * @param [in] object strong reference whose instance contains instance.
+ * @param [in] instance part of the instance of object, such as a field or an
+ * array element.
+ * @param [out] out receive the newly created strong reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_STRONG_ERROR_INSTANCE_IS_NULL if instance is <i>NULL</i>.
+ * @throws TRIGGERFISH_STRONG_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID if object has been
+ * invalidated.
+ * @throws TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the strong reference.
+ * @note <b>out</b> is a handle of just instance and one reference to
+ * object, or to the strong reference object is an alias of, and is freed
+ * when it is released. It shares the reference count of that strong
+ * reference and is only unique if its reference is the only one left. It
+ * cannot be retained nor have weak references; to share it create another
+ * alias of it. Nothing is invoked or freed for instance. Cloning it with
+ * triggerfish_strong_make_unique creates a strong reference without an
+ * on_destroy.
+ * @note <b>out</b> must be released once done with it.
+ */
+int triggerfish_strong_alias_of(struct triggerfish_strong *object,
+                                void *instance,
+                                struct triggerfish_strong **out);
+
 /**
  * @brief Retrieve the reference count.
  * @param [in] object strong reference.
@@ -58,6 +97,8 @@ int triggerfish_strong_count(struct triggerfish_strong *object,
  * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
  * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID if the strong reference
  * has been invalidated.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_ALIAS if object is an alias,
+ * which holds a single reference; create another alias of it instead.
  */
 int triggerfish_strong_retain(struct triggerfish_strong *object);
 
@@ -69,6 +110,44 @@ int triggerfish_strong_retain(struct triggerfish_strong *object);
  */
 int triggerfish_strong_release(struct triggerfish_strong *object);
 
+/**
+ * @brief Block until every other holder has released its reference.
+ * @param [in] object strong reference held by the caller.
+ * @param [in] timeout relative time to wait for at most, or <i>NULL</i> to
+ * wait indefinitely.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_STRONG_ERROR_TIMEOUT_IS_INVALID if timeout is negative
+ * or its nanoseconds are not below one second.
+ * @throws TRIGGERFISH_STRONG_ERROR_TIMED_OUT if the reference count was still
+ * greater than one once timeout elapsed.
+ * @note The waiting thread sleeps and releases only issue a wake up while a
+ * thread is waiting. Weak references may still be turned into strong
+ * references after this returns, see <i>triggerfish_strong_is_unique</i>.
+ * Strong references allocated in a region wait for the region's count.
+ */
+int triggerfish_strong_wait_unique(struct triggerfish_strong *object,
+                                   const struct timespec *timeout);
+
+/**
+ * @brief Release the reference once every other holder has released theirs
+ * and destroy the instance.
+ * @param [in] object strong reference held by the caller.
+ * @param [in] timeout relative time to wait for at most, or <i>NULL</i> to
+ * wait indefinitely.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_STRONG_ERROR_TIMEOUT_IS_INVALID if timeout is negative
+ * or its nanoseconds are not below one second.
+ * @throws TRIGGERFISH_STRONG_ERROR_TIMED_OUT if the reference count was still
+ * greater than one once timeout elapsed.
+ * @note On success the instance has been destroyed by the time this returns,
+ * on error the caller still owns <b>object</b>. Strong references allocated
+ * in a region destroy the whole region.
+ */
+int triggerfish_strong_release_wait(struct triggerfish_strong *object,
+                                    const struct timespec *timeout);
+
 /**
  * @brief Retrieve referenced object instance.
  * @param [in] object strong reference.
@@ -82,4 +161,48 @@ int triggerfish_strong_release(struct triggerfish_strong *object);
 int triggerfish_strong_instance(const struct triggerfish_strong *object,
                                 void **out);
 
+/**
+ * @brief Check if this is the only reference to the instance.
+ * @param [in] object strong reference.
+ * @param [out] out receive <i>true</i> if the reference count is one and
+ * there are no weak references that could be turned into another strong
+ * reference, otherwise <i>false</i>.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_STRONG_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID if the strong reference
+ * has been invalidated.
+ * @note Unlike the reference count the answer is exact; while object is held
+ * by the caller nobody else can obtain a reference to a unique instance.
+ * Strong references allocated in a region are never unique as references
+ * between the region's instances are not counted. An alias is unique if the
+ * strong reference it is an alias of is, with the alias' reference as its
+ * only one.
+ */
+int triggerfish_strong_is_unique(struct triggerfish_strong *object,
+                                 bool *out);
+
+/**
+ * @brief Ensure that the strong reference is the only reference to its
+ * instance, cloning the instance only if it is shared.
+ * @param [in,out] object strong reference which is replaced by a strong
+ * reference to a clone of its instance if it was not unique.
+ * @param [in] clone which will be invoked to copy the instance, it must
+ * return <i>0</i> on success, otherwise an error code.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_STRONG_ERROR_CLONE_IS_NULL if clone is <i>NULL</i>.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID if the strong reference
+ * has been invalidated.
+ * @throws TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the strong reference for the clone.
+ * @throws any error code returned by clone.
+ * @note On success the instance of <b>object</b> can be mutated in place.
+ * The clone is created with the same <i>on_destroy</i> as the original, the
+ * reference to the original is released.
+ */
+int triggerfish_strong_make_unique(struct triggerfish_strong **object,
+                                   int (*clone)(const void *instance,
+                                                void **out));
+
 #endif /* _TRIGGERFISH_STRONG_H_ */
@@ -0,0 +1,72 @@
+#ifndef _TRIGGERFISH_TEARDOWN_H_
+#define _TRIGGERFISH_TEARDOWN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_TEARDOWN_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_TEARDOWN_ERROR_WORKERS_IS_ZERO \
+    SEA_URCHIN_ERROR_VALUE_IS_ZERO
+#define TRIGGERFISH_TEARDOWN_ERROR_STRONG_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_TEARDOWN_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+#define TRIGGERFISH_TEARDOWN_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+
+struct triggerfish_strong;
+struct triggerfish_teardown;
+
+/**
+ * @brief Create new teardown which destroys large graphs of strong
+ * references with several threads.
+ * @param [in] workers number of threads destroying instances, including
+ * the thread releasing the strong reference.
+ * @param [out] out receive the newly created teardown.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_TEARDOWN_ERROR_WORKERS_IS_ZERO if workers is <i>0</i>.
+ * @throws TRIGGERFISH_TEARDOWN_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_TEARDOWN_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory or threads to create the teardown.
+ * @note The single threaded variant always uses a single worker.
+ * @note <b>out</b> must be destroyed once done with it.
+ */
+int triggerfish_teardown_of(size_t workers,
+                            struct triggerfish_teardown **out);
+
+/**
+ * @brief Destroy teardown and join its threads.
+ * @param [in] object teardown instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_TEARDOWN_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ */
+int triggerfish_teardown_destroy(struct triggerfish_teardown *object);
+
+/**
+ * @brief Release strong reference and destroy everything it was the last
+ * reference to with the teardown's workers.
+ * @param [in] object teardown instance.
+ * @param [in] strong reference to release.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_TEARDOWN_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_TEARDOWN_ERROR_STRONG_IS_NULL if strong is
+ * <i>NULL</i>.
+ * @note Strong references whose count drops to zero while an instance is
+ * being destroyed are not destroyed right away but queued on the destroying
+ * worker, from where idle workers steal them. Every instance is still
+ * destroyed exactly once, though in no particular order and on any of the
+ * workers, and the memory is freed in batches. Returns once all of them
+ * have been destroyed.
+ * @note Only one release runs at a time per teardown, others wait for it.
+ * Releasing strong references allocated in a region destroys the region
+ * right away.
+ */
+int triggerfish_teardown_release(struct triggerfish_teardown *object,
+                                 struct triggerfish_strong *strong);
+
+#endif /* _TRIGGERFISH_TEARDOWN_H_ */
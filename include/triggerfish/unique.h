@@ -0,0 +1,96 @@
+#ifndef _TRIGGERFISH_UNIQUE_H_
+#define _TRIGGERFISH_UNIQUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_UNIQUE_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_UNIQUE_ERROR_INSTANCE_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_UNIQUE_ERROR_ON_DESTROY_IS_NULL \
+    SEA_URCHIN_ERROR_FUNCTION_IS_NULL
+#define TRIGGERFISH_UNIQUE_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+#define TRIGGERFISH_UNIQUE_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+
+struct triggerfish_strong;
+struct triggerfish_local;
+struct triggerfish_unique;
+
+/**
+ * @brief Create new unique reference.
+ * @param [in] instance whose lifetime will be managed by the unique reference.
+ * @param [in] on_destroy which will be invoked with the reference is being
+ * destroyed.
+ * @param [out] out receive the newly created unique reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_UNIQUE_ERROR_INSTANCE_IS_NULL if instance is <i>NULL</i>.
+ * @throws TRIGGERFISH_UNIQUE_ERROR_ON_DESTROY_IS_NULL if on_destroy is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_UNIQUE_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_UNIQUE_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the unique reference.
+ * @note <b>out</b> must be destroyed once done with it.
+ * @note A unique reference has a single owner and therefore no reference
+ * count at all.
+ */
+int triggerfish_unique_of(void *instance,
+                          void (*on_destroy)(void *instance),
+                          struct triggerfish_unique **out);
+
+/**
+ * @brief Destroy a unique reference along with its instance.
+ * @param [in] object unique reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_UNIQUE_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ */
+int triggerfish_unique_destroy(struct triggerfish_unique *object);
+
+/**
+ * @brief Retrieve referenced object instance.
+ * @param [in] object unique reference.
+ * @param [out] out receive referenced object instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_UNIQUE_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_UNIQUE_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+int triggerfish_unique_instance(const struct triggerfish_unique *object,
+                                void **out);
+
+/**
+ * @brief Convert unique reference into a strong reference.
+ * @param [in] object unique reference which is destroyed, without destroying
+ * its instance, once the strong reference has been created.
+ * @param [out] out receive the strong reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_UNIQUE_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_UNIQUE_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_UNIQUE_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the strong reference.
+ * @note On error the caller still owns <b>object</b>.
+ * @note <b>out</b> must be released once done with it.
+ */
+int triggerfish_unique_strong(struct triggerfish_unique *object,
+                              struct triggerfish_strong **out);
+
+/**
+ * @brief Convert unique reference into a local reference.
+ * @param [in] object unique reference which is destroyed, without destroying
+ * its instance, once the local reference has been created.
+ * @param [out] out receive the local reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_UNIQUE_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_UNIQUE_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_UNIQUE_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the local reference.
+ * @note On error the caller still owns <b>object</b>.
+ * @note <b>out</b> must be released once done with it.
+ */
+int triggerfish_unique_local(struct triggerfish_unique *object,
+                             struct triggerfish_local **out);
+
+#endif /* _TRIGGERFISH_UNIQUE_H_ */
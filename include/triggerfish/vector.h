@@ -0,0 +1,140 @@
+#ifndef _TRIGGERFISH_VECTOR_H_
+#define _TRIGGERFISH_VECTOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_VECTOR_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+#define TRIGGERFISH_VECTOR_ERROR_STRONG_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_VECTOR_ERROR_STRONG_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+#define TRIGGERFISH_VECTOR_ERROR_INDEX_IS_OUT_OF_BOUNDS \
+    SEA_URCHIN_ERROR_INDEX_IS_OUT_OF_BOUNDS
+#define TRIGGERFISH_VECTOR_ERROR_VECTOR_IS_EMPTY \
+    SEA_URCHIN_ERROR_IS_EMPTY
+#define TRIGGERFISH_VECTOR_ERROR_VECTOR_IS_FULL \
+    SEA_URCHIN_ERROR_IS_FULL
+#define TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+
+struct triggerfish_strong;
+struct triggerfish_vector;
+
+/**
+ * @brief Create new empty persistent vector of strong references.
+ * @param [out] out receive the newly created vector.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_VECTOR_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the vector.
+ * @note <b>out</b> must be destroyed once done with it.
+ * @note A vector is a single version of the collection. Its nodes are strong
+ * references which are shared with the versions copied from it, an update
+ * copies the shared nodes on the path to the element and changes the nodes
+ * that no other version refers to in place.
+ */
+int triggerfish_vector_of(struct triggerfish_vector **out);
+
+/**
+ * @brief Destroy vector, releasing the nodes no other version refers to.
+ * @param [in] object vector instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ */
+int triggerfish_vector_destroy(struct triggerfish_vector *object);
+
+/**
+ * @brief Create new version of the vector sharing all of its nodes.
+ * @param [in] object vector instance.
+ * @param [out] out receive the newly created vector.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_VECTOR_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to create the vector.
+ * @note <b>out</b> must be destroyed once done with it.
+ */
+int triggerfish_vector_copy_of(const struct triggerfish_vector *object,
+                               struct triggerfish_vector **out);
+
+/**
+ * @brief Retrieve the number of elements.
+ * @param [in] object vector instance.
+ * @param [out] out receive the number of elements.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_VECTOR_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+int triggerfish_vector_count(const struct triggerfish_vector *object,
+                             uintmax_t *out);
+
+/**
+ * @brief Append element.
+ * @param [in] object vector instance.
+ * @param [in] strong reference that will be retained by the vector.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_VECTOR_ERROR_STRONG_IS_NULL if strong is <i>NULL</i>.
+ * @throws TRIGGERFISH_VECTOR_ERROR_STRONG_IS_INVALID if strong has been
+ * invalidated.
+ * @throws TRIGGERFISH_VECTOR_ERROR_VECTOR_IS_FULL if there is no more room
+ * for another element.
+ * @throws TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to copy or add the nodes on the path to the element.
+ */
+int triggerfish_vector_add(struct triggerfish_vector *object,
+                           struct triggerfish_strong *strong);
+
+/**
+ * @brief Remove the last element.
+ * @param [in] object vector instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_VECTOR_ERROR_VECTOR_IS_EMPTY if there are no elements.
+ * @throws TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to copy the nodes on the path to the element.
+ */
+int triggerfish_vector_remove_last(struct triggerfish_vector *object);
+
+/**
+ * @brief Replace element at index.
+ * @param [in] object vector instance.
+ * @param [in] index of element.
+ * @param [in] strong reference that will be retained by the vector.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_VECTOR_ERROR_STRONG_IS_NULL if strong is <i>NULL</i>.
+ * @throws TRIGGERFISH_VECTOR_ERROR_INDEX_IS_OUT_OF_BOUNDS if index does not
+ * refer to an element.
+ * @throws TRIGGERFISH_VECTOR_ERROR_STRONG_IS_INVALID if strong has been
+ * invalidated.
+ * @throws TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED if there is not
+ * enough memory to copy the nodes on the path to the element.
+ */
+int triggerfish_vector_set(struct triggerfish_vector *object,
+                           uintmax_t index,
+                           struct triggerfish_strong *strong);
+
+/**
+ * @brief Retrieve element at index.
+ * @param [in] object vector instance.
+ * @param [in] index of element.
+ * @param [out] out receive the element.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_VECTOR_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_VECTOR_ERROR_INDEX_IS_OUT_OF_BOUNDS if index does not
+ * refer to an element.
+ * @note <b>out</b> must be released once done with it.
+ */
+int triggerfish_vector_get(const struct triggerfish_vector *object,
+                           uintmax_t index,
+                           struct triggerfish_strong **out);
+
+#endif /* _TRIGGERFISH_VECTOR_H_ */
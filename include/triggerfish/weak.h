@@ -18,9 +18,14 @@
     SEA_URCHIN_ERROR_OUT_IS_NULL
 #define TRIGGERFISH_WEAK_ERROR_OTHER_IS_NULL \
     SEA_URCHIN_ERROR_OTHER_IS_NULL
+#define TRIGGERFISH_WEAK_ERROR_QUEUE_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_WEAK_ERROR_STRONG_IS_ALIAS \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
 
 struct triggerfish_strong;
 struct triggerfish_weak;
+struct triggerfish_reference_queue;
 
 /**
  * @brief Create new weak reference.
@@ -33,10 +38,35 @@ struct triggerfish_weak;
  * insufficient memory to create the weak reference.
  * @throws TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID if the strong reference
  * was invalidated.
+ * @throws TRIGGERFISH_WEAK_ERROR_STRONG_IS_ALIAS if strong is an alias.
  */
 int triggerfish_weak_of(struct triggerfish_strong *strong,
                         struct triggerfish_weak **out);
 
+/**
+ * @brief Create new weak reference bound to a reference queue.
+ * @param [in] strong from which a weak reference is to be created.
+ * @param [in] queue to receive cookie once the strong reference has been
+ * invalidated.
+ * @param [in] cookie to identify the weak reference by when polling queue.
+ * @param [out] out receive the newly created weak reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_WEAK_ERROR_STRONG_IS_NULL if strong is <i>NULL</i>.
+ * @throws TRIGGERFISH_WEAK_ERROR_QUEUE_IS_NULL if queue is <i>NULL</i>.
+ * @throws TRIGGERFISH_WEAK_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_WEAK_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to create the weak reference.
+ * @throws TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID if the strong reference
+ * was invalidated.
+ * @note cookie is not enqueued if the weak reference is destroyed before the
+ * strong reference is invalidated. Copies of the weak reference are not
+ * bound to queue.
+ */
+int triggerfish_weak_of_queue(struct triggerfish_strong *strong,
+                              struct triggerfish_reference_queue *queue,
+                              void *cookie,
+                              struct triggerfish_weak **out);
+
 /**
  * @brief Create copy of weak reference.
  * @param [in] other from which a copy is to be be created.
@@ -46,6 +76,8 @@ int triggerfish_weak_of(struct triggerfish_strong *strong,
  * @throws TRIGGERFISH_WEAK_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
  * @throws TRIGGERFISH_WEAK_ERROR_MEMORY_ALLOCATION_FAILED if there is
  * insufficient memory to copy the weak reference.
+ * @note The strong reference's count is not touched, <b>other</b> is
+ * borrowed for the duration of the copy instead.
  */
 int triggerfish_weak_copy_of(const struct triggerfish_weak *other,
                              struct triggerfish_weak **out);
@@ -55,6 +87,7 @@ int triggerfish_weak_copy_of(const struct triggerfish_weak *other,
  * @param [in] object weak reference instance.
  * @return On success <i>0</i>, otherwise an error code.
  * @throws TRIGGERFISH_WEAK_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @note <b>object</b> must not be destroyed while it is borrowed.
  */
 int triggerfish_weak_destroy(struct triggerfish_weak *object);
 
@@ -72,4 +105,49 @@ int triggerfish_weak_destroy(struct triggerfish_weak *object);
 int triggerfish_weak_strong(const struct triggerfish_weak *object,
                             struct triggerfish_strong **out);
 
+/**
+ * @brief Receive strong reference for the weak reference taking over the
+ * weak reference.
+ * @param [in] object weak reference instance which is destroyed once the
+ * strong reference has been received.
+ * @param [out] out receive the strong reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_WEAK_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_WEAK_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID if the strong reference was
+ * invalidated.
+ * @note On error the caller still owns <b>object</b>.
+ * @note <b>out</b> must be released once done with it.
+ * @note <b>object</b> must not be used once taken, which is checked when
+ * built with <i>TRIGGERFISH_DEBUG_OWNERSHIP</i>.
+ */
+int triggerfish_weak_strong_take(struct triggerfish_weak *object,
+                                 struct triggerfish_strong **out);
+
+/**
+ * @brief Borrow the instance of the weak reference's strong reference.
+ * @param [in] object weak reference instance.
+ * @param [out] out receive the instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_WEAK_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ * @throws TRIGGERFISH_WEAK_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID if the strong reference was
+ * invalidated.
+ * @note The reference count is not touched, instead the instance is kept
+ * alive until the borrow is ended with <i>triggerfish_weak_borrow_end</i>.
+ * A final release of the strong reference blocks until then, so borrows must
+ * be short and must not be held across the final release on the same thread.
+ * @note A borrow must be ended by the thread that started it.
+ */
+int triggerfish_weak_borrow(const struct triggerfish_weak *object,
+                            void **out);
+
+/**
+ * @brief End a borrow of the weak reference.
+ * @param [in] object weak reference instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_WEAK_ERROR_OBJECT_IS_NULL if object is <i>NULL</i>.
+ */
+int triggerfish_weak_borrow_end(const struct triggerfish_weak *object);
+
 #endif /* _TRIGGERFISH_WEAK_H_ */
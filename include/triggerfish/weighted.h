@@ -0,0 +1,97 @@
+#ifndef _TRIGGERFISH_WEIGHTED_H_
+#define _TRIGGERFISH_WEIGHTED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#define TRIGGERFISH_WEIGHTED_ERROR_OBJECT_IS_NULL \
+    SEA_URCHIN_ERROR_OBJECT_IS_NULL
+#define TRIGGERFISH_WEIGHTED_ERROR_STRONG_IS_NULL \
+    SEA_URCHIN_ERROR_VALUE_IS_NULL
+#define TRIGGERFISH_WEIGHTED_ERROR_STRONG_IS_INVALID \
+    SEA_URCHIN_ERROR_VALUE_IS_INVALID
+#define TRIGGERFISH_WEIGHTED_ERROR_OTHER_IS_NULL \
+    SEA_URCHIN_ERROR_OTHER_IS_NULL
+#define TRIGGERFISH_WEIGHTED_ERROR_MEMORY_ALLOCATION_FAILED \
+    SEA_URCHIN_ERROR_MEMORY_ALLOCATION_FAILED
+#define TRIGGERFISH_WEIGHTED_ERROR_OUT_IS_NULL \
+    SEA_URCHIN_ERROR_OUT_IS_NULL
+
+struct triggerfish_strong;
+struct triggerfish_weighted;
+
+/**
+ * @brief Create new weighted reference.
+ * @param [in] strong from which a weighted reference is to be created.
+ * @param [out] out receive the newly created weighted reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_WEIGHTED_ERROR_STRONG_IS_NULL if strong is <i>NULL</i>.
+ * @throws TRIGGERFISH_WEIGHTED_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_WEIGHTED_ERROR_STRONG_IS_INVALID if the strong
+ * reference was invalidated.
+ * @throws TRIGGERFISH_WEIGHTED_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to create the weighted reference.
+ * @note The weighted reference and all of its copies hold a single retained
+ * reference of <b>strong</b> between them.
+ * @note <b>out</b> must be destroyed once done with it.
+ */
+int triggerfish_weighted_of(struct triggerfish_strong *strong,
+                            struct triggerfish_weighted **out);
+
+/**
+ * @brief Create copy of weighted reference.
+ * @param [in] other from which a copy is to be created.
+ * @param [out] out receive the copy.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_WEIGHTED_ERROR_OTHER_IS_NULL if other is <i>NULL</i>.
+ * @throws TRIGGERFISH_WEIGHTED_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @throws TRIGGERFISH_WEIGHTED_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to copy the weighted reference.
+ * @note The copy takes half of the weight of <b>other</b> without touching
+ * any shared counter. Only once <b>other</b> is down to a weight of one is
+ * more weight borrowed from the shared counter. As <b>other</b> is modified
+ * it must not be copied by several threads at the same time.
+ * @note <b>out</b> must be destroyed once done with it.
+ */
+int triggerfish_weighted_copy_of(struct triggerfish_weighted *other,
+                                 struct triggerfish_weighted **out);
+
+/**
+ * @brief Destroy weighted reference.
+ * @param [in] object weighted reference instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_WEIGHTED_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @note Returns the weight of <b>object</b> to the shared counter; the
+ * last weighted reference to be destroyed releases the strong reference.
+ */
+int triggerfish_weighted_destroy(struct triggerfish_weighted *object);
+
+/**
+ * @brief Retrieve referenced object instance.
+ * @param [in] object weighted reference instance.
+ * @param [out] out receive referenced object instance.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_WEIGHTED_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_WEIGHTED_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ */
+int triggerfish_weighted_instance(const struct triggerfish_weighted *object,
+                                  void **out);
+
+/**
+ * @brief Receive strong reference for the weighted reference.
+ * @param [in] object weighted reference instance.
+ * @param [out] out receive the strong reference.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_WEIGHTED_ERROR_OBJECT_IS_NULL if object is
+ * <i>NULL</i>.
+ * @throws TRIGGERFISH_WEIGHTED_ERROR_OUT_IS_NULL if out is <i>NULL</i>.
+ * @note <b>out</b> must be released once done with it.
+ */
+int triggerfish_weighted_strong(const struct triggerfish_weighted *object,
+                                struct triggerfish_strong **out);
+
+#endif /* _TRIGGERFISH_WEIGHTED_H_ */
@@ -0,0 +1,203 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/channel.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+int triggerfish_channel_of(const uintmax_t capacity,
+                           struct triggerfish_channel **const out) {
+    if (!capacity) {
+        return TRIGGERFISH_CHANNEL_ERROR_CAPACITY_IS_ZERO;
+    }
+    if (!out) {
+        return TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL;
+    }
+    /* a single cell could not tell a filled slot from the next free one */
+    uintmax_t size = 2;
+    while (size < capacity) {
+        if (seagrass_uintmax_t_multiply(size, 2, &size)) {
+            return TRIGGERFISH_CHANNEL_ERROR_CAPACITY_IS_TOO_LARGE;
+        }
+    }
+    if (size > SIZE_MAX / sizeof(struct triggerfish_channel_cell)) {
+        return TRIGGERFISH_CHANNEL_ERROR_CAPACITY_IS_TOO_LARGE;
+    }
+    struct triggerfish_channel *object = calloc(1, sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_CHANNEL_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    object->cells = malloc(size * sizeof(struct triggerfish_channel_cell));
+    if (!object->cells) {
+        free(object);
+        return TRIGGERFISH_CHANNEL_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    for (uintmax_t i = 0; i < size; i++) {
+        atomic_init(&object->cells[i].sequence, i);
+        object->cells[i].strong = NULL;
+    }
+    object->mask = size - 1;
+    atomic_init(&object->enqueue, 0);
+    atomic_init(&object->dequeue, 0);
+    *out = object;
+    return 0;
+}
+
+int triggerfish_channel_destroy(struct triggerfish_channel *const object) {
+    if (!object) {
+        return TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL;
+    }
+    struct triggerfish_strong *strong;
+    while (!triggerfish_channel_receive(object, &strong)) {
+        seagrass_required_true(!triggerfish_strong_release(strong));
+    }
+    free(object->cells);
+    free(object);
+    return 0;
+}
+
+int triggerfish_channel_capacity(const struct triggerfish_channel *const object,
+                                 uintmax_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL;
+    }
+    *out = 1 + object->mask;
+    return 0;
+}
+
+/*
+ * Claim up to count consecutive cells whose sequence is the position plus
+ * offset. Producers look for free cells (offset 0) and consumers for filled
+ * cells (offset 1), see Dmitry Vyukov's bounded MPMC queue.
+ */
+static uintmax_t claim(struct triggerfish_channel *const object,
+                       atomic_uintmax_t *const position,
+                       const uintmax_t offset,
+                       const uintmax_t count,
+                       uintmax_t *const out) {
+    assert(object);
+    assert(position);
+    assert(count);
+    assert(out);
+    uintmax_t at = atomic_load_explicit(position, memory_order_relaxed);
+    for (;;) {
+        uintmax_t i = 0;
+        for (; i < count && i <= object->mask; i++) {
+            const struct triggerfish_channel_cell *cell
+                    = &object->cells[(at + i) & object->mask];
+            const uintmax_t sequence = atomic_load_explicit(
+                    &cell->sequence, memory_order_acquire);
+            if (sequence != at + i + offset) {
+                break;
+            }
+        }
+        if (!i) {
+            const struct triggerfish_channel_cell *cell
+                    = &object->cells[at & object->mask];
+            const intmax_t difference = (intmax_t) (atomic_load_explicit(
+                    &cell->sequence, memory_order_acquire) - (at + offset));
+            if (difference < 0) {
+                return 0;
+            }
+            at = atomic_load_explicit(position, memory_order_relaxed);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(position, &at, at + i,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            *out = at;
+            return i;
+        }
+    }
+}
+
+int triggerfish_channel_send(struct triggerfish_channel *const object,
+                             struct triggerfish_strong *const strong) {
+    if (!strong) {
+        return TRIGGERFISH_CHANNEL_ERROR_STRONG_IS_NULL;
+    }
+    uintmax_t count;
+    return triggerfish_channel_send_batch(object, &strong, 1, &count);
+}
+
+int triggerfish_channel_send_batch(struct triggerfish_channel *const object,
+                                   struct triggerfish_strong *const *const items,
+                                   const uintmax_t count,
+                                   uintmax_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL;
+    }
+    if (!items) {
+        return TRIGGERFISH_CHANNEL_ERROR_ITEMS_IS_NULL;
+    }
+    if (!count) {
+        return TRIGGERFISH_CHANNEL_ERROR_COUNT_IS_ZERO;
+    }
+    if (!out) {
+        return TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL;
+    }
+    uintmax_t at;
+    const uintmax_t claimed = claim(object, &object->enqueue, 0, count, &at);
+    if (!claimed) {
+        return TRIGGERFISH_CHANNEL_ERROR_CHANNEL_IS_FULL;
+    }
+    for (uintmax_t i = 0; i < claimed; i++) {
+        struct triggerfish_channel_cell *cell
+                = &object->cells[(at + i) & object->mask];
+        cell->strong = items[i];
+        atomic_store_explicit(&cell->sequence, at + i + 1,
+                              memory_order_release);
+    }
+    *out = claimed;
+    return 0;
+}
+
+int triggerfish_channel_receive(struct triggerfish_channel *const object,
+                                struct triggerfish_strong **const out) {
+    if (!out) {
+        return TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL;
+    }
+    uintmax_t count;
+    return triggerfish_channel_receive_batch(object, out, 1, &count);
+}
+
+int triggerfish_channel_receive_batch(struct triggerfish_channel *const object,
+                                      struct triggerfish_strong **const items,
+                                      const uintmax_t count,
+                                      uintmax_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL;
+    }
+    if (!items) {
+        return TRIGGERFISH_CHANNEL_ERROR_ITEMS_IS_NULL;
+    }
+    if (!count) {
+        return TRIGGERFISH_CHANNEL_ERROR_COUNT_IS_ZERO;
+    }
+    if (!out) {
+        return TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL;
+    }
+    uintmax_t at;
+    const uintmax_t claimed = claim(object, &object->dequeue, 1, count, &at);
+    if (!claimed) {
+        return TRIGGERFISH_CHANNEL_ERROR_CHANNEL_IS_EMPTY;
+    }
+    for (uintmax_t i = 0; i < claimed; i++) {
+        struct triggerfish_channel_cell *cell
+                = &object->cells[(at + i) & object->mask];
+        items[i] = cell->strong;
+        cell->strong = NULL;
+        atomic_store_explicit(&cell->sequence, at + i + 1 + object->mask,
+                              memory_order_release);
+    }
+    *out = claimed;
+    return 0;
+}
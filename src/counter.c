@@ -0,0 +1,212 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <errno.h>
+#include <seagrass.h>
+
+#include "private/counter.h"
+
+#if !defined(TRIGGERFISH_SINGLE_THREADED) && defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#elif !defined(TRIGGERFISH_SINGLE_THREADED)
+#define TRIGGERFISH_COUNTER_BUCKETS     64
+
+/*
+ * Without futexes, as on macOS, waiting threads park on a condition variable
+ * picked by the address of the counter they wait on.
+ */
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} buckets[TRIGGERFISH_COUNTER_BUCKETS];
+static pthread_once_t buckets_once = PTHREAD_ONCE_INIT;
+
+static void buckets_init(void) {
+    for (size_t i = 0; i < TRIGGERFISH_COUNTER_BUCKETS; i++) {
+        seagrass_required_true(!pthread_mutex_init(&buckets[i].lock, NULL));
+        seagrass_required_true(!pthread_cond_init(&buckets[i].cond, NULL));
+    }
+}
+
+static size_t bucket_of(const void *const object) {
+    return ((uintptr_t) object >> 4) % TRIGGERFISH_COUNTER_BUCKETS;
+}
+#endif
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+#define NANOSECONDS     1000000000L
+
+bool triggerfish_counter_deadline(const struct timespec *const timeout,
+                                  struct timespec *const out) {
+    assert(out);
+    if (!timeout) {
+        return true;
+    }
+    if (timeout->tv_sec < 0 || timeout->tv_nsec < 0
+        || timeout->tv_nsec >= NANOSECONDS) {
+        return false;
+    }
+    seagrass_required_true(!clock_gettime(CLOCK_MONOTONIC, out));
+    out->tv_nsec += timeout->tv_nsec;
+    if (out->tv_nsec >= NANOSECONDS) {
+        out->tv_nsec -= NANOSECONDS;
+        out->tv_sec += 1;
+    }
+    /* saturate instead of overflowing for timeouts that never pass */
+    const time_t limit = (time_t) 1 << 40;
+    out->tv_sec = out->tv_sec > limit - timeout->tv_sec
+                  ? limit
+                  : out->tv_sec + timeout->tv_sec;
+    return true;
+}
+
+#if !defined(TRIGGERFISH_SINGLE_THREADED) && defined(__linux__)
+/* futexes are 32 bits wide, the low half changes with every decrement */
+static uint32_t *word_of(TRIGGERFISH_ATOMIC(triggerfish_counter_t) *object) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return (uint32_t *) object + (sizeof(triggerfish_counter_t) / 4 - 1);
+#else
+    return (uint32_t *) object;
+#endif
+}
+#endif
+
+void triggerfish_counter_wake(
+        TRIGGERFISH_ATOMIC(triggerfish_counter_t) *const object) {
+    assert(object);
+#if defined(TRIGGERFISH_SINGLE_THREADED)
+    (void) object;
+#elif defined(__linux__)
+    syscall(SYS_futex, word_of(object), FUTEX_WAKE_PRIVATE, INT_MAX,
+            NULL, NULL, 0);
+#else
+    seagrass_required_true(!pthread_once(&buckets_once, buckets_init));
+    const size_t i = bucket_of(object);
+    seagrass_required_true(!pthread_mutex_lock(&buckets[i].lock));
+    seagrass_required_true(!pthread_cond_broadcast(&buckets[i].cond));
+    seagrass_required_true(!pthread_mutex_unlock(&buckets[i].lock));
+#endif
+}
+
+bool triggerfish_counter_wait(
+        TRIGGERFISH_ATOMIC(triggerfish_counter_t) *const object,
+        const triggerfish_counter_t value,
+        const struct timespec *const deadline) {
+    assert(object);
+    assert(value & TRIGGERFISH_COUNTER_WAITING);
+#if defined(TRIGGERFISH_SINGLE_THREADED)
+    /* there is no other thread that could ever release a reference */
+    (void) value;
+    (void) deadline;
+    return false;
+#elif defined(__linux__)
+    if (-1 == syscall(SYS_futex, word_of(object), FUTEX_WAIT_BITSET_PRIVATE,
+                      (uint32_t) value, deadline, NULL,
+                      FUTEX_BITSET_MATCH_ANY)) {
+        switch (errno) {
+            default: {
+                seagrass_required_true(false);
+            }
+            case ETIMEDOUT: {
+                return false;
+            }
+            case EAGAIN:
+            case EINTR: {
+                break;
+            }
+        }
+    }
+    return true;
+#else
+    struct timespec until;
+    if (deadline) {
+        /* condition variables time out on the realtime clock */
+        struct timespec now;
+        seagrass_required_true(!clock_gettime(CLOCK_MONOTONIC, &now));
+        seagrass_required_true(!clock_gettime(CLOCK_REALTIME, &until));
+        until.tv_sec += deadline->tv_sec - now.tv_sec;
+        until.tv_nsec += deadline->tv_nsec - now.tv_nsec;
+        if (until.tv_nsec < 0) {
+            until.tv_nsec += NANOSECONDS;
+            until.tv_sec -= 1;
+        } else if (until.tv_nsec >= NANOSECONDS) {
+            until.tv_nsec -= NANOSECONDS;
+            until.tv_sec += 1;
+        }
+    }
+    seagrass_required_true(!pthread_once(&buckets_once, buckets_init));
+    const size_t i = bucket_of(object);
+    int error = 0;
+    seagrass_required_true(!pthread_mutex_lock(&buckets[i].lock));
+    if (value == triggerfish_atomic_load(object)) {
+        error = deadline
+                ? pthread_cond_timedwait(&buckets[i].cond, &buckets[i].lock,
+                                         &until)
+                : pthread_cond_wait(&buckets[i].cond, &buckets[i].lock);
+        seagrass_required_true(!error || ETIMEDOUT == error);
+    }
+    seagrass_required_true(!pthread_mutex_unlock(&buckets[i].lock));
+    return !error;
+#endif
+}
+
+/*
+ * Wait for the count to drop to 1 and leave the value that was observed in
+ * expected, with or without the waiting flag.
+ */
+static bool await_unique(
+        TRIGGERFISH_ATOMIC(triggerfish_counter_t) *const object,
+        triggerfish_counter_t *const expected,
+        const struct timespec *const deadline) {
+    assert(object);
+    assert(expected);
+    *expected = triggerfish_atomic_load(object);
+    for (;;) {
+        seagrass_required_true(triggerfish_counter_count(*expected));
+        if (1 == triggerfish_counter_count(*expected)) {
+            return true;
+        }
+        if (!(*expected & TRIGGERFISH_COUNTER_WAITING)) {
+            const triggerfish_counter_t desired
+                    = *expected | TRIGGERFISH_COUNTER_WAITING;
+            if (triggerfish_atomic_compare_exchange(object, expected,
+                                                    desired)) {
+                *expected = desired;
+            }
+            continue;
+        }
+        if (!triggerfish_counter_wait(object, *expected, deadline)) {
+            return false;
+        }
+        *expected = triggerfish_atomic_load(object);
+    }
+}
+
+bool triggerfish_counter_await_unique(
+        TRIGGERFISH_ATOMIC(triggerfish_counter_t) *const object,
+        const struct timespec *const deadline) {
+    assert(object);
+    triggerfish_counter_t expected;
+    return await_unique(object, &expected, deadline);
+}
+
+bool triggerfish_counter_release_unique(
+        TRIGGERFISH_ATOMIC(triggerfish_counter_t) *const object,
+        const struct timespec *const deadline) {
+    assert(object);
+    triggerfish_counter_t expected;
+    do {
+        if (!await_unique(object, &expected, deadline)) {
+            return false;
+        }
+        /* a weak reference may have been turned into a strong one meanwhile */
+    } while (!triggerfish_atomic_compare_exchange(object, &expected, 0));
+    if (expected & TRIGGERFISH_COUNTER_WAITING) {
+        triggerfish_counter_wake(object);
+    }
+    return true;
+}
@@ -0,0 +1,299 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <unistd.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/heap.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+/* guards the registered types and the live strong references */
+#ifndef TRIGGERFISH_SINGLE_THREADED
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+static struct triggerfish_heap_type *types;
+static size_t types_count;
+
+static struct triggerfish_heap_type *type_of(
+        void (*const on_destroy)(void *instance),
+        uint32_t *const id) {
+    for (size_t i = 0; i < types_count; i++) {
+        if (types[i].on_destroy == on_destroy) {
+            if (id) {
+                *id = (uint32_t) i + 1;
+            }
+            return &types[i];
+        }
+    }
+    return NULL;
+}
+
+int triggerfish_heap_register(
+        void (*const on_destroy)(void *instance),
+        const char *const name,
+        size_t (*const size)(const void *instance),
+        void (*const traverse)(
+                const void *instance,
+                void (*visit)(const struct triggerfish_strong *child,
+                              void *context),
+                void *context)) {
+    if (!on_destroy) {
+        return TRIGGERFISH_HEAP_ERROR_ON_DESTROY_IS_NULL;
+    }
+    if (!name) {
+        return TRIGGERFISH_HEAP_ERROR_NAME_IS_NULL;
+    }
+    const size_t length = strlen(name);
+    if (length > TRIGGERFISH_HEAP_NAME_LENGTH_MAX) {
+        return TRIGGERFISH_HEAP_ERROR_NAME_IS_TOO_LARGE;
+    }
+    char *copy = malloc(length + 1);
+    if (!copy) {
+        return TRIGGERFISH_HEAP_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    memcpy(copy, name, length + 1);
+    int error = 0;
+    seagrass_required_true(!triggerfish_mutex_lock(&lock));
+    if (type_of(on_destroy, NULL)) {
+        error = TRIGGERFISH_HEAP_ERROR_TYPE_ALREADY_REGISTERED;
+    } else {
+        struct triggerfish_heap_type *const resized = realloc(
+                types, (types_count + 1) * sizeof(*types));
+        if (!resized) {
+            error = TRIGGERFISH_HEAP_ERROR_MEMORY_ALLOCATION_FAILED;
+        } else {
+            types = resized;
+            types[types_count++] = (struct triggerfish_heap_type) {
+                    .on_destroy = on_destroy,
+                    .name = copy,
+                    .size = size,
+                    .traverse = traverse
+            };
+        }
+    }
+    seagrass_required_true(!triggerfish_mutex_unlock(&lock));
+    if (error) {
+        free(copy);
+    }
+    return error;
+}
+
+#ifdef TRIGGERFISH_HEAP_DUMP
+/* most recently created live strong reference */
+static struct triggerfish_strong *first;
+
+static void attach(struct triggerfish_strong *const previous,
+                       struct triggerfish_strong *const object) {
+    assert(object);
+    object->heap_previous = previous;
+    object->heap_next = previous ? previous->heap_next : first;
+    if (object->heap_next) {
+        object->heap_next->heap_previous = object;
+    }
+    if (previous) {
+        previous->heap_next = object;
+    } else {
+        first = object;
+    }
+}
+
+static void detach(struct triggerfish_strong *const object) {
+    assert(object);
+    if (object->heap_previous) {
+        object->heap_previous->heap_next = object->heap_next;
+    } else {
+        first = object->heap_next;
+    }
+    if (object->heap_next) {
+        object->heap_next->heap_previous = object->heap_previous;
+    }
+    object->heap_next = NULL;
+    object->heap_previous = NULL;
+}
+
+void triggerfish_heap_track(struct triggerfish_strong *const object) {
+    assert(object);
+    seagrass_required_true(!triggerfish_mutex_lock(&lock));
+    attach(NULL, object);
+    seagrass_required_true(!triggerfish_mutex_unlock(&lock));
+}
+
+void triggerfish_heap_untrack(struct triggerfish_strong *const object) {
+    assert(object);
+    seagrass_required_true(!triggerfish_mutex_lock(&lock));
+    detach(object);
+    seagrass_required_true(!triggerfish_mutex_unlock(&lock));
+}
+
+struct writer {
+    int fd;
+    bool failed;
+    bool exhausted;
+    size_t used;
+    size_t capacity;
+    unsigned char *data;
+};
+
+static void flush(struct writer *const writer) {
+    assert(writer);
+    size_t at = 0;
+    while (!writer->failed && at < writer->used) {
+        const ssize_t written = write(writer->fd, writer->data + at,
+                                      writer->used - at);
+        if (written < 0) {
+            writer->failed = EINTR != errno;
+        } else {
+            at += (size_t) written;
+        }
+    }
+    writer->used = 0;
+}
+
+/* called with the lock held, so it grows the buffer instead of flushing */
+static void put(struct writer *const writer,
+                const void *const data,
+                const size_t size) {
+    assert(writer);
+    if (writer->failed) {
+        return;
+    }
+    if (writer->capacity - writer->used < size) {
+        const size_t capacity = writer->used + size > 2 * writer->capacity
+                                ? writer->used + size
+                                : 2 * writer->capacity;
+        unsigned char *const resized = realloc(writer->data, capacity);
+        if (!resized) {
+            writer->failed = writer->exhausted = true;
+            return;
+        }
+        writer->data = resized;
+        writer->capacity = capacity;
+    }
+    memcpy(writer->data + writer->used, data, size);
+    writer->used += size;
+}
+
+static void put_uint(struct writer *const writer,
+                     uint64_t value,
+                     const size_t size) {
+    assert(writer);
+    assert(size <= sizeof(value));
+    unsigned char bytes[sizeof(value)];
+    for (size_t i = 0; i < size; i++, value >>= 8) {
+        bytes[i] = (unsigned char) value;
+    }
+    put(writer, bytes, size);
+}
+
+struct holder {
+    struct writer *writer;
+    const struct triggerfish_strong *object;
+};
+
+static void visit(const struct triggerfish_strong *child,
+                  void *const context) {
+    struct holder *const holder = context;
+    if (!child) {
+        return;
+    }
+    /* aliases are no nodes of their own but share their parent's */
+    if (child->parent) {
+        child = child->parent;
+    }
+    put_uint(holder->writer, 'E', 1);
+    put_uint(holder->writer, (uintptr_t) holder->object, 8);
+    put_uint(holder->writer, (uintptr_t) child, 8);
+}
+
+static void put_node(struct writer *const writer,
+                     const struct triggerfish_strong *const object,
+                     const triggerfish_counter_t count) {
+    assert(writer);
+    assert(object);
+    uint32_t id = 0;
+    const struct triggerfish_heap_type *const type
+            = type_of(object->on_destroy, &id);
+    put_uint(writer, 'N', 1);
+    put_uint(writer, (uintptr_t) object, 8);
+    put_uint(writer, id, 4);
+    put_uint(writer, type && type->size ? type->size(object->instance) : 0, 8);
+    put_uint(writer, count, 8);
+    struct holder holder = {writer, object};
+    if (type && type->traverse) {
+        type->traverse(object->instance, visit, &holder);
+    }
+}
+#endif
+
+int triggerfish_heap_dump(const int fd) {
+#ifndef TRIGGERFISH_HEAP_DUMP
+    (void) fd;
+    return TRIGGERFISH_HEAP_ERROR_HEAP_IS_NOT_TRACKED;
+#else
+    if (fd < 0) {
+        return TRIGGERFISH_HEAP_ERROR_FD_IS_INVALID;
+    }
+    struct writer writer = {
+            .fd = fd,
+            .capacity = TRIGGERFISH_HEAP_BUFFER_SIZE
+    };
+    writer.data = malloc(writer.capacity);
+    if (!writer.data) {
+        return TRIGGERFISH_HEAP_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    /* a count of zero makes every dump skip the cursor of every other dump */
+    struct triggerfish_strong cursor = {0};
+    seagrass_required_true(!triggerfish_mutex_lock(&lock));
+    put(&writer, "TFHD", 4);
+    put_uint(&writer, TRIGGERFISH_HEAP_VERSION, 1);
+    for (size_t i = 0; i < types_count; i++) {
+        const size_t length = strlen(types[i].name);
+        put_uint(&writer, 'T', 1);
+        put_uint(&writer, i + 1, 4);
+        put_uint(&writer, length, 2);
+        put(&writer, types[i].name, length);
+    }
+    attach(NULL, &cursor);
+    seagrass_required_true(!triggerfish_mutex_unlock(&lock));
+    bool done = false;
+    while (!done && !writer.failed) {
+        flush(&writer);
+        seagrass_required_true(!triggerfish_mutex_lock(&lock));
+        /* stop early so that traversing the last one rarely grows */
+        for (uintmax_t i = 0; i < TRIGGERFISH_HEAP_CHUNK && !writer.failed
+                && writer.used < TRIGGERFISH_HEAP_BUFFER_SIZE / 2;) {
+            struct triggerfish_strong *const object = cursor.heap_next;
+            if (!object) {
+                done = true;
+                break;
+            }
+            detach(&cursor);
+            attach(object, &cursor);
+            /* either another dump's cursor or waiting to be untracked */
+            const triggerfish_counter_t count = triggerfish_counter_count(
+                    triggerfish_atomic_load(&object->counter));
+            if (count) {
+                put_node(&writer, object, count);
+                i++;
+            }
+        }
+        if (done || writer.failed) {
+            detach(&cursor);
+        }
+        seagrass_required_true(!triggerfish_mutex_unlock(&lock));
+    }
+    put_uint(&writer, 'Z', 1);
+    flush(&writer);
+    free(writer.data);
+    if (writer.exhausted) {
+        return TRIGGERFISH_HEAP_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    return writer.failed ? TRIGGERFISH_HEAP_ERROR_FD_IS_INVALID : 0;
+#endif
+}
@@ -0,0 +1,203 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <errno.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/lazy.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+int triggerfish_lazy_of(int (*const factory)(void *context,
+                                             struct triggerfish_strong **out),
+                        void *const context,
+                        struct triggerfish_lazy **const out) {
+    if (!factory) {
+        return TRIGGERFISH_LAZY_ERROR_FACTORY_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_LAZY_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_lazy *object = calloc(1, sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_LAZY_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    triggerfish_atomic_store(&object->state, TRIGGERFISH_LAZY_EMPTY);
+    object->factory = factory;
+    object->context = context;
+    *out = object;
+    return 0;
+}
+
+int triggerfish_lazy_destroy(struct triggerfish_lazy *const object) {
+    if (!object) {
+        return TRIGGERFISH_LAZY_ERROR_OBJECT_IS_NULL;
+    }
+    const triggerfish_counter_t state = triggerfish_atomic_load(
+            &object->state);
+    seagrass_required_true(!triggerfish_lazy_readers(state));
+    if (TRIGGERFISH_LAZY_READY == triggerfish_lazy_phase(state)) {
+        seagrass_required_true(!triggerfish_strong_release(object->strong));
+    } else {
+        seagrass_required_true(TRIGGERFISH_LAZY_EMPTY
+                               == triggerfish_lazy_phase(state));
+    }
+    free(object);
+    return 0;
+}
+
+/* move on to desired and wake every thread waiting for the state to change */
+static bool change(struct triggerfish_lazy *const object,
+                   triggerfish_counter_t *const expected,
+                   const triggerfish_counter_t desired) {
+    assert(object);
+    assert(expected);
+    if (!triggerfish_atomic_compare_exchange(
+            &object->state, expected, desired & ~TRIGGERFISH_COUNTER_WAITING)) {
+        return false;
+    }
+    if (*expected & TRIGGERFISH_COUNTER_WAITING) {
+        triggerfish_counter_wake(&object->state);
+    }
+    return true;
+}
+
+/* sleep until the state no longer is expected */
+static void await(struct triggerfish_lazy *const object,
+                  triggerfish_counter_t expected) {
+    assert(object);
+    if (!(expected & TRIGGERFISH_COUNTER_WAITING)) {
+        const triggerfish_counter_t desired
+                = expected | TRIGGERFISH_COUNTER_WAITING;
+        if (!triggerfish_atomic_compare_exchange(&object->state, &expected,
+                                                 desired)) {
+            return;
+        }
+        expected = desired;
+    }
+    /* fails only if there is no other thread that could ever wake us */
+    seagrass_required_true(triggerfish_counter_wait(&object->state, expected,
+                                                    NULL));
+}
+
+static void unpin(struct triggerfish_lazy *const object) {
+    assert(object);
+    triggerfish_counter_t desired;
+    triggerfish_counter_t expected = triggerfish_atomic_load(&object->state);
+    do {
+        seagrass_required_true(triggerfish_lazy_readers(expected));
+        desired = expected - TRIGGERFISH_LAZY_READER;
+        /* only a reset waits on readers, and only for the last one */
+        if (!triggerfish_lazy_readers(desired)) {
+            desired &= ~TRIGGERFISH_COUNTER_WAITING;
+        }
+    } while (!triggerfish_atomic_compare_exchange(&object->state, &expected,
+                                                  desired));
+    if ((expected & TRIGGERFISH_COUNTER_WAITING)
+        && !(desired & TRIGGERFISH_COUNTER_WAITING)) {
+        triggerfish_counter_wake(&object->state);
+    }
+}
+
+static int run(struct triggerfish_lazy *const object,
+               struct triggerfish_strong **const out) {
+    assert(object);
+    assert(out);
+    struct triggerfish_strong *strong = NULL;
+    const int error = object->factory(object->context, &strong);
+    if (!error) {
+        seagrass_required_true(strong);
+        seagrass_required_true(!triggerfish_strong_retain(strong));
+        object->strong = strong;
+    }
+    triggerfish_counter_t expected = triggerfish_atomic_load(&object->state);
+    while (!change(object, &expected, error
+                                      ? TRIGGERFISH_LAZY_EMPTY
+                                      : TRIGGERFISH_LAZY_READY)) {
+    }
+    if (!error) {
+        *out = strong;
+    }
+    return error;
+}
+
+int triggerfish_lazy_get(struct triggerfish_lazy *const object,
+                         struct triggerfish_strong **const out) {
+    if (!object) {
+        return TRIGGERFISH_LAZY_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_LAZY_ERROR_OUT_IS_NULL;
+    }
+    triggerfish_counter_t expected = triggerfish_atomic_load(&object->state);
+    for (;;) {
+        switch (triggerfish_lazy_phase(expected)) {
+            case TRIGGERFISH_LAZY_READY: {
+                if (!triggerfish_atomic_compare_exchange(
+                        &object->state, &expected,
+                        expected + TRIGGERFISH_LAZY_READER)) {
+                    break;
+                }
+                /* a reset cannot release it while we are counted */
+                struct triggerfish_strong *const strong = object->strong;
+                seagrass_required_true(!triggerfish_strong_retain(strong));
+                unpin(object);
+                *out = strong;
+                return 0;
+            }
+            case TRIGGERFISH_LAZY_EMPTY: {
+                if (triggerfish_atomic_compare_exchange(
+                        &object->state, &expected,
+                        expected | TRIGGERFISH_LAZY_RUNNING)) {
+                    return run(object, out);
+                }
+                break;
+            }
+            default: {
+                await(object, expected);
+                expected = triggerfish_atomic_load(&object->state);
+                break;
+            }
+        }
+    }
+}
+
+int triggerfish_lazy_reset(struct triggerfish_lazy *const object) {
+    if (!object) {
+        return TRIGGERFISH_LAZY_ERROR_OBJECT_IS_NULL;
+    }
+    triggerfish_counter_t expected = triggerfish_atomic_load(&object->state);
+    for (;;) {
+        const triggerfish_counter_t phase = triggerfish_lazy_phase(expected);
+        if (TRIGGERFISH_LAZY_EMPTY == phase) {
+            return 0;
+        }
+        if (TRIGGERFISH_LAZY_READY != phase) {
+            await(object, expected);
+            expected = triggerfish_atomic_load(&object->state);
+            continue;
+        }
+        const triggerfish_counter_t desired
+                = (expected & ~TRIGGERFISH_LAZY_PHASE)
+                  | TRIGGERFISH_LAZY_RESETTING;
+        if (triggerfish_atomic_compare_exchange(&object->state, &expected,
+                                                desired)) {
+            expected = desired;
+            break;
+        }
+    }
+    /* new readers wait for us, those that are counted have to leave first */
+    while (triggerfish_lazy_readers(expected)) {
+        await(object, expected);
+        expected = triggerfish_atomic_load(&object->state);
+    }
+    struct triggerfish_strong *const strong = object->strong;
+    object->strong = NULL;
+    while (!change(object, &expected, TRIGGERFISH_LAZY_EMPTY)) {
+    }
+    seagrass_required_true(!triggerfish_strong_release(strong));
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/local.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+int triggerfish_local_of(void *const instance,
+                         void (*const on_destroy)(void *instance),
+                         struct triggerfish_local **const out) {
+    if (!instance) {
+        return TRIGGERFISH_LOCAL_ERROR_INSTANCE_IS_NULL;
+    }
+    if (!on_destroy) {
+        return TRIGGERFISH_LOCAL_ERROR_ON_DESTROY_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_LOCAL_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_local *object = malloc(sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_LOCAL_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    *object = (struct triggerfish_local) {
+            .counter = 1,
+            .instance = instance,
+            .on_destroy = on_destroy
+    };
+    *out = object;
+    return 0;
+}
+
+int triggerfish_local_count(const struct triggerfish_local *const object,
+                            uintmax_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_LOCAL_ERROR_OUT_IS_NULL;
+    }
+    *out = object->counter;
+    return 0;
+}
+
+int triggerfish_local_retain(struct triggerfish_local *const object) {
+    if (!object) {
+        return TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL;
+    }
+    if (!object->counter) {
+        return TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_INVALID;
+    }
+    seagrass_required_true(TRIGGERFISH_COUNTER_MAX != object->counter);
+    object->counter += 1;
+    return 0;
+}
+
+int triggerfish_local_release(struct triggerfish_local *const object) {
+    if (!object) {
+        return TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL;
+    }
+    seagrass_required_true(object->counter);
+    object->counter -= 1;
+    if (object->counter) {
+        return 0;
+    }
+    if (object->strong) {
+        seagrass_required_true(!triggerfish_strong_release(object->strong));
+    } else {
+        object->on_destroy(object->instance);
+        free(object->instance);
+    }
+    free(object);
+    return 0;
+}
+
+int triggerfish_local_instance(const struct triggerfish_local *const object,
+                               void **const out) {
+    if (!object) {
+        return TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_LOCAL_ERROR_OUT_IS_NULL;
+    }
+    if (!object->counter) {
+        return TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_INVALID;
+    }
+    *out = object->instance;
+    return 0;
+}
+
+int triggerfish_local_strong(struct triggerfish_local *const object,
+                             struct triggerfish_strong **const out) {
+    if (!object) {
+        return TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_LOCAL_ERROR_OUT_IS_NULL;
+    }
+    if (!object->counter) {
+        return TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_INVALID;
+    }
+    int error;
+    if (!object->strong
+        && (error = triggerfish_strong_of(object->instance,
+                                          object->on_destroy,
+                                          &object->strong))) {
+        seagrass_required_true(
+                TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED == error);
+        return TRIGGERFISH_LOCAL_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    seagrass_required_true(!triggerfish_strong_retain(object->strong));
+    *out = object->strong;
+    return 0;
+}
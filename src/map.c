@@ -0,0 +1,521 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/map.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+static struct triggerfish_map_node *instance(
+        const struct triggerfish_strong *const strong) {
+    assert(strong);
+    return strong->instance;
+}
+
+static const void *key_of(const struct triggerfish_strong *const strong) {
+    assert(strong);
+    void *out;
+    seagrass_required_true(!triggerfish_strong_instance(strong, &out));
+    return out;
+}
+
+static uint32_t bit_of(const uintmax_t hash, const uintmax_t shift) {
+    assert(shift < TRIGGERFISH_MAP_HASH_BITS);
+    return (uint32_t) 1 << ((hash >> shift) & TRIGGERFISH_MAP_MASK);
+}
+
+static uint32_t popcount(uint32_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t) __builtin_popcount(value);
+#else
+    value = value - ((value >> 1) & 0x55555555u);
+    value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+    value = (value + (value >> 4)) & 0x0f0f0f0fu;
+    return (value * 0x01010101u) >> 24;
+#endif
+}
+
+static uint32_t index_of(const struct triggerfish_map_node *const node,
+                         const uint32_t bit) {
+    assert(node);
+    return popcount(node->bitmap & (bit - 1));
+}
+
+static void on_destroy(void *const instance) {
+    struct triggerfish_map_node *const node = instance;
+    for (uint32_t i = 0; i < node->count; i++) {
+        if (node->slots[i].key) {
+            seagrass_required_true(!triggerfish_strong_release(
+                    node->slots[i].key));
+        }
+        seagrass_required_true(!triggerfish_strong_release(
+                node->slots[i].value));
+    }
+}
+
+static size_t size_of(const uint32_t capacity) {
+    return sizeof(struct triggerfish_map_node)
+           + capacity * sizeof(struct triggerfish_map_slot);
+}
+
+static int node_of(const uint32_t capacity,
+                   struct triggerfish_strong **const out) {
+    assert(out);
+    struct triggerfish_map_node *node = malloc(size_of(capacity));
+    if (!node) {
+        return TRIGGERFISH_MAP_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    node->bitmap = 0;
+    node->count = 0;
+    node->capacity = capacity;
+    int error;
+    if ((error = triggerfish_strong_of(node, on_destroy, out))) {
+        seagrass_required_true(
+                TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED == error);
+        free(node);
+        return TRIGGERFISH_MAP_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    return 0;
+}
+
+/*
+ * Make the node in slot exclusively ours with room for extra more slots. A
+ * node only referred to by this version is changed in place, otherwise it is
+ * copied and the copy takes over our reference to its keys, values and
+ * children.
+ */
+static int reserve(struct triggerfish_strong **const slot,
+                   const uint32_t extra) {
+    assert(slot);
+    assert(*slot);
+    struct triggerfish_map_node *node = instance(*slot);
+    const uint32_t capacity = node->count + extra;
+    if (1 == triggerfish_counter_count(
+            triggerfish_atomic_load(&(*slot)->counter))) {
+        if (capacity > node->capacity) {
+            if (!(node = realloc(node, size_of(capacity)))) {
+                return TRIGGERFISH_MAP_ERROR_MEMORY_ALLOCATION_FAILED;
+            }
+            node->capacity = capacity;
+            (*slot)->instance = node;
+        }
+        return 0;
+    }
+    struct triggerfish_strong *copy;
+    int error;
+    if ((error = node_of(capacity, &copy))) {
+        return error;
+    }
+    struct triggerfish_map_node *const into = instance(copy);
+    into->bitmap = node->bitmap;
+    into->count = node->count;
+    memcpy(into->slots, node->slots,
+           node->count * sizeof(struct triggerfish_map_slot));
+    for (uint32_t i = 0; i < into->count; i++) {
+        if (into->slots[i].key) {
+            seagrass_required_true(!triggerfish_strong_retain(
+                    into->slots[i].key));
+        }
+        seagrass_required_true(!triggerfish_strong_retain(
+                into->slots[i].value));
+    }
+    seagrass_required_true(!triggerfish_strong_release(*slot));
+    *slot = copy;
+    return 0;
+}
+
+static void insert(struct triggerfish_map_node *const node,
+                   const uint32_t at,
+                   const struct triggerfish_map_slot slot) {
+    assert(node);
+    assert(node->count < node->capacity);
+    memmove(&node->slots[at + 1], &node->slots[at],
+            (node->count - at) * sizeof(struct triggerfish_map_slot));
+    node->slots[at] = slot;
+    node->count += 1;
+}
+
+static void delete(struct triggerfish_map_node *const node,
+                   const uint32_t at) {
+    assert(node);
+    assert(at < node->count);
+    struct triggerfish_map_slot *const slot = &node->slots[at];
+    if (slot->key) {
+        seagrass_required_true(!triggerfish_strong_release(slot->key));
+    }
+    seagrass_required_true(!triggerfish_strong_release(slot->value));
+    node->count -= 1;
+    memmove(slot, slot + 1,
+            (node->count - at) * sizeof(struct triggerfish_map_slot));
+}
+
+/*
+ * Create the nodes needed below shift to tell the two entries apart, both
+ * entries are handed over to them.
+ */
+static int merge(const struct triggerfish_map_slot first,
+                 const uintmax_t first_hash,
+                 const struct triggerfish_map_slot second,
+                 const uintmax_t second_hash,
+                 const uintmax_t shift,
+                 struct triggerfish_strong **const out) {
+    assert(out);
+    int error;
+    if (shift >= TRIGGERFISH_MAP_HASH_BITS) {
+        if ((error = node_of(2, out))) {
+            return error;
+        }
+        struct triggerfish_map_node *const node = instance(*out);
+        node->slots[0] = first;
+        node->slots[1] = second;
+        node->count = 2;
+        return 0;
+    }
+    const uint32_t first_bit = bit_of(first_hash, shift);
+    const uint32_t second_bit = bit_of(second_hash, shift);
+    if (first_bit == second_bit) {
+        if ((error = node_of(1, out))) {
+            return error;
+        }
+        struct triggerfish_strong *child;
+        if ((error = merge(first, first_hash, second, second_hash,
+                           shift + TRIGGERFISH_MAP_BITS, &child))) {
+            seagrass_required_true(!triggerfish_strong_release(*out));
+            return error;
+        }
+        struct triggerfish_map_node *const node = instance(*out);
+        node->bitmap = first_bit;
+        node->slots[0] = (struct triggerfish_map_slot) {
+                .value = child
+        };
+        node->count = 1;
+        return 0;
+    }
+    if ((error = node_of(2, out))) {
+        return error;
+    }
+    struct triggerfish_map_node *const node = instance(*out);
+    node->bitmap = first_bit | second_bit;
+    node->slots[first_bit < second_bit ? 0 : 1] = first;
+    node->slots[first_bit < second_bit ? 1 : 0] = second;
+    node->count = 2;
+    return 0;
+}
+
+static int put(const struct triggerfish_map *const object,
+               struct triggerfish_strong **const slot,
+               const uintmax_t shift,
+               const uintmax_t hash,
+               const struct triggerfish_map_slot entry,
+               bool *const added) {
+    assert(object);
+    assert(slot);
+    assert(added);
+    const void *const key = key_of(entry.key);
+    struct triggerfish_map_node *node = instance(*slot);
+    uint32_t at;
+    int error;
+    if (shift >= TRIGGERFISH_MAP_HASH_BITS) {
+        for (at = 0; at < node->count; at++) {
+            if (!object->compare(key_of(node->slots[at].key), key)) {
+                break;
+            }
+        }
+        *added = at == node->count;
+        if ((error = reserve(slot, *added ? 1 : 0))) {
+            return error;
+        }
+        node = instance(*slot);
+        if (*added) {
+            insert(node, at, entry);
+        } else {
+            seagrass_required_true(!triggerfish_strong_release(
+                    node->slots[at].value));
+            node->slots[at].value = entry.value;
+        }
+        return 0;
+    }
+    const uint32_t bit = bit_of(hash, shift);
+    at = index_of(node, bit);
+    if (!(node->bitmap & bit)) {
+        if ((error = reserve(slot, 1))) {
+            return error;
+        }
+        node = instance(*slot);
+        insert(node, at, entry);
+        node->bitmap |= bit;
+        *added = true;
+        return 0;
+    }
+    if ((error = reserve(slot, 0))) {
+        return error;
+    }
+    node = instance(*slot);
+    struct triggerfish_map_slot *const found = &node->slots[at];
+    if (!found->key) {
+        return put(object, &found->value, shift + TRIGGERFISH_MAP_BITS,
+                   hash, entry, added);
+    }
+    const void *const other = key_of(found->key);
+    if (!object->compare(other, key)) {
+        seagrass_required_true(!triggerfish_strong_release(found->value));
+        found->value = entry.value;
+        *added = false;
+        return 0;
+    }
+    struct triggerfish_strong *child;
+    if ((error = merge(*found, object->hash(other), entry, hash,
+                       shift + TRIGGERFISH_MAP_BITS, &child))) {
+        return error;
+    }
+    *found = (struct triggerfish_map_slot) {
+            .value = child
+    };
+    *added = true;
+    return 0;
+}
+
+static int find(const struct triggerfish_map *const object,
+                const void *const key,
+                const uintmax_t hash,
+                const struct triggerfish_map_slot **const out) {
+    assert(object);
+    assert(key);
+    assert(out);
+    const struct triggerfish_strong *strong = object->root;
+    for (uintmax_t shift = 0; strong; shift += TRIGGERFISH_MAP_BITS) {
+        const struct triggerfish_map_node *const node = instance(strong);
+        if (shift >= TRIGGERFISH_MAP_HASH_BITS) {
+            for (uint32_t i = 0; i < node->count; i++) {
+                if (!object->compare(key_of(node->slots[i].key), key)) {
+                    *out = &node->slots[i];
+                    return 0;
+                }
+            }
+            break;
+        }
+        const uint32_t bit = bit_of(hash, shift);
+        if (!(node->bitmap & bit)) {
+            break;
+        }
+        const struct triggerfish_map_slot *const slot
+                = &node->slots[index_of(node, bit)];
+        if (slot->key) {
+            if (object->compare(key_of(slot->key), key)) {
+                break;
+            }
+            *out = slot;
+            return 0;
+        }
+        strong = slot->value;
+    }
+    return TRIGGERFISH_MAP_ERROR_KEY_NOT_FOUND;
+}
+
+/* entry for key must be present */
+static int delete_from(const struct triggerfish_map *const object,
+                       struct triggerfish_strong **const slot,
+                       const uintmax_t shift,
+                       const uintmax_t hash,
+                       const void *const key) {
+    assert(object);
+    assert(slot);
+    assert(key);
+    int error;
+    if ((error = reserve(slot, 0))) {
+        return error;
+    }
+    struct triggerfish_map_node *const node = instance(*slot);
+    if (shift >= TRIGGERFISH_MAP_HASH_BITS) {
+        for (uint32_t i = 0; i < node->count; i++) {
+            if (!object->compare(key_of(node->slots[i].key), key)) {
+                delete(node, i);
+                return 0;
+            }
+        }
+        seagrass_required_true(false);
+    }
+    const uint32_t bit = bit_of(hash, shift);
+    const uint32_t at = index_of(node, bit);
+    struct triggerfish_map_slot *const found = &node->slots[at];
+    if (found->key) {
+        delete(node, at);
+        node->bitmap &= ~bit;
+        return 0;
+    }
+    if ((error = delete_from(object, &found->value,
+                             shift + TRIGGERFISH_MAP_BITS, hash, key))) {
+        return error;
+    }
+    const struct triggerfish_map_node *const child = instance(found->value);
+    if (1 == child->count && child->slots[0].key) {
+        /* pull a lone entry up to keep the trie as shallow as possible */
+        const struct triggerfish_map_slot entry = child->slots[0];
+        seagrass_required_true(!triggerfish_strong_retain(entry.key));
+        seagrass_required_true(!triggerfish_strong_retain(entry.value));
+        seagrass_required_true(!triggerfish_strong_release(found->value));
+        *found = entry;
+    }
+    return 0;
+}
+
+int triggerfish_map_of(uintmax_t (*const hash)(const void *instance),
+                       int (*const compare)(const void *first,
+                                            const void *second),
+                       struct triggerfish_map **const out) {
+    if (!hash) {
+        return TRIGGERFISH_MAP_ERROR_HASH_IS_NULL;
+    }
+    if (!compare) {
+        return TRIGGERFISH_MAP_ERROR_COMPARE_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_MAP_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_map *object = calloc(1, sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_MAP_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    object->hash = hash;
+    object->compare = compare;
+    *out = object;
+    return 0;
+}
+
+int triggerfish_map_destroy(struct triggerfish_map *const object) {
+    if (!object) {
+        return TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL;
+    }
+    if (object->root) {
+        seagrass_required_true(!triggerfish_strong_release(object->root));
+    }
+    free(object);
+    return 0;
+}
+
+int triggerfish_map_copy_of(const struct triggerfish_map *const object,
+                            struct triggerfish_map **const out) {
+    if (!object) {
+        return TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_MAP_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_map *copy = malloc(sizeof(*copy));
+    if (!copy) {
+        return TRIGGERFISH_MAP_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    *copy = *object;
+    if (copy->root) {
+        seagrass_required_true(!triggerfish_strong_retain(copy->root));
+    }
+    *out = copy;
+    return 0;
+}
+
+int triggerfish_map_count(const struct triggerfish_map *const object,
+                          uintmax_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_MAP_ERROR_OUT_IS_NULL;
+    }
+    *out = object->count;
+    return 0;
+}
+
+int triggerfish_map_put(struct triggerfish_map *const object,
+                        struct triggerfish_strong *const key,
+                        struct triggerfish_strong *const value) {
+    if (!object) {
+        return TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL;
+    }
+    if (!key) {
+        return TRIGGERFISH_MAP_ERROR_KEY_IS_NULL;
+    }
+    if (!value) {
+        return TRIGGERFISH_MAP_ERROR_VALUE_IS_NULL;
+    }
+    int error;
+    if ((error = triggerfish_strong_retain(key))) {
+        seagrass_required_true(TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID
+                               == error);
+        return TRIGGERFISH_MAP_ERROR_KEY_IS_INVALID;
+    }
+    if ((error = triggerfish_strong_retain(value))) {
+        seagrass_required_true(TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID
+                               == error);
+        seagrass_required_true(!triggerfish_strong_release(key));
+        return TRIGGERFISH_MAP_ERROR_VALUE_IS_INVALID;
+    }
+    bool added;
+    if ((!object->root && (error = node_of(1, &object->root)))
+        || (error = put(object, &object->root, 0,
+                        object->hash(key_of(key)),
+                        (struct triggerfish_map_slot) {
+                                .key = key,
+                                .value = value
+                        }, &added))) {
+        seagrass_required_true(!triggerfish_strong_release(value));
+        seagrass_required_true(!triggerfish_strong_release(key));
+        return error;
+    }
+    if (added) {
+        object->count += 1;
+    } else {
+        /* the equal key already in the map is kept */
+        seagrass_required_true(!triggerfish_strong_release(key));
+    }
+    return 0;
+}
+
+int triggerfish_map_remove(struct triggerfish_map *const object,
+                           const void *const key) {
+    if (!object) {
+        return TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL;
+    }
+    if (!key) {
+        return TRIGGERFISH_MAP_ERROR_KEY_IS_NULL;
+    }
+    const uintmax_t hash = object->hash(key);
+    const struct triggerfish_map_slot *slot;
+    int error;
+    if ((error = find(object, key, hash, &slot))
+        || (error = delete_from(object, &object->root, 0, hash, key))) {
+        return error;
+    }
+    object->count -= 1;
+    if (!object->count) {
+        seagrass_required_true(!triggerfish_strong_release(object->root));
+        object->root = NULL;
+    }
+    return 0;
+}
+
+int triggerfish_map_get(const struct triggerfish_map *const object,
+                        const void *const key,
+                        struct triggerfish_strong **const out) {
+    if (!object) {
+        return TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL;
+    }
+    if (!key) {
+        return TRIGGERFISH_MAP_ERROR_KEY_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_MAP_ERROR_OUT_IS_NULL;
+    }
+    const struct triggerfish_map_slot *slot;
+    int error;
+    if ((error = find(object, key, object->hash(key), &slot))) {
+        return error;
+    }
+    seagrass_required_true(!triggerfish_strong_retain(slot->value));
+    *out = slot->value;
+    return 0;
+}
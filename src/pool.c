@@ -0,0 +1,262 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <assert.h>
+#include <errno.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/pool.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+static size_t align(const size_t size) {
+    const size_t alignment = alignof(max_align_t);
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/* hand every entry of the cache over to the pool while holding its lock */
+static void hand_over(struct triggerfish_pool_cache *const cache) {
+    assert(cache);
+    if (!cache->first) {
+        return;
+    }
+    cache->last->next = cache->pool->first;
+    cache->pool->first = cache->first;
+    cache->first = NULL;
+    cache->last = NULL;
+    cache->count = 0;
+}
+
+#ifndef TRIGGERFISH_SINGLE_THREADED
+static void on_thread_exit(void *const value) {
+    struct triggerfish_pool_cache *const cache = value;
+    struct triggerfish_pool *const pool = cache->pool;
+    seagrass_required_true(!triggerfish_mutex_lock(&pool->lock));
+    hand_over(cache);
+    if (cache->previous) {
+        cache->previous->next = cache->next;
+    } else {
+        pool->caches = cache->next;
+    }
+    if (cache->next) {
+        cache->next->previous = cache->previous;
+    }
+    seagrass_required_true(!triggerfish_mutex_unlock(&pool->lock));
+    free(cache);
+}
+#endif
+
+int triggerfish_pool_of(const size_t size,
+                        void (*const reset)(void *instance),
+                        struct triggerfish_pool **const out) {
+    if (!size) {
+        return TRIGGERFISH_POOL_ERROR_SIZE_IS_ZERO;
+    }
+    if (!out) {
+        return TRIGGERFISH_POOL_ERROR_OUT_IS_NULL;
+    }
+    const size_t offset = align(sizeof(struct triggerfish_strong));
+    if (size > SIZE_MAX - offset) {
+        return TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    struct triggerfish_pool *object = calloc(1, sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    switch (triggerfish_mutex_init(&object->lock)) {
+        default: {
+            seagrass_required_true(false);
+        }
+        case ENOMEM: {
+            free(object);
+            return TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+        case 0: {
+            break;
+        }
+    }
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    switch (pthread_key_create(&object->key, on_thread_exit)) {
+        default: {
+            seagrass_required_true(false);
+        }
+        case EAGAIN:
+        case ENOMEM: {
+            seagrass_required_true(!triggerfish_mutex_destroy(&object->lock));
+            free(object);
+            return TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+        case 0: {
+            break;
+        }
+    }
+#endif
+    object->size = size;
+    object->offset = offset;
+    object->reset = reset;
+    *out = object;
+    return 0;
+}
+
+static void free_entries(struct triggerfish_pool_entry *entry) {
+    while (entry) {
+        struct triggerfish_pool_entry *const next = entry->next;
+        free(entry);
+        entry = next;
+    }
+}
+
+int triggerfish_pool_destroy(struct triggerfish_pool *const object) {
+    if (!object) {
+        return TRIGGERFISH_POOL_ERROR_OBJECT_IS_NULL;
+    }
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    /* threads exiting from now on no longer hand over their cache */
+    seagrass_required_true(!pthread_key_delete(object->key));
+#endif
+    struct triggerfish_pool_cache *cache = object->caches;
+    while (cache) {
+        struct triggerfish_pool_cache *const next = cache->next;
+        free_entries(cache->first);
+        free(cache);
+        cache = next;
+    }
+    free_entries(object->first);
+    seagrass_required_true(!triggerfish_mutex_destroy(&object->lock));
+    free(object);
+    return 0;
+}
+
+/* cache of the calling thread, created on first use unless out of memory */
+static struct triggerfish_pool_cache *cache_of(
+        struct triggerfish_pool *const object) {
+    assert(object);
+#ifdef TRIGGERFISH_SINGLE_THREADED
+    return NULL;
+#else
+    struct triggerfish_pool_cache *cache = pthread_getspecific(object->key);
+    if (cache) {
+        return cache;
+    }
+    cache = calloc(1, sizeof(*cache));
+    if (!cache) {
+        return NULL;
+    }
+    if (pthread_setspecific(object->key, cache)) {
+        free(cache);
+        return NULL;
+    }
+    cache->pool = object;
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    cache->next = object->caches;
+    if (cache->next) {
+        cache->next->previous = cache;
+    }
+    object->caches = cache;
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    return cache;
+#endif
+}
+
+/* take an entry, refilling the cache with up to half of its capacity */
+static struct triggerfish_pool_entry *take(
+        struct triggerfish_pool *const object) {
+    assert(object);
+    struct triggerfish_pool_cache *const cache = cache_of(object);
+    struct triggerfish_pool_entry *entry;
+    if (cache && (entry = cache->first)) {
+        cache->first = entry->next;
+        if (!cache->first) {
+            cache->last = NULL;
+        }
+        cache->count--;
+        return entry;
+    }
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    if ((entry = object->first)) {
+        object->first = entry->next;
+        if (cache) {
+            while (object->first
+                   && cache->count < TRIGGERFISH_POOL_CACHE_MAX / 2) {
+                struct triggerfish_pool_entry *const next = object->first;
+                object->first = next->next;
+                next->next = cache->first;
+                if (!cache->first) {
+                    cache->last = next;
+                }
+                cache->first = next;
+                cache->count++;
+            }
+        }
+    }
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    if (entry) {
+        return entry;
+    }
+    return calloc(1, object->offset + object->size);
+}
+
+int triggerfish_pool_strong_of(struct triggerfish_pool *const object,
+                               void (*const on_destroy)(void *instance),
+                               struct triggerfish_strong **const out) {
+    if (!object) {
+        return TRIGGERFISH_POOL_ERROR_OBJECT_IS_NULL;
+    }
+    if (!on_destroy) {
+        return TRIGGERFISH_POOL_ERROR_ON_DESTROY_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_POOL_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_pool_entry *const entry = take(object);
+    if (!entry) {
+        return TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    struct triggerfish_strong *const strong = (void *) entry;
+    memset(strong, 0, sizeof(*strong));
+    int error;
+    if ((error = triggerfish_strong_init(
+            strong, (unsigned char *) entry + object->offset, on_destroy))) {
+        seagrass_required_true(
+                TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED == error);
+        free(entry);
+        return TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    strong->pool = object;
+    *out = strong;
+    return 0;
+}
+
+void triggerfish_pool_recycle(struct triggerfish_pool *const object,
+                              struct triggerfish_strong *const strong) {
+    assert(object);
+    assert(strong);
+    assert(strong->pool == object);
+    if (object->reset) {
+        object->reset(strong->instance);
+    }
+    struct triggerfish_pool_entry *const entry = (void *) strong;
+    struct triggerfish_pool_cache *const cache = cache_of(object);
+    if (!cache) {
+        seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+        entry->next = object->first;
+        object->first = entry;
+        seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+        return;
+    }
+    if (TRIGGERFISH_POOL_CACHE_MAX == cache->count) {
+        seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+        hand_over(cache);
+        seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    }
+    entry->next = cache->first;
+    if (!cache->first) {
+        cache->last = entry;
+    }
+    cache->first = entry;
+    cache->count++;
+}
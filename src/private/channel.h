@@ -0,0 +1,28 @@
+#ifndef _TRIGGERFISH_PRIVATE_CHANNEL_H_
+#define _TRIGGERFISH_PRIVATE_CHANNEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#define TRIGGERFISH_CHANNEL_CACHE_LINE  64
+
+struct triggerfish_strong;
+struct triggerfish_channel_cell {
+    atomic_uintmax_t sequence;
+    struct triggerfish_strong *strong;
+};
+
+struct triggerfish_channel {
+    atomic_uintmax_t enqueue;
+    unsigned char pad0[TRIGGERFISH_CHANNEL_CACHE_LINE
+                       - sizeof(atomic_uintmax_t)];
+    atomic_uintmax_t dequeue;
+    unsigned char pad1[TRIGGERFISH_CHANNEL_CACHE_LINE
+                       - sizeof(atomic_uintmax_t)];
+    uintmax_t mask;
+    struct triggerfish_channel_cell *cells;
+};
+
+#endif /* _TRIGGERFISH_PRIVATE_CHANNEL_H_ */
@@ -0,0 +1,73 @@
+#ifndef _TRIGGERFISH_PRIVATE_CONFIG_H_
+#define _TRIGGERFISH_PRIVATE_CONFIG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Compile-time variants of the library:
+ * - TRIGGERFISH_SINGLE_THREADED replaces atomics with plain integers and
+ *   drops every lock.
+ * - TRIGGERFISH_NO_WEAK drops the weak reference bookkeeping.
+ * - TRIGGERFISH_COUNTER_BITS sets the width of the reference counters.
+ */
+
+#if !defined(TRIGGERFISH_COUNTER_BITS)
+typedef uintmax_t triggerfish_counter_t;
+#define TRIGGERFISH_COUNTER_MAX         UINTMAX_MAX
+#elif 32 == TRIGGERFISH_COUNTER_BITS
+typedef uint32_t triggerfish_counter_t;
+#define TRIGGERFISH_COUNTER_MAX         UINT32_MAX
+#elif 64 == TRIGGERFISH_COUNTER_BITS
+typedef uint64_t triggerfish_counter_t;
+#define TRIGGERFISH_COUNTER_MAX         UINT64_MAX
+#else
+#error "TRIGGERFISH_COUNTER_BITS must be either 32 or 64"
+#endif
+
+#ifdef TRIGGERFISH_SINGLE_THREADED
+#define TRIGGERFISH_ATOMIC(type)        type
+#define triggerfish_atomic_load(object) \
+    (*(object))
+#define triggerfish_atomic_store(object, desired) \
+    ((void) (*(object) = (desired)))
+#define triggerfish_atomic_compare_exchange(object, expected, desired) \
+    (*(object) == *(expected) \
+     ? (*(object) = (desired), true) \
+     : (*(expected) = *(object), false))
+#define triggerfish_atomic_add(object, operand) \
+    ((void) (*(object) += (operand)))
+#define triggerfish_atomic_subtract(object, operand) \
+    ((void) (*(object) -= (operand)))
+#define triggerfish_mutex_init(mutex)       0
+#define triggerfish_mutex_destroy(mutex)    0
+#define triggerfish_mutex_lock(mutex)       0
+#define triggerfish_mutex_trylock(mutex)    0
+#define triggerfish_mutex_unlock(mutex)     0
+#define triggerfish_yield()                 ((void) 0)
+#else
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define TRIGGERFISH_ATOMIC(type)        _Atomic(type)
+#define triggerfish_atomic_load(object) \
+    atomic_load(object)
+#define triggerfish_atomic_store(object, desired) \
+    atomic_store(object, desired)
+#define triggerfish_atomic_compare_exchange(object, expected, desired) \
+    atomic_compare_exchange_strong(object, expected, desired)
+#define triggerfish_atomic_add(object, operand) \
+    ((void) atomic_fetch_add(object, operand))
+#define triggerfish_atomic_subtract(object, operand) \
+    ((void) atomic_fetch_sub(object, operand))
+#define triggerfish_mutex_init(mutex)       pthread_mutex_init(mutex, NULL)
+#define triggerfish_mutex_destroy(mutex)    pthread_mutex_destroy(mutex)
+#define triggerfish_mutex_lock(mutex)       pthread_mutex_lock(mutex)
+#define triggerfish_mutex_trylock(mutex)    pthread_mutex_trylock(mutex)
+#define triggerfish_mutex_unlock(mutex)     pthread_mutex_unlock(mutex)
+#define triggerfish_yield()                 sched_yield()
+#endif
+
+#endif /* _TRIGGERFISH_PRIVATE_CONFIG_H_ */
@@ -0,0 +1,85 @@
+#ifndef _TRIGGERFISH_PRIVATE_COUNTER_H_
+#define _TRIGGERFISH_PRIVATE_COUNTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <time.h>
+
+#include "config.h"
+
+/* set in a reference counter while a thread waits for it to change */
+#define TRIGGERFISH_COUNTER_WAITING \
+    ((triggerfish_counter_t) 1 \
+     << (sizeof(triggerfish_counter_t) * CHAR_BIT - 1))
+
+#define triggerfish_counter_count(value) \
+    ((value) & ~TRIGGERFISH_COUNTER_WAITING)
+
+/**
+ * @brief Compute the deadline of a wait.
+ * @param [in] timeout relative timeout or <i>NULL</i> to wait indefinitely.
+ * @param [out] out receive the absolute deadline on the monotonic clock.
+ * @return <i>true</i> if timeout is valid, otherwise <i>false</i>.
+ */
+bool triggerfish_counter_deadline(const struct timespec *timeout,
+                                  struct timespec *out);
+
+/**
+ * @brief Wake the threads waiting on the reference counter.
+ * @param [in] object reference counter whose waiting flag was cleared.
+ * @note Only the address is used, so this may be invoked after a decrement
+ * even though the counter may have been freed by then.
+ */
+void triggerfish_counter_wake(
+        TRIGGERFISH_ATOMIC(triggerfish_counter_t) *object);
+
+/**
+ * @brief Sleep while the counter still holds value.
+ * @param [in] object counter to wait on.
+ * @param [in] value last seen in the counter with the waiting flag set, so
+ * that whoever changes it next clears the flag and wakes the waiting
+ * threads.
+ * @param [in] deadline absolute on the monotonic clock, or <i>NULL</i> to
+ * wait indefinitely.
+ * @return <i>true</i> once woken or if the counter no longer holds value,
+ * otherwise <i>false</i> if the deadline passed first or there is no other
+ * thread which could change the counter.
+ * @note Waking up spuriously is possible. Every change has to touch the low
+ * 32 bits of the counter so that it cannot be missed.
+ */
+bool triggerfish_counter_wait(
+        TRIGGERFISH_ATOMIC(triggerfish_counter_t) *object,
+        triggerfish_counter_t value,
+        const struct timespec *deadline);
+
+/**
+ * @brief Block until the calling thread holds the only reference counted.
+ * @param [in] object reference counter of which the caller holds a
+ * reference.
+ * @param [in] deadline absolute on the monotonic clock, or <i>NULL</i> to
+ * wait indefinitely.
+ * @return <i>true</i> once the count is <i>1</i>, otherwise <i>false</i> if
+ * the deadline passed first.
+ */
+bool triggerfish_counter_await_unique(
+        TRIGGERFISH_ATOMIC(triggerfish_counter_t) *object,
+        const struct timespec *deadline);
+
+/**
+ * @brief Block until the calling thread holds the only reference counted and
+ * release it.
+ * @param [in] object reference counter of which the caller holds a
+ * reference.
+ * @param [in] deadline absolute on the monotonic clock, or <i>NULL</i> to
+ * wait indefinitely.
+ * @return <i>true</i> once the count dropped to <i>0</i> and the caller has
+ * to destroy the instance, otherwise <i>false</i> if the deadline passed
+ * first and the caller still holds its reference.
+ */
+bool triggerfish_counter_release_unique(
+        TRIGGERFISH_ATOMIC(triggerfish_counter_t) *object,
+        const struct timespec *deadline);
+
+#endif /* _TRIGGERFISH_PRIVATE_COUNTER_H_ */
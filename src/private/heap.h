@@ -0,0 +1,42 @@
+#ifndef _TRIGGERFISH_PRIVATE_HEAP_H_
+#define _TRIGGERFISH_PRIVATE_HEAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+#define TRIGGERFISH_HEAP_VERSION        1
+/* initial size, chunks larger than that grow the buffer while taken */
+#define TRIGGERFISH_HEAP_BUFFER_SIZE    (64 * 1024)
+/* strong references written between two stop points at most */
+#define TRIGGERFISH_HEAP_CHUNK          256
+
+struct triggerfish_strong;
+struct triggerfish_heap_type {
+    void (*on_destroy)(void *instance);
+    char *name;
+    size_t (*size)(const void *instance);
+    void (*traverse)(const void *instance,
+                     void (*visit)(const struct triggerfish_strong *child,
+                                   void *context),
+                     void *context);
+};
+
+#ifdef TRIGGERFISH_HEAP_DUMP
+/**
+ * @brief Add newly created strong reference to the live strong references.
+ * @param [in] object strong reference.
+ */
+void triggerfish_heap_track(struct triggerfish_strong *object);
+
+/**
+ * @brief Remove strong reference from the live strong references before its
+ * instance is destroyed.
+ * @param [in] object strong reference.
+ */
+void triggerfish_heap_untrack(struct triggerfish_strong *object);
+#endif
+
+#endif /* _TRIGGERFISH_PRIVATE_HEAP_H_ */
@@ -0,0 +1,36 @@
+#ifndef _TRIGGERFISH_PRIVATE_LAZY_H_
+#define _TRIGGERFISH_PRIVATE_LAZY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+#include "counter.h"
+
+/* phase of the lazy cell in the low bits of its state */
+#define TRIGGERFISH_LAZY_EMPTY          0
+#define TRIGGERFISH_LAZY_RUNNING        1
+#define TRIGGERFISH_LAZY_READY          2
+#define TRIGGERFISH_LAZY_RESETTING      3
+#define TRIGGERFISH_LAZY_PHASE          3
+/* callers reading the strong reference are counted above the phase */
+#define TRIGGERFISH_LAZY_READER         4
+
+#define triggerfish_lazy_phase(value) \
+    ((value) & TRIGGERFISH_LAZY_PHASE)
+
+#define triggerfish_lazy_readers(value) \
+    (triggerfish_counter_count(value) / TRIGGERFISH_LAZY_READER)
+
+struct triggerfish_strong;
+struct triggerfish_lazy {
+    /* phase, readers and whether a thread waits for them to change */
+    TRIGGERFISH_ATOMIC(triggerfish_counter_t) state;
+    /* written while running or once resetting has no readers left */
+    struct triggerfish_strong *strong;
+    int (*factory)(void *context, struct triggerfish_strong **out);
+    void *context;
+};
+
+#endif /* _TRIGGERFISH_PRIVATE_LAZY_H_ */
@@ -0,0 +1,19 @@
+#ifndef _TRIGGERFISH_PRIVATE_LOCAL_H_
+#define _TRIGGERFISH_PRIVATE_LOCAL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+struct triggerfish_strong;
+struct triggerfish_local {
+    triggerfish_counter_t counter;
+    void *instance;
+    struct triggerfish_strong *strong;
+
+    void (*on_destroy)(void *instance);
+};
+
+#endif /* _TRIGGERFISH_PRIVATE_LOCAL_H_ */
@@ -0,0 +1,38 @@
+#ifndef _TRIGGERFISH_PRIVATE_MAP_H_
+#define _TRIGGERFISH_PRIVATE_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#define TRIGGERFISH_MAP_BITS            5
+#define TRIGGERFISH_MAP_MASK            ((1 << TRIGGERFISH_MAP_BITS) - 1)
+#define TRIGGERFISH_MAP_HASH_BITS       (sizeof(uintmax_t) * CHAR_BIT)
+
+struct triggerfish_strong;
+
+/* key is NULL when value refers to a child node */
+struct triggerfish_map_slot {
+    struct triggerfish_strong *key;
+    struct triggerfish_strong *value;
+};
+
+/* nodes past the last hash bits hold colliding keys in any order */
+struct triggerfish_map_node {
+    uint32_t bitmap;
+    uint32_t count;
+    uint32_t capacity;
+    struct triggerfish_map_slot slots[];
+};
+
+struct triggerfish_map {
+    uintmax_t count;
+    struct triggerfish_strong *root;
+
+    uintmax_t (*hash)(const void *instance);
+
+    int (*compare)(const void *first, const void *second);
+};
+
+#endif /* _TRIGGERFISH_PRIVATE_MAP_H_ */
@@ -0,0 +1,54 @@
+#ifndef _TRIGGERFISH_PRIVATE_POOL_H_
+#define _TRIGGERFISH_PRIVATE_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+/* entries a thread keeps for itself before handing them to the pool */
+#define TRIGGERFISH_POOL_CACHE_MAX      64
+
+/* strong reference and instance while they wait to be reused */
+struct triggerfish_pool_entry {
+    struct triggerfish_pool_entry *next;
+};
+
+struct triggerfish_pool;
+struct triggerfish_pool_cache {
+    struct triggerfish_pool *pool;
+    /* caches of the pool, guarded by its lock */
+    struct triggerfish_pool_cache *next;
+    struct triggerfish_pool_cache *previous;
+    struct triggerfish_pool_entry *first;
+    struct triggerfish_pool_entry *last;
+    uintmax_t count;
+};
+
+struct triggerfish_pool {
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    pthread_mutex_t lock;
+    pthread_key_t key;
+#endif
+    size_t size;
+    /* of the instance behind the strong reference */
+    size_t offset;
+    void (*reset)(void *instance);
+    /* handed over by the caches, guarded by lock */
+    struct triggerfish_pool_entry *first;
+    struct triggerfish_pool_cache *caches;
+};
+
+struct triggerfish_strong;
+
+/**
+ * @brief Reset instance and return it together with its strong reference
+ * to the pool.
+ * @param [in] object pool instance.
+ * @param [in] strong destroyed strong reference created from the pool.
+ */
+void triggerfish_pool_recycle(struct triggerfish_pool *object,
+                              struct triggerfish_strong *strong);
+
+#endif /* _TRIGGERFISH_PRIVATE_POOL_H_ */
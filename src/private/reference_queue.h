@@ -0,0 +1,51 @@
+#ifndef _TRIGGERFISH_PRIVATE_REFERENCE_QUEUE_H_
+#define _TRIGGERFISH_PRIVATE_REFERENCE_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "config.h"
+
+struct triggerfish_reference_queue;
+struct triggerfish_reference_queue_entry {
+    struct triggerfish_reference_queue_entry *next;
+    struct triggerfish_reference_queue *queue;
+    void *cookie;
+};
+
+struct triggerfish_reference_queue {
+    /* entries pushed by invalidations, newest first */
+    _Atomic(struct triggerfish_reference_queue_entry *) pushed;
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    pthread_mutex_t lock;
+#endif
+    /* entries taken over by consumers, oldest first, guarded by the lock */
+    struct triggerfish_reference_queue_entry *first;
+};
+
+/**
+ * @brief Create entry which is pushed once its weak reference is
+ * invalidated.
+ * @param [in] object reference queue instance.
+ * @param [in] cookie to hand to consumers.
+ * @param [out] out receive the newly created entry.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_REFERENCE_QUEUE_ERROR_MEMORY_ALLOCATION_FAILED if there
+ * is not enough memory to create the entry.
+ * @note Allocated up front so that invalidation cannot fail.
+ */
+int triggerfish_reference_queue_entry_of(
+        struct triggerfish_reference_queue *object,
+        void *cookie,
+        struct triggerfish_reference_queue_entry **out);
+
+/**
+ * @brief Push entry onto its reference queue.
+ * @param [in] entry which the reference queue takes over.
+ */
+void triggerfish_reference_queue_push(
+        struct triggerfish_reference_queue_entry *entry);
+
+#endif /* _TRIGGERFISH_PRIVATE_REFERENCE_QUEUE_H_ */
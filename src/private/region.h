@@ -0,0 +1,97 @@
+#ifndef _TRIGGERFISH_PRIVATE_REGION_H_
+#define _TRIGGERFISH_PRIVATE_REGION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sea-urchin.h>
+
+#include "config.h"
+#include "strong.h"
+
+#define TRIGGERFISH_REGION_CHUNK_SIZE    (64 * 1024)
+
+struct triggerfish_region_chunk {
+    struct triggerfish_region_chunk *next;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+};
+
+struct triggerfish_region_entry {
+    struct triggerfish_strong strong;
+    struct triggerfish_region_entry *next;
+};
+
+struct triggerfish_weak;
+struct triggerfish_region {
+    TRIGGERFISH_ATOMIC(triggerfish_counter_t) counter;
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    pthread_mutex_t lock;
+#endif
+#ifndef TRIGGERFISH_NO_WEAK
+    struct coral_red_black_tree_container weak_refs;
+#endif
+    struct triggerfish_region_chunk *chunks;
+    struct triggerfish_region_entry *entries;
+};
+
+#ifndef TRIGGERFISH_NO_WEAK
+/**
+ * @brief Register weak reference for invalidation when region is destroyed.
+ * @param [in] object region.
+ * @param [in] weak reference that will be invalidated.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID if object has been
+ * invalidated.
+ * @throws TRIGGERFISH_STRONG_ERROR_WEAK_ALREADY_REGISTERED if weak reference
+ * is already registered.
+ * @throws TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to register weak reference.
+ */
+int triggerfish_region_register(struct triggerfish_region *object,
+                                struct triggerfish_weak *weak);
+
+/**
+ * @brief Register weak reference for invalidation when region is
+ * destroyed while it is only kept alive by a borrow.
+ * @param [in] object region.
+ * @param [in] weak reference that will be invalidated.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID if object has been
+ * invalidated.
+ * @throws TRIGGERFISH_STRONG_ERROR_WEAK_ALREADY_REGISTERED if weak reference
+ * is already registered.
+ * @throws TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to register weak reference.
+ * @note Unlike registration through a retained reference, object may be
+ * in the middle of being destroyed and holding its lock until the borrow
+ * ends; this is detected instead of waiting for the lock.
+ */
+int triggerfish_region_register_borrowed(struct triggerfish_region *object,
+                                         struct triggerfish_weak *weak);
+
+/**
+ * @brief Unregister weak reference for invalidation when region is destroyed.
+ * @param [in] object region.
+ * @param [in] weak reference that will be invalidated.
+ * @return <i>true</i> if weak reference was unregistered, otherwise
+ * <i>false</i> if region is being destroyed and will invalidate it.
+ */
+bool triggerfish_region_unregister(struct triggerfish_region *object,
+                                   const struct triggerfish_weak *weak);
+#endif
+
+/**
+ * @brief Release the reference to the region once it is the only one left
+ * and destroy the region.
+ * @param [in] object region of which the caller holds a reference.
+ * @param [in] deadline absolute on the monotonic clock, or <i>NULL</i> to
+ * wait indefinitely.
+ * @return <i>true</i> if the region was destroyed, otherwise <i>false</i> if
+ * the deadline passed first and the caller still holds its reference.
+ */
+bool triggerfish_region_release_unique(struct triggerfish_region *object,
+                                       const struct timespec *deadline);
+
+#endif /* _TRIGGERFISH_PRIVATE_REGION_H_ */
@@ -0,0 +1,46 @@
+#ifndef _TRIGGERFISH_PRIVATE_SHARED_H_
+#define _TRIGGERFISH_PRIVATE_SHARED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* "trgfish" followed by the layout version */
+#define TRIGGERFISH_SHARED_MAGIC        UINT64_C(0x7472676669736801)
+#define TRIGGERFISH_SHARED_INDEX_MASK   UINT64_C(0xffffffff)
+
+/*
+ * Everything in the segment is addressed by offsets from its start since
+ * every process maps it at a different address.
+ */
+struct triggerfish_shared_block {
+    atomic_uint_least64_t counter;
+    /* index + 1 of the next free block, 0 terminates */
+    atomic_uint_least64_t next;
+};
+
+struct triggerfish_shared_segment {
+    atomic_uint_least64_t magic;
+    uint64_t size;
+    uint64_t stride;
+    uint64_t count;
+    uint64_t processes;
+    /* offset of the pid of each attached process, 0 for a free slot */
+    uint64_t pids;
+    /* offset of the block control blocks */
+    uint64_t blocks;
+    /* offset of the references held by each process to each block */
+    uint64_t holds;
+    /* offset of the first block */
+    uint64_t data;
+    /* tag << 32 | index + 1 of the first free block */
+    atomic_uint_least64_t free;
+};
+
+struct triggerfish_shared {
+    struct triggerfish_shared_segment *segment;
+    uint64_t process;
+};
+
+#endif /* _TRIGGERFISH_PRIVATE_SHARED_H_ */
@@ -0,0 +1,22 @@
+#ifndef _TRIGGERFISH_PRIVATE_SOFT_H_
+#define _TRIGGERFISH_PRIVATE_SOFT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+struct triggerfish_weak;
+struct triggerfish_strong;
+struct triggerfish_soft_cache;
+struct triggerfish_soft {
+    struct triggerfish_soft_cache *cache;
+    struct triggerfish_weak *weak;
+    /* held until the cache clears the soft reference, guarded by its lock */
+    struct triggerfish_strong *strong;
+    size_t size;
+    bool referenced;
+    struct triggerfish_soft *next;
+    struct triggerfish_soft *previous;
+};
+
+#endif /* _TRIGGERFISH_PRIVATE_SOFT_H_ */
@@ -0,0 +1,65 @@
+#ifndef _TRIGGERFISH_PRIVATE_SOFT_CACHE_H_
+#define _TRIGGERFISH_PRIVATE_SOFT_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+struct triggerfish_soft;
+struct triggerfish_strong;
+struct triggerfish_soft_cache {
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    pthread_mutex_t lock;
+#endif
+    size_t budget;
+    size_t usage;
+    /* clock hand into the ring of soft references that are not cleared */
+    struct triggerfish_soft *hand;
+    bool polled;
+    uintmax_t pressure;
+};
+
+/**
+ * @brief Add soft reference to the cache and clear soft references until
+ * the budget is met again.
+ * @param [in] object cache instance.
+ * @param [in] soft reference holding a strong reference.
+ */
+void triggerfish_soft_cache_insert(struct triggerfish_soft_cache *object,
+                                   struct triggerfish_soft *soft);
+
+/**
+ * @brief Remove soft reference from the cache unless it was cleared.
+ * @param [in] object cache instance.
+ * @param [in] soft reference.
+ * @return the strong reference the soft reference held, otherwise
+ * <i>NULL</i> if it was cleared.
+ */
+struct triggerfish_strong *triggerfish_soft_cache_remove(
+        struct triggerfish_soft_cache *object,
+        struct triggerfish_soft *soft);
+
+/**
+ * @brief Mark soft reference as recently used and retain its strong
+ * reference.
+ * @param [in] object cache instance.
+ * @param [in] soft reference.
+ * @return the retained strong reference, otherwise <i>NULL</i> if the soft
+ * reference was cleared.
+ */
+struct triggerfish_strong *triggerfish_soft_cache_touch(
+        struct triggerfish_soft_cache *object,
+        struct triggerfish_soft *soft);
+
+/**
+ * @brief Check whether the soft reference still holds its strong reference.
+ * @param [in] object cache instance.
+ * @param [in] soft reference.
+ * @return <i>true</i> if it does, otherwise <i>false</i> if it was cleared.
+ */
+bool triggerfish_soft_cache_holds(struct triggerfish_soft_cache *object,
+                                  const struct triggerfish_soft *soft);
+
+#endif /* _TRIGGERFISH_PRIVATE_SOFT_CACHE_H_ */
@@ -4,24 +4,72 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
-#include <stdatomic.h>
-#include <pthread.h>
-#include <coral.h>
 #include <sea-urchin.h>
 
+#include "config.h"
+#include "counter.h"
+
+#ifndef TRIGGERFISH_NO_WEAK
+#include <coral.h>
+
 #define TRIGGERFISH_STRONG_ERROR_WEAK_ALREADY_REGISTERED \
     SEA_URCHIN_ERROR_VALUE_ALREADY_EXISTS
+#endif
 
 struct triggerfish_weak;
+struct triggerfish_region;
+struct triggerfish_pool;
+/* aliases are only as large as the members both start with */
+struct triggerfish_strong_alias {
+    void *instance;
+    /* strong reference whose instance instance is a part of */
+    struct triggerfish_strong *parent;
+};
+
 struct triggerfish_strong {
-    atomic_uintmax_t counter;
     void *instance;
+    /* always NULL, set for aliases only */
+    struct triggerfish_strong *parent;
+    TRIGGERFISH_ATOMIC(triggerfish_counter_t) counter;
+#ifndef TRIGGERFISH_NO_WEAK
+#ifndef TRIGGERFISH_SINGLE_THREADED
     pthread_mutex_t lock;
+#endif
     struct coral_red_black_tree_container weak_refs;
+#endif
+    struct triggerfish_region *region;
+    /* recycles the strong reference together with its instance */
+    struct triggerfish_pool *pool;
+#ifdef TRIGGERFISH_HEAP_DUMP
+    /* live strong references, guarded by the heap's lock */
+    struct triggerfish_strong *heap_next;
+    struct triggerfish_strong *heap_previous;
+#endif
 
     void (*on_destroy)(void *instance);
 };
 
+/**
+ * @brief Initialize strong reference with a reference count of one.
+ * @param [in] object zero-filled strong reference.
+ * @param [in] instance of the strong reference.
+ * @param [in] on_destroy function which will be invoked when the strong
+ * reference is being destroyed.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to initialize the strong reference.
+ */
+int triggerfish_strong_init(struct triggerfish_strong *object,
+                            void *instance,
+                            void (*on_destroy)(void *instance));
+
+/**
+ * @brief Destroy strong reference whose reference count dropped to zero.
+ * @param [in] object strong reference.
+ */
+void triggerfish_strong_destroy(struct triggerfish_strong *object);
+
+#ifndef TRIGGERFISH_NO_WEAK
 /**
  * @brief Register weak reference for invalidation when strong reference is
  * destroyed.
@@ -38,13 +86,35 @@ struct triggerfish_strong {
 int triggerfish_strong_register(struct triggerfish_strong *object,
                                 struct triggerfish_weak *weak);
 
+/**
+ * @brief Register weak reference for invalidation when strong reference is
+ * destroyed while it is only kept alive by a borrow.
+ * @param [in] object strong reference.
+ * @param [in] weak reference that will be invalidated.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID if object has been
+ * invalidated.
+ * @throws TRIGGERFISH_STRONG_ERROR_WEAK_ALREADY_REGISTERED if weak reference
+ * is already registered.
+ * @throws TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to register weak reference.
+ * @note Unlike registration through a retained reference, object may be
+ * in the middle of being destroyed and holding its lock until the borrow
+ * ends; this is detected instead of waiting for the lock.
+ */
+int triggerfish_strong_register_borrowed(struct triggerfish_strong *object,
+                                         struct triggerfish_weak *weak);
+
 /**
  * @brief Unregister weak reference for invalidation when strong reference is
  * destroyed.
  * @param [in] object strong reference.
  * @param [in] weak reference that will be invalidated.
+ * @return <i>true</i> if weak reference was unregistered, otherwise
+ * <i>false</i> if strong reference is being destroyed and will invalidate it.
  */
-void triggerfish_strong_unregister(struct triggerfish_strong *object,
+bool triggerfish_strong_unregister(struct triggerfish_strong *object,
                                    const struct triggerfish_weak *weak);
+#endif
 
 #endif /* _TRIGGERFISH_PRIVATE_STRONG_H_ */
@@ -0,0 +1,66 @@
+#ifndef _TRIGGERFISH_PRIVATE_TEARDOWN_H_
+#define _TRIGGERFISH_PRIVATE_TEARDOWN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+/* pointers a worker collects before freeing them together */
+#define TRIGGERFISH_TEARDOWN_BATCH      256
+#define TRIGGERFISH_TEARDOWN_DEQUE      1024
+
+struct triggerfish_strong;
+struct triggerfish_teardown;
+struct triggerfish_teardown_worker {
+    struct triggerfish_teardown *teardown;
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    pthread_t thread;
+    /* guards the deque, the owner takes from its bottom and thieves from
+     * its top */
+    pthread_mutex_t lock;
+#endif
+    struct triggerfish_strong **deque;
+    size_t capacity;
+    size_t top;
+    size_t bottom;
+    void *batch[TRIGGERFISH_TEARDOWN_BATCH];
+    size_t batched;
+};
+
+struct triggerfish_teardown {
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    /* held for the duration of a release */
+    pthread_mutex_t release;
+    /* guards generation, running and stopping */
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+#endif
+    uintmax_t generation;
+    size_t running;
+    bool stopping;
+    /* queued strong references which have not been destroyed yet */
+    TRIGGERFISH_ATOMIC(uintmax_t) pending;
+    size_t count;
+    struct triggerfish_teardown_worker workers[];
+};
+
+/**
+ * @brief Queue strong reference whose count dropped to zero for destruction
+ * if the calling thread is a worker of a teardown.
+ * @param [in] strong reference to destroy.
+ * @return <i>true</i> if it was queued, otherwise <i>false</i> if the caller
+ * has to destroy it.
+ */
+bool triggerfish_teardown_defer(struct triggerfish_strong *strong);
+
+/**
+ * @brief Free memory, or batch it if the calling thread is a worker of a
+ * teardown.
+ * @param [in] pointer to free.
+ */
+void triggerfish_teardown_free(void *pointer);
+
+#endif /* _TRIGGERFISH_PRIVATE_TEARDOWN_H_ */
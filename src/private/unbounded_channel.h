@@ -0,0 +1,24 @@
+#ifndef _TRIGGERFISH_PRIVATE_UNBOUNDED_CHANNEL_H_
+#define _TRIGGERFISH_PRIVATE_UNBOUNDED_CHANNEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "channel.h"
+
+struct triggerfish_strong;
+struct triggerfish_unbounded_channel_node {
+    _Atomic(struct triggerfish_unbounded_channel_node *) next;
+    struct triggerfish_strong *strong;
+};
+
+struct triggerfish_unbounded_channel {
+    _Atomic(struct triggerfish_unbounded_channel_node *) head;
+    unsigned char pad0[TRIGGERFISH_CHANNEL_CACHE_LINE
+                       - sizeof(struct triggerfish_unbounded_channel_node *)];
+    struct triggerfish_unbounded_channel_node *tail;
+};
+
+#endif /* _TRIGGERFISH_PRIVATE_UNBOUNDED_CHANNEL_H_ */
@@ -0,0 +1,14 @@
+#ifndef _TRIGGERFISH_PRIVATE_UNIQUE_H_
+#define _TRIGGERFISH_PRIVATE_UNIQUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+struct triggerfish_unique {
+    void *instance;
+
+    void (*on_destroy)(void *instance);
+};
+
+#endif /* _TRIGGERFISH_PRIVATE_UNIQUE_H_ */
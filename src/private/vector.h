@@ -0,0 +1,27 @@
+#ifndef _TRIGGERFISH_PRIVATE_VECTOR_H_
+#define _TRIGGERFISH_PRIVATE_VECTOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#define TRIGGERFISH_VECTOR_BITS         5
+#define TRIGGERFISH_VECTOR_WIDTH        (1 << TRIGGERFISH_VECTOR_BITS)
+#define TRIGGERFISH_VECTOR_MASK         (TRIGGERFISH_VECTOR_WIDTH - 1)
+#define TRIGGERFISH_VECTOR_MAX_DEPTH \
+    ((sizeof(uintmax_t) * CHAR_BIT + TRIGGERFISH_VECTOR_BITS - 1) \
+     / TRIGGERFISH_VECTOR_BITS)
+
+struct triggerfish_strong;
+struct triggerfish_vector_node {
+    struct triggerfish_strong *slots[TRIGGERFISH_VECTOR_WIDTH];
+};
+
+struct triggerfish_vector {
+    uintmax_t count;
+    uintmax_t shift;
+    struct triggerfish_strong *root;
+};
+
+#endif /* _TRIGGERFISH_PRIVATE_VECTOR_H_ */
@@ -4,10 +4,108 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
-#include <stdatomic.h>
+#include <coral.h>
 
+#include "config.h"
+#include "counter.h"
+
+#define TRIGGERFISH_WEAK_DEBUG_BORROWS  32
+#define TRIGGERFISH_WEAK_DEBUG_TAKEN    32
+
+/* set in borrows while the destroyer of the owner invalidates the weak */
+#define TRIGGERFISH_WEAK_CLAIMED        (TRIGGERFISH_COUNTER_WAITING >> 1)
+/* set in borrows once the destroyer has been left to free the weak */
+#define TRIGGERFISH_WEAK_DESTROYED      (TRIGGERFISH_COUNTER_WAITING >> 2)
+/* set in borrows of weak references kept around after they were taken */
+#define TRIGGERFISH_WEAK_TAKEN          (TRIGGERFISH_COUNTER_WAITING >> 3)
+
+#define triggerfish_weak_borrows(value) \
+    ((value) & ~(TRIGGERFISH_COUNTER_WAITING | TRIGGERFISH_WEAK_CLAIMED \
+                 | TRIGGERFISH_WEAK_DESTROYED | TRIGGERFISH_WEAK_TAKEN))
+
+struct triggerfish_reference_queue_entry;
 struct triggerfish_weak {
-    atomic_uintptr_t strong;
+    TRIGGERFISH_ATOMIC(uintptr_t) strong;
+    TRIGGERFISH_ATOMIC(triggerfish_counter_t) borrows;
+    /* pushed on invalidation, guarded by the lock of the strong reference */
+    struct triggerfish_reference_queue_entry *entry;
+};
+
+/* strong reference or region with which weak references are registered */
+struct triggerfish_weak_owner {
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    pthread_mutex_t *lock;
+#endif
+    TRIGGERFISH_ATOMIC(triggerfish_counter_t) *counter;
+    struct coral_red_black_tree_container *weak_refs;
 };
 
+/**
+ * @brief Order the entries of the weak references of an owner.
+ * @param [in] a entry holding a weak reference.
+ * @param [in] b entry holding a weak reference.
+ * @return Comparison of the addresses of the weak references.
+ */
+int triggerfish_weak_owner_compare(const void *a, const void *b);
+
+/**
+ * @brief Register weak reference for invalidation when owner is destroyed.
+ * @param [in] owner strong reference or region.
+ * @param [in] weak reference that will be invalidated.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID if owner has been
+ * invalidated.
+ * @throws TRIGGERFISH_STRONG_ERROR_WEAK_ALREADY_REGISTERED if weak reference
+ * is already registered.
+ * @throws TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to register weak reference.
+ */
+int triggerfish_weak_owner_register(const struct triggerfish_weak_owner *owner,
+                                    struct triggerfish_weak *weak);
+
+/**
+ * @brief Register weak reference for invalidation when owner is destroyed
+ * while it is only kept alive by a borrow.
+ * @param [in] owner strong reference or region.
+ * @param [in] weak reference that will be invalidated.
+ * @return On success <i>0</i>, otherwise an error code.
+ * @throws TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID if owner has been
+ * invalidated.
+ * @throws TRIGGERFISH_STRONG_ERROR_WEAK_ALREADY_REGISTERED if weak reference
+ * is already registered.
+ * @throws TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED if there is
+ * insufficient memory to register weak reference.
+ * @note Unlike registration through a retained reference, owner may be
+ * in the middle of being destroyed and holding its lock until the borrow
+ * ends; this is detected instead of waiting for the lock.
+ */
+int triggerfish_weak_owner_register_borrowed(
+        const struct triggerfish_weak_owner *owner,
+        struct triggerfish_weak *weak);
+
+/**
+ * @brief Unregister weak reference for invalidation when owner is destroyed.
+ * @param [in] owner strong reference or region.
+ * @param [in] weak reference that will be invalidated.
+ * @return <i>true</i> if weak reference was unregistered, otherwise
+ * <i>false</i> if owner is being destroyed and will invalidate it.
+ * @note The caller must have added a borrow to weak before it loaded owner
+ * from it, so that owner outlives the call.
+ */
+bool triggerfish_weak_owner_unregister(
+        const struct triggerfish_weak_owner *owner,
+        const struct triggerfish_weak *weak);
+
+/**
+ * @brief Invalidate every weak reference registered with owner.
+ * @param [in] owner strong reference or region whose count dropped to zero.
+ * @note Reference queue entries are pushed before the weak references are
+ * cleared so that a concurrent destroy of a weak reference never observes
+ * an entry that was already pushed. Returns once every borrow that was
+ * started before the invalidation has ended, so that the instances outlive
+ * them. Weak references whose destroy ran meanwhile are freed.
+ */
+void triggerfish_weak_owner_invalidate(
+        const struct triggerfish_weak_owner *owner);
+
 #endif /* _TRIGGERFISH_PRIVATE_WEAK_H_ */
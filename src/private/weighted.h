@@ -0,0 +1,25 @@
+#ifndef _TRIGGERFISH_PRIVATE_WEIGHTED_H_
+#define _TRIGGERFISH_PRIVATE_WEIGHTED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+/* weight handed out whenever weight is created, a power of two */
+#define TRIGGERFISH_WEIGHTED_WEIGHT     ((triggerfish_counter_t) 1 << 16)
+
+struct triggerfish_strong;
+struct triggerfish_weighted_block {
+    /* sum of the weights of every weighted reference */
+    TRIGGERFISH_ATOMIC(triggerfish_counter_t) weight;
+    struct triggerfish_strong *strong;
+};
+
+struct triggerfish_weighted {
+    struct triggerfish_weighted_block *block;
+    triggerfish_counter_t weight;
+};
+
+#endif /* _TRIGGERFISH_PRIVATE_WEIGHTED_H_ */
@@ -0,0 +1,137 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <errno.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/reference_queue.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+int triggerfish_reference_queue_of(
+        struct triggerfish_reference_queue **const out) {
+    if (!out) {
+        return TRIGGERFISH_REFERENCE_QUEUE_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_reference_queue *object = calloc(1, sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_REFERENCE_QUEUE_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    switch (triggerfish_mutex_init(&object->lock)) {
+        default: {
+            seagrass_required_true(false);
+        }
+        case ENOMEM: {
+            free(object);
+            return TRIGGERFISH_REFERENCE_QUEUE_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+        case 0: {
+            break;
+        }
+    }
+    atomic_init(&object->pushed, NULL);
+    *out = object;
+    return 0;
+}
+
+static void free_entries(struct triggerfish_reference_queue_entry *entry) {
+    while (entry) {
+        struct triggerfish_reference_queue_entry *const next = entry->next;
+        free(entry);
+        entry = next;
+    }
+}
+
+int triggerfish_reference_queue_destroy(
+        struct triggerfish_reference_queue *const object) {
+    if (!object) {
+        return TRIGGERFISH_REFERENCE_QUEUE_ERROR_OBJECT_IS_NULL;
+    }
+    free_entries(atomic_load(&object->pushed));
+    free_entries(object->first);
+    seagrass_required_true(!triggerfish_mutex_destroy(&object->lock));
+    free(object);
+    return 0;
+}
+
+int triggerfish_reference_queue_poll(
+        struct triggerfish_reference_queue *const object,
+        void **const cookies,
+        const uintmax_t count,
+        uintmax_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_REFERENCE_QUEUE_ERROR_OBJECT_IS_NULL;
+    }
+    if (!cookies) {
+        return TRIGGERFISH_REFERENCE_QUEUE_ERROR_COOKIES_IS_NULL;
+    }
+    if (!count) {
+        return TRIGGERFISH_REFERENCE_QUEUE_ERROR_COUNT_IS_ZERO;
+    }
+    if (!out) {
+        return TRIGGERFISH_REFERENCE_QUEUE_ERROR_OUT_IS_NULL;
+    }
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    if (!object->first) {
+        /* take over everything pushed so far and restore the push order */
+        struct triggerfish_reference_queue_entry *entry = atomic_exchange(
+                &object->pushed, NULL);
+        while (entry) {
+            struct triggerfish_reference_queue_entry *const next = entry->next;
+            entry->next = object->first;
+            object->first = entry;
+            entry = next;
+        }
+    }
+    struct triggerfish_reference_queue_entry *entry = object->first;
+    uintmax_t i = 0;
+    for (; i < count && object->first; i++) {
+        cookies[i] = object->first->cookie;
+        object->first = object->first->next;
+    }
+    const struct triggerfish_reference_queue_entry *const rest = object->first;
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    if (!i) {
+        return TRIGGERFISH_REFERENCE_QUEUE_ERROR_QUEUE_IS_EMPTY;
+    }
+    while (entry != rest) {
+        struct triggerfish_reference_queue_entry *const next = entry->next;
+        free(entry);
+        entry = next;
+    }
+    *out = i;
+    return 0;
+}
+
+int triggerfish_reference_queue_entry_of(
+        struct triggerfish_reference_queue *const object,
+        void *const cookie,
+        struct triggerfish_reference_queue_entry **const out) {
+    assert(object);
+    assert(out);
+    struct triggerfish_reference_queue_entry *entry = calloc(1, sizeof(*entry));
+    if (!entry) {
+        return TRIGGERFISH_REFERENCE_QUEUE_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    entry->queue = object;
+    entry->cookie = cookie;
+    *out = entry;
+    return 0;
+}
+
+void triggerfish_reference_queue_push(
+        struct triggerfish_reference_queue_entry *const entry) {
+    assert(entry);
+    assert(entry->queue);
+    struct triggerfish_reference_queue *const object = entry->queue;
+    struct triggerfish_reference_queue_entry *next = atomic_load_explicit(
+            &object->pushed, memory_order_relaxed);
+    do {
+        entry->next = next;
+    } while (!atomic_compare_exchange_weak_explicit(
+            &object->pushed, &next, entry,
+            memory_order_release, memory_order_relaxed));
+}
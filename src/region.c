@@ -0,0 +1,262 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <assert.h>
+#include <errno.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#ifndef TRIGGERFISH_NO_WEAK
+#include "private/weak.h"
+#endif
+#include "private/region.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+#ifndef TRIGGERFISH_NO_WEAK
+static struct triggerfish_weak_owner owner_of(
+        struct triggerfish_region *const object) {
+    return (struct triggerfish_weak_owner) {
+#ifndef TRIGGERFISH_SINGLE_THREADED
+            .lock = &object->lock,
+#endif
+            .counter = &object->counter,
+            .weak_refs = &object->weak_refs
+    };
+}
+#endif
+
+int triggerfish_region_of(struct triggerfish_region **const out) {
+    if (!out) {
+        return TRIGGERFISH_REGION_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_region *object = calloc(1, sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_REGION_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    switch (triggerfish_mutex_init(&object->lock)) {
+        default: {
+            seagrass_required_true(false);
+        }
+        case ENOMEM: {
+            free(object);
+            return TRIGGERFISH_REGION_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+        case 0: {
+            break;
+        }
+    }
+#ifndef TRIGGERFISH_NO_WEAK
+    seagrass_required_true(!coral_red_black_tree_container_init(
+            &object->weak_refs, triggerfish_weak_owner_compare));
+#endif
+    triggerfish_atomic_store(&object->counter, 1);
+    *out = object;
+    return 0;
+}
+
+int triggerfish_region_count(struct triggerfish_region *const object,
+                             uintmax_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_REGION_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_REGION_ERROR_OUT_IS_NULL;
+    }
+    *out = triggerfish_counter_count(
+            triggerfish_atomic_load(&object->counter));
+    return 0;
+}
+
+int triggerfish_region_retain(struct triggerfish_region *const object) {
+    if (!object) {
+        return TRIGGERFISH_REGION_ERROR_OBJECT_IS_NULL;
+    }
+    triggerfish_counter_t desired;
+    triggerfish_counter_t expected = triggerfish_atomic_load(&object->counter);
+    do {
+        if (!expected) {
+            return TRIGGERFISH_REGION_ERROR_OBJECT_IS_INVALID;
+        }
+        seagrass_required_true(TRIGGERFISH_COUNTER_WAITING - 1
+                               != triggerfish_counter_count(expected));
+        desired = expected + 1;
+    } while (!triggerfish_atomic_compare_exchange(&object->counter,
+                                                  &expected, desired));
+    return 0;
+}
+
+static void destroy(struct triggerfish_region *const object) {
+    assert(object);
+#ifndef TRIGGERFISH_NO_WEAK
+    const struct triggerfish_weak_owner owner = owner_of(object);
+    triggerfish_weak_owner_invalidate(&owner);
+#endif
+    seagrass_required_true(!triggerfish_mutex_destroy(&object->lock));
+#ifndef TRIGGERFISH_NO_WEAK
+    seagrass_required_true(!coral_red_black_tree_container_invalidate(
+            &object->weak_refs, NULL));
+#endif
+    for (struct triggerfish_region_entry *entry = object->entries;
+         entry; entry = entry->next) {
+        entry->strong.on_destroy(entry->strong.instance);
+    }
+    for (struct triggerfish_region_chunk *chunk = object->chunks, *next;
+         chunk; chunk = next) {
+        next = chunk->next;
+        free(chunk);
+    }
+    free(object);
+}
+
+int triggerfish_region_release(struct triggerfish_region *const object) {
+    if (!object) {
+        return TRIGGERFISH_REGION_ERROR_OBJECT_IS_NULL;
+    }
+    triggerfish_counter_t desired;
+    triggerfish_counter_t expected = triggerfish_atomic_load(&object->counter);
+    do {
+        seagrass_required_true(triggerfish_counter_count(expected));
+        /* waiting threads set the flag again if they have to keep waiting */
+        desired = (expected - 1) & ~TRIGGERFISH_COUNTER_WAITING;
+    } while (!triggerfish_atomic_compare_exchange(&object->counter,
+                                                  &expected, desired));
+    if (expected & TRIGGERFISH_COUNTER_WAITING) {
+        triggerfish_counter_wake(&object->counter);
+    }
+    if (desired) {
+        return 0;
+    }
+    destroy(object);
+    return 0;
+}
+
+bool triggerfish_region_release_unique(
+        struct triggerfish_region *const object,
+        const struct timespec *const deadline) {
+    assert(object);
+    if (!triggerfish_counter_release_unique(&object->counter, deadline)) {
+        return false;
+    }
+    destroy(object);
+    return true;
+}
+
+static size_t align(const size_t size) {
+    const size_t alignment = alignof(max_align_t);
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+static int alloc(struct triggerfish_region *const object,
+                 const size_t size,
+                 void **const out) {
+    assert(object);
+    assert(size);
+    assert(out);
+    struct triggerfish_region_chunk *chunk = object->chunks;
+    if (chunk && chunk->size - chunk->used >= size) {
+        *out = (unsigned char *) chunk->data + chunk->used;
+        chunk->used += size;
+        return 0;
+    }
+    const size_t capacity = size > TRIGGERFISH_REGION_CHUNK_SIZE
+                            ? size
+                            : TRIGGERFISH_REGION_CHUNK_SIZE;
+    if (capacity > SIZE_MAX - sizeof(*chunk)
+        || !(chunk = malloc(sizeof(*chunk) + capacity))) {
+        return TRIGGERFISH_REGION_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    chunk->size = capacity;
+    chunk->used = size;
+    if (capacity == size && object->chunks) {
+        /* oversized allocation, keep bumping from the current chunk */
+        chunk->next = object->chunks->next;
+        object->chunks->next = chunk;
+    } else {
+        chunk->next = object->chunks;
+        object->chunks = chunk;
+    }
+    *out = chunk->data;
+    return 0;
+}
+
+int triggerfish_region_strong_of(struct triggerfish_region *const object,
+                                 const size_t size,
+                                 void (*const on_destroy)(void *instance),
+                                 struct triggerfish_strong **const out) {
+    if (!object) {
+        return TRIGGERFISH_REGION_ERROR_OBJECT_IS_NULL;
+    }
+    if (!size) {
+        return TRIGGERFISH_REGION_ERROR_SIZE_IS_ZERO;
+    }
+    if (!out) {
+        return TRIGGERFISH_REGION_ERROR_OUT_IS_NULL;
+    }
+    const size_t header = align(sizeof(struct triggerfish_region_entry));
+    if (size > SIZE_MAX - header - alignof(max_align_t)) {
+        return TRIGGERFISH_REGION_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    int error;
+    if ((error = triggerfish_mutex_lock(&object->lock))) {
+        seagrass_required_true(EINVAL == error);
+        return TRIGGERFISH_REGION_ERROR_OBJECT_IS_INVALID;
+    }
+    if (!triggerfish_atomic_load(&object->counter)) {
+        seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+        return TRIGGERFISH_REGION_ERROR_OBJECT_IS_INVALID;
+    }
+    struct triggerfish_region_entry *entry;
+    if ((error = alloc(object, header + align(size), (void **) &entry))) {
+        seagrass_required_true(
+                TRIGGERFISH_REGION_ERROR_MEMORY_ALLOCATION_FAILED == error);
+    } else {
+        *entry = (struct triggerfish_region_entry) {
+                .strong = {
+                        .instance = (unsigned char *) entry + header,
+                        .region = object,
+                        .on_destroy = on_destroy
+                }
+        };
+        memset(entry->strong.instance, 0, size);
+        if (on_destroy) {
+            entry->next = object->entries;
+            object->entries = entry;
+        }
+        /* the caller's reference keeps the region valid meanwhile */
+        seagrass_required_true(!triggerfish_region_retain(object));
+        *out = &entry->strong;
+    }
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    return error;
+}
+
+#ifndef TRIGGERFISH_NO_WEAK
+int triggerfish_region_register(struct triggerfish_region *const object,
+                                struct triggerfish_weak *const weak) {
+    assert(object);
+    assert(weak);
+    const struct triggerfish_weak_owner owner = owner_of(object);
+    return triggerfish_weak_owner_register(&owner, weak);
+}
+
+int triggerfish_region_register_borrowed(
+        struct triggerfish_region *const object,
+        struct triggerfish_weak *const weak) {
+    assert(object);
+    assert(weak);
+    const struct triggerfish_weak_owner owner = owner_of(object);
+    return triggerfish_weak_owner_register_borrowed(&owner, weak);
+}
+
+bool triggerfish_region_unregister(struct triggerfish_region *const object,
+                                   const struct triggerfish_weak *const weak) {
+    assert(object);
+    assert(weak);
+    const struct triggerfish_weak_owner owner = owner_of(object);
+    return triggerfish_weak_owner_unregister(&owner, weak);
+}
+#endif
@@ -0,0 +1,486 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/shared.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+/* atomics that take a lock would not be shared between processes */
+_Static_assert(2 == ATOMIC_LLONG_LOCK_FREE,
+               "64-bit atomics must be lock-free");
+
+#define RECOVERING      (UINT64_C(1) << 63)
+
+static atomic_uint_least64_t *pids(
+        const struct triggerfish_shared_segment *const segment) {
+    assert(segment);
+    return (void *) ((unsigned char *) segment + segment->pids);
+}
+
+static struct triggerfish_shared_block *blocks(
+        const struct triggerfish_shared_segment *const segment) {
+    assert(segment);
+    return (void *) ((unsigned char *) segment + segment->blocks);
+}
+
+static atomic_uint_least64_t *hold(
+        const struct triggerfish_shared_segment *const segment,
+        const uint64_t process,
+        const uint64_t index) {
+    assert(segment);
+    atomic_uint_least64_t *holds
+            = (void *) ((unsigned char *) segment + segment->holds);
+    return &holds[process * segment->count + index];
+}
+
+/*
+ * Reserve count items of size at the next aligned offset after at.
+ */
+static bool append(uintmax_t *const at,
+                   const uintmax_t count,
+                   const uintmax_t size,
+                   uint64_t *const out) {
+    assert(at);
+    assert(out);
+    const uintmax_t alignment = alignof(max_align_t);
+    uintmax_t length;
+    if (seagrass_uintmax_t_add(*at, alignment - 1, at)
+        || seagrass_uintmax_t_multiply(count, size, &length)) {
+        return false;
+    }
+    *at -= *at % alignment;
+    *out = *at;
+    return !seagrass_uintmax_t_add(*at, length, at);
+}
+
+static bool layout(const size_t size,
+                   const uintmax_t count,
+                   const uintmax_t processes,
+                   struct triggerfish_shared_segment *const out) {
+    assert(size);
+    assert(count);
+    assert(processes);
+    assert(out);
+    const uintmax_t alignment = alignof(max_align_t);
+    uintmax_t stride;
+    uintmax_t holds;
+    uintmax_t at = sizeof(*out);
+    /* block indexes share the free list head with a tag */
+    if (count >= TRIGGERFISH_SHARED_INDEX_MASK
+        || seagrass_uintmax_t_add(size, alignment - 1, &stride)
+        || seagrass_uintmax_t_multiply(count, processes, &holds)
+        || !append(&at, processes, sizeof(atomic_uint_least64_t), &out->pids)
+        || !append(&at, count, sizeof(struct triggerfish_shared_block),
+                   &out->blocks)
+        || !append(&at, holds, sizeof(atomic_uint_least64_t), &out->holds)
+        || !append(&at, count, stride - stride % alignment, &out->data)
+        || at > PTRDIFF_MAX) {
+        return false;
+    }
+    out->size = at;
+    out->stride = stride - stride % alignment;
+    out->count = count;
+    out->processes = processes;
+    return true;
+}
+
+static int error_of(const int error) {
+    switch (error) {
+        case EACCES:
+        case EINVAL:
+        case ENAMETOOLONG: {
+            return TRIGGERFISH_SHARED_ERROR_NAME_IS_INVALID;
+        }
+        case EEXIST: {
+            return TRIGGERFISH_SHARED_ERROR_NAME_ALREADY_EXISTS;
+        }
+        case ENOENT: {
+            return TRIGGERFISH_SHARED_ERROR_SEGMENT_NOT_FOUND;
+        }
+        default: {
+            return TRIGGERFISH_SHARED_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+    }
+}
+
+static bool claim(struct triggerfish_shared_segment *const segment,
+                  uint64_t *const out) {
+    assert(segment);
+    assert(out);
+    atomic_uint_least64_t *const slots = pids(segment);
+    const uint_least64_t pid = (uint_least64_t) getpid();
+    for (uint64_t i = 0; i < segment->processes; i++) {
+        uint_least64_t expected = 0;
+        if (atomic_compare_exchange_strong(&slots[i], &expected, pid)) {
+            *out = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Lock-free stack of free blocks whose head carries a tag that changes on
+ * every update so that a concurrent pop and push cannot mistake one head
+ * for another (ABA).
+ */
+static bool pop(struct triggerfish_shared_segment *const segment,
+                uint64_t *const out) {
+    assert(segment);
+    assert(out);
+    struct triggerfish_shared_block *const block = blocks(segment);
+    uint_least64_t desired;
+    uint_least64_t head = atomic_load_explicit(&segment->free,
+                                               memory_order_acquire);
+    do {
+        const uint64_t first = head & TRIGGERFISH_SHARED_INDEX_MASK;
+        if (!first) {
+            return false;
+        }
+        desired = (((head >> 32) + 1) << 32) | atomic_load_explicit(
+                &block[first - 1].next, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&segment->free,
+                                                    &head, desired,
+                                                    memory_order_acquire,
+                                                    memory_order_acquire));
+    *out = (head & TRIGGERFISH_SHARED_INDEX_MASK) - 1;
+    return true;
+}
+
+static void push(struct triggerfish_shared_segment *const segment,
+                 const uint64_t index) {
+    assert(segment);
+    assert(index < segment->count);
+    struct triggerfish_shared_block *const block = blocks(segment);
+    uint_least64_t desired;
+    uint_least64_t head = atomic_load_explicit(&segment->free,
+                                               memory_order_relaxed);
+    do {
+        atomic_store_explicit(&block[index].next,
+                              head & TRIGGERFISH_SHARED_INDEX_MASK,
+                              memory_order_relaxed);
+        desired = (((head >> 32) + 1) << 32) | (index + 1);
+    } while (!atomic_compare_exchange_weak_explicit(&segment->free,
+                                                    &head, desired,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+/*
+ * Drop every reference held by process, freeing the blocks for which they
+ * were the last ones.
+ */
+static void reclaim(struct triggerfish_shared_segment *const segment,
+                    const uint64_t process) {
+    assert(segment);
+    assert(process < segment->processes);
+    struct triggerfish_shared_block *const block = blocks(segment);
+    for (uint64_t i = 0; i < segment->count; i++) {
+        const uint_least64_t held = atomic_exchange(
+                hold(segment, process, i), 0);
+        if (held && held == atomic_fetch_sub(&block[i].counter, held)) {
+            push(segment, i);
+        }
+    }
+}
+
+static bool locate(const struct triggerfish_shared_segment *const segment,
+                   uintmax_t offset,
+                   uint64_t *const out) {
+    assert(segment);
+    assert(out);
+    if (offset < segment->data) {
+        return false;
+    }
+    offset -= segment->data;
+    if (offset % segment->stride || offset / segment->stride
+                                    >= segment->count) {
+        return false;
+    }
+    *out = offset / segment->stride;
+    return true;
+}
+
+int triggerfish_shared_of(const char *const name,
+                          const size_t size,
+                          const uintmax_t count,
+                          const uintmax_t processes,
+                          struct triggerfish_shared **const out) {
+    if (!name) {
+        return TRIGGERFISH_SHARED_ERROR_NAME_IS_NULL;
+    }
+    if (!size) {
+        return TRIGGERFISH_SHARED_ERROR_SIZE_IS_ZERO;
+    }
+    if (!count) {
+        return TRIGGERFISH_SHARED_ERROR_COUNT_IS_ZERO;
+    }
+    if (!processes) {
+        return TRIGGERFISH_SHARED_ERROR_PROCESSES_IS_ZERO;
+    }
+    if (!out) {
+        return TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_shared_segment shape = {0};
+    if (!layout(size, count, processes, &shape)) {
+        return TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_TOO_LARGE;
+    }
+    struct triggerfish_shared *object = malloc(sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_SHARED_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (-1 == fd) {
+        free(object);
+        return error_of(errno);
+    }
+    /* a freshly sized shared memory object reads as zeros */
+    struct triggerfish_shared_segment *segment = MAP_FAILED;
+    if (!ftruncate(fd, (off_t) shape.size)) {
+        segment = mmap(NULL, shape.size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       fd, 0);
+    }
+    seagrass_required_true(!close(fd));
+    if (MAP_FAILED == segment) {
+        seagrass_required_true(!shm_unlink(name));
+        free(object);
+        return TRIGGERFISH_SHARED_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    segment->size = shape.size;
+    segment->stride = shape.stride;
+    segment->count = shape.count;
+    segment->processes = shape.processes;
+    segment->pids = shape.pids;
+    segment->blocks = shape.blocks;
+    segment->holds = shape.holds;
+    segment->data = shape.data;
+    struct triggerfish_shared_block *const block = blocks(segment);
+    for (uint64_t i = 0; i < segment->count; i++) {
+        atomic_init(&block[i].next, i + 1 < segment->count ? i + 2 : 0);
+    }
+    atomic_init(&segment->free, 1);
+    seagrass_required_true(claim(segment, &object->process));
+    object->segment = segment;
+    /* publish the layout to processes opening the segment */
+    atomic_store_explicit(&segment->magic, TRIGGERFISH_SHARED_MAGIC,
+                          memory_order_release);
+    *out = object;
+    return 0;
+}
+
+int triggerfish_shared_open(const char *const name,
+                            struct triggerfish_shared **const out) {
+    if (!name) {
+        return TRIGGERFISH_SHARED_ERROR_NAME_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_shared *object = malloc(sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_SHARED_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    const int fd = shm_open(name, O_RDWR, 0);
+    if (-1 == fd) {
+        free(object);
+        return error_of(errno);
+    }
+    struct stat stat;
+    seagrass_required_true(!fstat(fd, &stat));
+    if (stat.st_size < (off_t) sizeof(struct triggerfish_shared_segment)) {
+        seagrass_required_true(!close(fd));
+        free(object);
+        return TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_INVALID;
+    }
+    struct triggerfish_shared_segment *segment = mmap(
+            NULL, (size_t) stat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+            fd, 0);
+    seagrass_required_true(!close(fd));
+    if (MAP_FAILED == segment) {
+        free(object);
+        return TRIGGERFISH_SHARED_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    int error = 0;
+    if (TRIGGERFISH_SHARED_MAGIC != atomic_load_explicit(
+            &segment->magic, memory_order_acquire)
+        || segment->size != (uint64_t) stat.st_size) {
+        error = TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_INVALID;
+    } else if (!claim(segment, &object->process)) {
+        error = TRIGGERFISH_SHARED_ERROR_PROCESSES_ARE_FULL;
+    }
+    if (error) {
+        seagrass_required_true(!munmap(segment, (size_t) stat.st_size));
+        free(object);
+        return error;
+    }
+    object->segment = segment;
+    *out = object;
+    return 0;
+}
+
+int triggerfish_shared_close(struct triggerfish_shared *const object) {
+    if (!object) {
+        return TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL;
+    }
+    struct triggerfish_shared_segment *const segment = object->segment;
+    reclaim(segment, object->process);
+    atomic_store(&pids(segment)[object->process], 0);
+    seagrass_required_true(!munmap(segment, segment->size));
+    free(object);
+    return 0;
+}
+
+int triggerfish_shared_unlink(const char *const name) {
+    if (!name) {
+        return TRIGGERFISH_SHARED_ERROR_NAME_IS_NULL;
+    }
+    return shm_unlink(name) ? error_of(errno) : 0;
+}
+
+int triggerfish_shared_alloc(struct triggerfish_shared *const object,
+                             uintmax_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_shared_segment *const segment = object->segment;
+    uint64_t index;
+    if (!pop(segment, &index)) {
+        return TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_FULL;
+    }
+    const uint64_t offset = segment->data + index * segment->stride;
+    memset((unsigned char *) segment + offset, 0, segment->stride);
+    atomic_store(&blocks(segment)[index].counter, 1);
+    atomic_fetch_add(hold(segment, object->process, index), 1);
+    *out = offset;
+    return 0;
+}
+
+int triggerfish_shared_at(const struct triggerfish_shared *const object,
+                          const uintmax_t offset,
+                          void **const out) {
+    if (!object) {
+        return TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL;
+    }
+    uint64_t index;
+    if (!locate(object->segment, offset, &index)) {
+        return TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID;
+    }
+    if (!out) {
+        return TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL;
+    }
+    *out = (unsigned char *) object->segment + offset;
+    return 0;
+}
+
+int triggerfish_shared_count(const struct triggerfish_shared *const object,
+                             const uintmax_t offset,
+                             uintmax_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL;
+    }
+    uint64_t index;
+    if (!locate(object->segment, offset, &index)) {
+        return TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID;
+    }
+    if (!out) {
+        return TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL;
+    }
+    *out = atomic_load(&blocks(object->segment)[index].counter);
+    return 0;
+}
+
+int triggerfish_shared_retain(struct triggerfish_shared *const object,
+                              const uintmax_t offset) {
+    if (!object) {
+        return TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL;
+    }
+    struct triggerfish_shared_segment *const segment = object->segment;
+    uint64_t index;
+    if (!locate(segment, offset, &index)) {
+        return TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID;
+    }
+    struct triggerfish_shared_block *const block = &blocks(segment)[index];
+    uint_least64_t expected = atomic_load(&block->counter);
+    do {
+        if (!expected) {
+            return TRIGGERFISH_SHARED_ERROR_BLOCK_IS_INVALID;
+        }
+        seagrass_required_true(UINT_LEAST64_MAX != expected);
+    } while (!atomic_compare_exchange_strong(&block->counter,
+                                             &expected, expected + 1));
+    /*
+     * Dying in between leaves the count one too high, which leaks the block
+     * rather than freeing it while in use.
+     */
+    atomic_fetch_add(hold(segment, object->process, index), 1);
+    return 0;
+}
+
+int triggerfish_shared_release(struct triggerfish_shared *const object,
+                               const uintmax_t offset) {
+    if (!object) {
+        return TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL;
+    }
+    struct triggerfish_shared_segment *const segment = object->segment;
+    uint64_t index;
+    if (!locate(segment, offset, &index)) {
+        return TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID;
+    }
+    atomic_uint_least64_t *const held = hold(segment, object->process, index);
+    uint_least64_t expected = atomic_load(held);
+    do {
+        if (!expected) {
+            return TRIGGERFISH_SHARED_ERROR_BLOCK_IS_NOT_HELD;
+        }
+    } while (!atomic_compare_exchange_strong(held, &expected, expected - 1));
+    if (1 == atomic_fetch_sub(&blocks(segment)[index].counter, 1)) {
+        push(segment, index);
+    }
+    return 0;
+}
+
+int triggerfish_shared_recover(struct triggerfish_shared *const object,
+                               uintmax_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_shared_segment *const segment = object->segment;
+    atomic_uint_least64_t *const slots = pids(segment);
+    uintmax_t count = 0;
+    for (uint64_t i = 0; i < segment->processes; i++) {
+        uint_least64_t pid = atomic_load(&slots[i]);
+        if (!pid || pid & RECOVERING || i == object->process
+            || !kill((pid_t) pid, 0) || ESRCH != errno) {
+            continue;
+        }
+        /* only one process may reclaim the references of a dead one */
+        if (!atomic_compare_exchange_strong(&slots[i], &pid,
+                                            pid | RECOVERING)) {
+            continue;
+        }
+        reclaim(segment, i);
+        atomic_store(&slots[i], 0);
+        count += 1;
+    }
+    *out = count;
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/soft.h"
+#include "private/soft_cache.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+int triggerfish_soft_of(struct triggerfish_soft_cache *const cache,
+                        struct triggerfish_strong *const strong,
+                        const size_t size,
+                        struct triggerfish_soft **const out) {
+    if (!cache) {
+        return TRIGGERFISH_SOFT_ERROR_CACHE_IS_NULL;
+    }
+    if (!strong) {
+        return TRIGGERFISH_SOFT_ERROR_STRONG_IS_NULL;
+    }
+    if (!size) {
+        return TRIGGERFISH_SOFT_ERROR_SIZE_IS_ZERO;
+    }
+    if (!out) {
+        return TRIGGERFISH_SOFT_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_soft *object = calloc(1, sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_SOFT_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    int error;
+    if ((error = triggerfish_weak_of(strong, &object->weak))) {
+        free(object);
+        switch (error) {
+            default: {
+                seagrass_required_true(false);
+            }
+            case TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID: {
+                return TRIGGERFISH_SOFT_ERROR_STRONG_IS_INVALID;
+            }
+            case TRIGGERFISH_WEAK_ERROR_MEMORY_ALLOCATION_FAILED: {
+                return TRIGGERFISH_SOFT_ERROR_MEMORY_ALLOCATION_FAILED;
+            }
+        }
+    }
+    if ((error = triggerfish_strong_retain(strong))) {
+        seagrass_required_true(TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID
+                               == error);
+        seagrass_required_true(!triggerfish_weak_destroy(object->weak));
+        free(object);
+        return TRIGGERFISH_SOFT_ERROR_STRONG_IS_INVALID;
+    }
+    object->cache = cache;
+    object->strong = strong;
+    object->size = size;
+    triggerfish_soft_cache_insert(cache, object);
+    *out = object;
+    return 0;
+}
+
+int triggerfish_soft_destroy(struct triggerfish_soft *const object) {
+    if (!object) {
+        return TRIGGERFISH_SOFT_ERROR_OBJECT_IS_NULL;
+    }
+    struct triggerfish_strong *const strong
+            = triggerfish_soft_cache_remove(object->cache, object);
+    if (strong) {
+        seagrass_required_true(!triggerfish_strong_release(strong));
+    }
+    seagrass_required_true(!triggerfish_weak_destroy(object->weak));
+    free(object);
+    return 0;
+}
+
+int triggerfish_soft_is_cleared(struct triggerfish_soft *const object,
+                                bool *const out) {
+    if (!object) {
+        return TRIGGERFISH_SOFT_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_SOFT_ERROR_OUT_IS_NULL;
+    }
+    *out = !triggerfish_soft_cache_holds(object->cache, object);
+    return 0;
+}
+
+int triggerfish_soft_strong(struct triggerfish_soft *const object,
+                            struct triggerfish_strong **const out) {
+    if (!object) {
+        return TRIGGERFISH_SOFT_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_SOFT_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_strong *const strong
+            = triggerfish_soft_cache_touch(object->cache, object);
+    if (strong) {
+        *out = strong;
+        return 0;
+    }
+    /* once cleared only others may still be keeping the instance alive */
+    const int error = triggerfish_weak_strong(object->weak, out);
+    if (error) {
+        seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
+                               == error);
+        return TRIGGERFISH_SOFT_ERROR_STRONG_IS_INVALID;
+    }
+    return 0;
+}
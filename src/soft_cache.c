@@ -0,0 +1,291 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/soft.h"
+#include "private/soft_cache.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+int triggerfish_soft_cache_of(const size_t budget,
+                              struct triggerfish_soft_cache **const out) {
+    if (!out) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_soft_cache *object = calloc(1, sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    switch (triggerfish_mutex_init(&object->lock)) {
+        default: {
+            seagrass_required_true(false);
+        }
+        case ENOMEM: {
+            free(object);
+            return TRIGGERFISH_SOFT_CACHE_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+        case 0: {
+            break;
+        }
+    }
+    object->budget = budget;
+    *out = object;
+    return 0;
+}
+
+int triggerfish_soft_cache_destroy(
+        struct triggerfish_soft_cache *const object) {
+    if (!object) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL;
+    }
+    seagrass_required_true(!object->hand);
+    seagrass_required_true(!triggerfish_mutex_destroy(&object->lock));
+    free(object);
+    return 0;
+}
+
+int triggerfish_soft_cache_budget(struct triggerfish_soft_cache *const object,
+                                  size_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_OUT_IS_NULL;
+    }
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    *out = object->budget;
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    return 0;
+}
+
+int triggerfish_soft_cache_usage(struct triggerfish_soft_cache *const object,
+                                 size_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_OUT_IS_NULL;
+    }
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    *out = object->usage;
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    return 0;
+}
+
+static void detach(struct triggerfish_soft_cache *const object,
+                   struct triggerfish_soft *const soft) {
+    assert(object);
+    assert(soft);
+    if (soft->next == soft) {
+        object->hand = NULL;
+    } else {
+        soft->previous->next = soft->next;
+        soft->next->previous = soft->previous;
+        if (object->hand == soft) {
+            object->hand = soft->next;
+        }
+    }
+    soft->next = NULL;
+    soft->previous = NULL;
+    object->usage -= soft->size;
+}
+
+/*
+ * Advance the clock hand until a soft reference that was not used since the
+ * hand last passed it is found and clear it.
+ */
+static struct triggerfish_strong *evict(
+        struct triggerfish_soft_cache *const object,
+        const size_t usage) {
+    assert(object);
+    while (object->usage > usage) {
+        struct triggerfish_soft *const soft = object->hand;
+        assert(soft);
+        if (soft->referenced) {
+            soft->referenced = false;
+            object->hand = soft->next;
+            continue;
+        }
+        detach(object, soft);
+        struct triggerfish_strong *const strong = soft->strong;
+        soft->strong = NULL;
+        return strong;
+    }
+    return NULL;
+}
+
+/*
+ * Release one strong reference at a time without holding the lock as the
+ * instance's on_destroy may well destroy soft references of its own.
+ */
+static void shrink(struct triggerfish_soft_cache *const object,
+                   const size_t usage) {
+    assert(object);
+    for (;;) {
+        seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+        struct triggerfish_strong *const strong = evict(object, usage);
+        seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+        if (!strong) {
+            return;
+        }
+        seagrass_required_true(!triggerfish_strong_release(strong));
+    }
+}
+
+int triggerfish_soft_cache_set_budget(
+        struct triggerfish_soft_cache *const object,
+        const size_t budget) {
+    if (!object) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL;
+    }
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    object->budget = budget;
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    shrink(object, budget);
+    return 0;
+}
+
+int triggerfish_soft_cache_shrink(struct triggerfish_soft_cache *const object,
+                                  const size_t usage) {
+    if (!object) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL;
+    }
+    shrink(object, usage);
+    return 0;
+}
+
+/*
+ * Sum up what only ever grows under pressure, the total stall time of a
+ * pressure stall information file or the high, max and oom events of a
+ * cgroup memory.events file.
+ */
+static bool pressure_of(FILE *const file, uintmax_t *const out) {
+    assert(file);
+    assert(out);
+    bool found = false;
+    uintmax_t total = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        char key[16];
+        uintmax_t value;
+        const char *at;
+        if (!strncmp(line, "some ", 5)) {
+            if ((at = strstr(line, "total="))
+                && 1 == sscanf(at, "total=%ju", &value)) {
+                total += value;
+                found = true;
+            }
+        } else if (2 == sscanf(line, "%15s %ju", key, &value)
+                   && (!strcmp(key, "high") || !strcmp(key, "max")
+                       || !strcmp(key, "oom"))) {
+            total += value;
+            found = true;
+        }
+    }
+    *out = total;
+    return found;
+}
+
+int triggerfish_soft_cache_poll(struct triggerfish_soft_cache *const object,
+                                const char *const path,
+                                bool *const out) {
+    if (!object) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL;
+    }
+    if (!path) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_PATH_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_OUT_IS_NULL;
+    }
+    FILE *const file = fopen(path, "r");
+    if (!file) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_PATH_IS_INVALID;
+    }
+    uintmax_t pressure;
+    const bool found = pressure_of(file, &pressure);
+    seagrass_required_true(!fclose(file));
+    if (!found) {
+        return TRIGGERFISH_SOFT_CACHE_ERROR_PATH_IS_INVALID;
+    }
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    *out = object->polled && pressure != object->pressure;
+    object->polled = true;
+    object->pressure = pressure;
+    const size_t usage = object->usage / 2;
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    if (*out) {
+        shrink(object, usage);
+    }
+    return 0;
+}
+
+void triggerfish_soft_cache_insert(struct triggerfish_soft_cache *const object,
+                                   struct triggerfish_soft *const soft) {
+    assert(object);
+    assert(soft);
+    assert(soft->strong);
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    seagrass_required_true(SIZE_MAX - object->usage >= soft->size);
+    /* right behind the hand so that it is the last one to be swept */
+    if (object->hand) {
+        soft->next = object->hand;
+        soft->previous = object->hand->previous;
+        soft->previous->next = soft;
+        soft->next->previous = soft;
+    } else {
+        soft->next = soft;
+        soft->previous = soft;
+        object->hand = soft;
+    }
+    object->usage += soft->size;
+    const size_t budget = object->budget;
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    shrink(object, budget);
+}
+
+struct triggerfish_strong *triggerfish_soft_cache_remove(
+        struct triggerfish_soft_cache *const object,
+        struct triggerfish_soft *const soft) {
+    assert(object);
+    assert(soft);
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    struct triggerfish_strong *const strong = soft->strong;
+    if (strong) {
+        detach(object, soft);
+        soft->strong = NULL;
+    }
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    return strong;
+}
+
+struct triggerfish_strong *triggerfish_soft_cache_touch(
+        struct triggerfish_soft_cache *const object,
+        struct triggerfish_soft *const soft) {
+    assert(object);
+    assert(soft);
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    struct triggerfish_strong *const strong = soft->strong;
+    if (strong) {
+        soft->referenced = true;
+        seagrass_required_true(!triggerfish_strong_retain(strong));
+    }
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    return strong;
+}
+
+bool triggerfish_soft_cache_holds(struct triggerfish_soft_cache *const object,
+                                  const struct triggerfish_soft *const soft) {
+    assert(object);
+    assert(soft);
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    const bool result = soft->strong;
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    return result;
+}
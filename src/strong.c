@@ -1,21 +1,67 @@
 #include <stdlib.h>
-#include <stdatomic.h>
 #include <assert.h>
 #include <errno.h>
 #include <seagrass.h>
 #include <triggerfish.h>
 
 #include "private/strong.h"
+#ifndef TRIGGERFISH_NO_WEAK
 #include "private/weak.h"
+#endif
+#include "private/region.h"
+#include "private/heap.h"
+#include "private/pool.h"
+#include "private/teardown.h"
 
 #ifdef TEST
 #include <test/cmocka.h>
 #endif
 
-static int compare(const void *a, const void *b) {
-    struct triggerfish_weak **A = (void *) a;
-    struct triggerfish_weak **B = (void *) b;
-    return seagrass_void_ptr_compare(*A, *B);
+#ifndef TRIGGERFISH_NO_WEAK
+static struct triggerfish_weak_owner owner_of(
+        struct triggerfish_strong *const object) {
+    return (struct triggerfish_weak_owner) {
+#ifndef TRIGGERFISH_SINGLE_THREADED
+            .lock = &object->lock,
+#endif
+            .counter = &object->counter,
+            .weak_refs = &object->weak_refs
+    };
+}
+#endif
+
+static void ignore(void *instance) {
+    (void) instance;
+}
+
+int triggerfish_strong_init(struct triggerfish_strong *const object,
+                            void *const instance,
+                            void (*const on_destroy)(void *instance)) {
+    assert(object);
+    assert(instance);
+    assert(on_destroy);
+#ifndef TRIGGERFISH_NO_WEAK
+    switch (triggerfish_mutex_init(&object->lock)) {
+        default: {
+            seagrass_required_true(false);
+        }
+        case ENOMEM: {
+            return TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+        case 0: {
+            break;
+        }
+    }
+    seagrass_required_true(!coral_red_black_tree_container_init(
+            &object->weak_refs, triggerfish_weak_owner_compare));
+#endif
+    object->instance = instance;
+    object->on_destroy = on_destroy;
+    triggerfish_atomic_store(&object->counter, 1);
+#ifdef TRIGGERFISH_HEAP_DUMP
+    triggerfish_heap_track(object);
+#endif
+    return 0;
 }
 
 int triggerfish_strong_of(void *const instance,
@@ -34,27 +80,50 @@ int triggerfish_strong_of(void *const instance,
     if (!object) {
         return TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED;
     }
-    switch (pthread_mutex_init(&object->lock, NULL)) {
-        default: {
-            seagrass_required_true(false);
-        }
-        case ENOMEM: {
-            free(object);
-            return TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED;;
-        }
-        case 0: {
-            break;
-        }
+    int error;
+    if ((error = triggerfish_strong_init(object, instance, on_destroy))) {
+        free(object);
+        return error;
     }
-    seagrass_required_true(!coral_red_black_tree_container_init(
-            &object->weak_refs, compare));
-    object->instance = instance;
-    object->on_destroy = on_destroy;
-    atomic_store(&object->counter, 1);
     *out = object;
     return 0;
 }
 
+int triggerfish_strong_alias_of(struct triggerfish_strong *const object,
+                                void *const instance,
+                                struct triggerfish_strong **const out) {
+    if (!object) {
+        return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL;
+    }
+    if (!instance) {
+        return TRIGGERFISH_STRONG_ERROR_INSTANCE_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_STRONG_ERROR_OUT_IS_NULL;
+    }
+    /* aliases of an alias hold its parent so that chains never form */
+    struct triggerfish_strong *const parent = object->parent
+                                              ? object->parent
+                                              : object;
+    int error;
+    if ((error = triggerfish_strong_retain(parent))) {
+        seagrass_required_true(TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID
+                               == error);
+        return error;
+    }
+    struct triggerfish_strong_alias *alias = malloc(sizeof(*alias));
+    if (!alias) {
+        seagrass_required_true(!triggerfish_strong_release(parent));
+        return TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    *alias = (struct triggerfish_strong_alias) {
+            .instance = instance,
+            .parent = parent
+    };
+    *out = (struct triggerfish_strong *) alias;
+    return 0;
+}
+
 int triggerfish_strong_count(struct triggerfish_strong *const object,
                              uintmax_t *const out) {
     if (!object) {
@@ -63,7 +132,16 @@ int triggerfish_strong_count(struct triggerfish_strong *const object,
     if (!out) {
         return TRIGGERFISH_STRONG_ERROR_OUT_IS_NULL;
     }
-    *out = atomic_load(&object->counter);
+    if (object->parent) {
+        return triggerfish_strong_count(object->parent, out);
+    }
+    if (object->region) {
+        seagrass_required_true(!triggerfish_region_count(
+                object->region, out));
+        return 0;
+    }
+    *out = triggerfish_counter_count(
+            triggerfish_atomic_load(&object->counter));
     return 0;
 }
 
@@ -71,62 +149,135 @@ int triggerfish_strong_retain(struct triggerfish_strong *const object) {
     if (!object) {
         return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL;
     }
-    uintmax_t desired;
-    uintmax_t expected = atomic_load(&object->counter);
+    if (object->parent) {
+        return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_ALIAS;
+    }
+    if (object->region) {
+        return triggerfish_region_retain(object->region);
+    }
+    triggerfish_counter_t desired;
+    triggerfish_counter_t expected = triggerfish_atomic_load(&object->counter);
     do {
         if (!expected) {
             return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID;
         }
-        seagrass_required_true(!seagrass_uintmax_t_add(
-                1, expected, &desired));
-    } while (!atomic_compare_exchange_strong(&object->counter,
-                                             &expected, desired));
+        seagrass_required_true(TRIGGERFISH_COUNTER_WAITING - 1
+                               != triggerfish_counter_count(expected));
+        desired = expected + 1;
+    } while (!triggerfish_atomic_compare_exchange(&object->counter,
+                                                  &expected, desired));
     return 0;
 }
 
+static void destroy(struct triggerfish_strong *const object) {
+    assert(object);
+#ifdef TRIGGERFISH_HEAP_DUMP
+    triggerfish_heap_untrack(object);
+#endif
+#ifndef TRIGGERFISH_NO_WEAK
+    const struct triggerfish_weak_owner owner = owner_of(object);
+    triggerfish_weak_owner_invalidate(&owner);
+    seagrass_required_true(!triggerfish_mutex_destroy(&object->lock));
+    seagrass_required_true(!coral_red_black_tree_container_invalidate(
+            &object->weak_refs, NULL));
+#endif
+    object->on_destroy(object->instance);
+    if (object->pool) {
+        triggerfish_pool_recycle(object->pool, object);
+        return;
+    }
+    triggerfish_teardown_free(object->instance);
+    triggerfish_teardown_free(object);
+}
+
+void triggerfish_strong_destroy(struct triggerfish_strong *const object) {
+    destroy(object);
+}
+
 int triggerfish_strong_release(struct triggerfish_strong *const object) {
     if (!object) {
         return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL;
     }
-    uintmax_t desired;
-    uintmax_t expected = atomic_load(&object->counter);
+    if (object->parent) {
+        /* the alias is the reference it holds to its parent */
+        struct triggerfish_strong *const parent = object->parent;
+        triggerfish_teardown_free(object);
+        return triggerfish_strong_release(parent);
+    }
+    if (object->region) {
+        return triggerfish_region_release(object->region);
+    }
+    triggerfish_counter_t desired;
+    triggerfish_counter_t expected = triggerfish_atomic_load(&object->counter);
     do {
-        seagrass_required_true(!seagrass_uintmax_t_subtract(
-                expected, 1, &desired));
-    } while (!atomic_compare_exchange_strong(&object->counter,
-                                             &expected, desired));
+        seagrass_required_true(triggerfish_counter_count(expected));
+        /* waiting threads set the flag again if they have to keep waiting */
+        desired = (expected - 1) & ~TRIGGERFISH_COUNTER_WAITING;
+    } while (!triggerfish_atomic_compare_exchange(&object->counter,
+                                                  &expected, desired));
+    if (expected & TRIGGERFISH_COUNTER_WAITING) {
+        triggerfish_counter_wake(&object->counter);
+    }
     if (desired) {
         return 0;
     }
-    int error;
-    seagrass_required_true(!pthread_mutex_lock(&object->lock));
-    uintptr_t check = (uintptr_t) object;
-    union {
-        struct coral_red_black_tree_container_entry *entry;
-        struct triggerfish_weak **weak;
-    } ptr;
-    if (!(error = coral_red_black_tree_container_first(
-            &object->weak_refs, &ptr.entry))) {
-        do {
-            seagrass_required_true(atomic_compare_exchange_strong(
-                    &(*ptr.weak)->strong, &check, 0));
-        } while (!(error = coral_red_black_tree_container_next(
-                ptr.entry, &ptr.entry)));
-        seagrass_required_true(
-                CORAL_RED_BLACK_TREE_CONTAINER_ERROR_END_OF_SEQUENCE
-                == error);
-    } else {
-        seagrass_required_true(
-                CORAL_RED_BLACK_TREE_CONTAINER_ERROR_CONTAINER_IS_EMPTY
-                == error);
+    if (!triggerfish_teardown_defer(object)) {
+        destroy(object);
+    }
+    return 0;
+}
+
+int triggerfish_strong_wait_unique(struct triggerfish_strong *const object,
+                                   const struct timespec *const timeout) {
+    if (!object) {
+        return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL;
+    }
+    struct timespec deadline;
+    if (!triggerfish_counter_deadline(timeout, &deadline)) {
+        return TRIGGERFISH_STRONG_ERROR_TIMEOUT_IS_INVALID;
+    }
+    if (object->parent) {
+        return triggerfish_strong_wait_unique(object->parent, timeout);
+    }
+    if (!triggerfish_counter_await_unique(object->region
+                                          ? &object->region->counter
+                                          : &object->counter,
+                                          timeout ? &deadline : NULL)) {
+        return TRIGGERFISH_STRONG_ERROR_TIMED_OUT;
+    }
+    return 0;
+}
+
+int triggerfish_strong_release_wait(struct triggerfish_strong *const object,
+                                    const struct timespec *const timeout) {
+    if (!object) {
+        return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL;
+    }
+    struct timespec deadline;
+    if (!triggerfish_counter_deadline(timeout, &deadline)) {
+        return TRIGGERFISH_STRONG_ERROR_TIMEOUT_IS_INVALID;
+    }
+    if (object->parent) {
+        int error;
+        if (!(error = triggerfish_strong_release_wait(object->parent,
+                                                      timeout))) {
+            triggerfish_teardown_free(object);
+        }
+        return error;
+    }
+    if (object->region) {
+        return triggerfish_region_release_unique(object->region,
+                                                 timeout ? &deadline : NULL)
+               ? 0
+               : TRIGGERFISH_STRONG_ERROR_TIMED_OUT;
+    }
+    if (!triggerfish_counter_release_unique(&object->counter,
+                                            timeout ? &deadline : NULL)) {
+        return TRIGGERFISH_STRONG_ERROR_TIMED_OUT;
+    }
+    if (!triggerfish_teardown_defer(object)) {
+        destroy(object);
     }
-    seagrass_required_true(!pthread_mutex_unlock(&object->lock));
-    seagrass_required_true(!pthread_mutex_destroy(&object->lock));
-    seagrass_required_true(!coral_red_black_tree_container_invalidate(
-            &object->weak_refs, NULL));
-    object->on_destroy(object->instance);
-    free(object->instance);
-    free(object);
     return 0;
 }
 
@@ -138,68 +289,129 @@ int triggerfish_strong_instance(const struct triggerfish_strong *const object,
     if (!out) {
         return TRIGGERFISH_STRONG_ERROR_OUT_IS_NULL;
     }
-    if (!atomic_load(&object->counter)) {
+    /* an alias is valid for as long as its parent is */
+    const struct triggerfish_strong *const parent = object->parent
+                                                    ? object->parent
+                                                    : object;
+    if (!triggerfish_atomic_load(parent->region
+                                 ? &parent->region->counter
+                                 : &parent->counter)) {
         return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID;
     }
     *out = object->instance;
     return 0;
 }
 
-int triggerfish_strong_register(struct triggerfish_strong *const object,
-                                struct triggerfish_weak *weak) {
-    assert(object);
-    assert(weak);
+int triggerfish_strong_is_unique(struct triggerfish_strong *const object,
+                                 bool *const out) {
+    if (!object) {
+        return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_STRONG_ERROR_OUT_IS_NULL;
+    }
+    /* an alias is unique if its reference is the only one on its parent */
+    if (object->parent) {
+        return triggerfish_strong_is_unique(object->parent, out);
+    }
+    if (object->region) {
+        if (!triggerfish_atomic_load(&object->region->counter)) {
+            return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID;
+        }
+        *out = false;
+        return 0;
+    }
+#ifdef TRIGGERFISH_NO_WEAK
+    const triggerfish_counter_t counter = triggerfish_counter_count(
+            triggerfish_atomic_load(&object->counter));
+    if (counter) {
+        *out = 1 == counter;
+    }
+#else
     int error;
-    if ((error = pthread_mutex_lock(&object->lock))) {
+    if ((error = triggerfish_mutex_lock(&object->lock))) {
         seagrass_required_true(EINVAL == error);
         return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID;
     }
-    union {
-        struct coral_red_black_tree_container_entry *entry;
-        struct triggerfish_weak **weak;
-    } ptr;
-    if ((error = coral_red_black_tree_container_alloc(
-            sizeof(struct triggerfish_weak **), &ptr.entry))) {
-        seagrass_required_true(
-                CORAL_RED_BLACK_TREE_CONTAINER_ERROR_MEMORY_ALLOCATION_FAILED
-                == error);
-    } else {
-        *ptr.weak = weak;
-        if ((error = coral_red_black_tree_container_add(
-                &object->weak_refs, ptr.entry))) {
-            seagrass_required_true(
-                    CORAL_RED_BLACK_TREE_CONTAINER_ERROR_ENTRY_ALREADY_EXISTS
-                    == error);
-            seagrass_required_true(!coral_red_black_tree_container_free(
-                    ptr.entry));
-        }
+    const triggerfish_counter_t counter = triggerfish_counter_count(
+            triggerfish_atomic_load(&object->counter));
+    if (counter) {
+        /* without weak references the count can only grow through us */
+        uintmax_t count;
+        seagrass_required_true(!coral_red_black_tree_container_count(
+                &object->weak_refs, &count));
+        *out = 1 == counter && !count;
     }
-    seagrass_required_true(!pthread_mutex_unlock(&object->lock));
-    return error;
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+#endif
+    return counter ? 0 : TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID;
 }
 
-void triggerfish_strong_unregister(struct triggerfish_strong *const object,
-                                   const struct triggerfish_weak *const weak) {
-    assert(object);
-    assert(weak);
+int triggerfish_strong_make_unique(struct triggerfish_strong **const object,
+                                   int (*const clone)(const void *instance,
+                                                      void **out)) {
+    if (!object || !*object) {
+        return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL;
+    }
+    if (!clone) {
+        return TRIGGERFISH_STRONG_ERROR_CLONE_IS_NULL;
+    }
     int error;
-    if ((error = pthread_mutex_lock(&object->lock))) {
-        seagrass_required_true(EINVAL == error);
-        return;
+    bool is_unique;
+    if ((error = triggerfish_strong_is_unique(*object, &is_unique))) {
+        seagrass_required_true(TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID
+                               == error);
+        return error;
+    }
+    if (is_unique) {
+        return 0;
     }
-    union {
-        struct coral_red_black_tree_container_entry *entry;
-        struct triggerfish_weak **weak;
-    } ptr;
-    if ((error = coral_red_black_tree_container_get(
-            &object->weak_refs, &weak, &ptr.entry))) {
+    void *instance;
+    if ((error = clone((*object)->instance, &instance))) {
+        return error;
+    }
+    /* on_destroy is optional for instances allocated in a region, and
+     * aliases do not own their instance */
+    void (*const on_destroy)(void *) = !(*object)->parent
+                                       && (*object)->on_destroy
+                                       ? (*object)->on_destroy
+                                       : ignore;
+    struct triggerfish_strong *copy;
+    if ((error = triggerfish_strong_of(instance, on_destroy, &copy))) {
         seagrass_required_true(
-                CORAL_RED_BLACK_TREE_CONTAINER_ERROR_ENTRY_NOT_FOUND
-                == error);
-    } else {
-        seagrass_required_true(!coral_red_black_tree_container_remove(
-                &object->weak_refs, ptr.entry));
-        seagrass_required_true(!coral_red_black_tree_container_free(ptr.entry));
+                TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED == error);
+        on_destroy(instance);
+        free(instance);
+        return error;
     }
-    seagrass_required_true(!pthread_mutex_unlock(&object->lock));
+    seagrass_required_true(!triggerfish_strong_release(*object));
+    *object = copy;
+    return 0;
 }
+
+#ifndef TRIGGERFISH_NO_WEAK
+int triggerfish_strong_register(struct triggerfish_strong *const object,
+                                struct triggerfish_weak *const weak) {
+    assert(object);
+    assert(weak);
+    const struct triggerfish_weak_owner owner = owner_of(object);
+    return triggerfish_weak_owner_register(&owner, weak);
+}
+
+int triggerfish_strong_register_borrowed(
+        struct triggerfish_strong *const object,
+        struct triggerfish_weak *const weak) {
+    assert(object);
+    assert(weak);
+    const struct triggerfish_weak_owner owner = owner_of(object);
+    return triggerfish_weak_owner_register_borrowed(&owner, weak);
+}
+
+bool triggerfish_strong_unregister(struct triggerfish_strong *const object,
+                                   const struct triggerfish_weak *const weak) {
+    assert(object);
+    assert(weak);
+    const struct triggerfish_weak_owner owner = owner_of(object);
+    return triggerfish_weak_owner_unregister(&owner, weak);
+}
+#endif
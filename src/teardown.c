@@ -0,0 +1,339 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/teardown.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+/* worker of the teardown the calling thread is destroying instances for */
+#ifdef TRIGGERFISH_SINGLE_THREADED
+static struct triggerfish_teardown_worker *current;
+#else
+static _Thread_local struct triggerfish_teardown_worker *current;
+#endif
+
+static bool push(struct triggerfish_teardown_worker *const object,
+                 struct triggerfish_strong *const strong) {
+    assert(object);
+    assert(strong);
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    if (object->bottom - object->top == object->capacity) {
+        struct triggerfish_strong **deque;
+        if (object->capacity > SIZE_MAX / 2 / sizeof(*deque)
+            || !(deque = malloc(2 * object->capacity * sizeof(*deque)))) {
+            seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+            return false;
+        }
+        for (size_t i = object->top; i != object->bottom; i++) {
+            deque[i & (2 * object->capacity - 1)]
+                    = object->deque[i & (object->capacity - 1)];
+        }
+        free(object->deque);
+        object->deque = deque;
+        object->capacity *= 2;
+    }
+    object->deque[object->bottom++ & (object->capacity - 1)] = strong;
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    return true;
+}
+
+/* owner takes the most recently queued strong reference */
+static struct triggerfish_strong *pop(
+        struct triggerfish_teardown_worker *const object) {
+    assert(object);
+    struct triggerfish_strong *strong = NULL;
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    if (object->bottom != object->top) {
+        strong = object->deque[--object->bottom & (object->capacity - 1)];
+    }
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    return strong;
+}
+
+/* thieves take the least recently queued strong reference */
+static struct triggerfish_strong *steal(
+        struct triggerfish_teardown_worker *const object) {
+    assert(object);
+    struct triggerfish_strong *strong = NULL;
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    if (object->bottom != object->top) {
+        strong = object->deque[object->top++ & (object->capacity - 1)];
+    }
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    return strong;
+}
+
+static void flush(struct triggerfish_teardown_worker *const object) {
+    assert(object);
+    for (size_t i = 0; i < object->batched; i++) {
+        free(object->batch[i]);
+    }
+    object->batched = 0;
+}
+
+/* destroy queued strong references until every worker ran out of them */
+static void drain(struct triggerfish_teardown_worker *const object) {
+    assert(object);
+    struct triggerfish_teardown *const teardown = object->teardown;
+    const size_t index = object - teardown->workers;
+    for (;;) {
+        struct triggerfish_strong *strong = pop(object);
+        for (size_t i = 1; !strong && i < teardown->count; i++) {
+            strong = steal(&teardown->workers[(index + i) % teardown->count]);
+        }
+        if (strong) {
+            triggerfish_strong_destroy(strong);
+            triggerfish_atomic_subtract(&teardown->pending, 1);
+            continue;
+        }
+        if (!triggerfish_atomic_load(&teardown->pending)) {
+            break;
+        }
+        triggerfish_yield();
+    }
+    flush(object);
+}
+
+#ifndef TRIGGERFISH_SINGLE_THREADED
+static void *work(void *const argument) {
+    struct triggerfish_teardown_worker *const object = argument;
+    struct triggerfish_teardown *const teardown = object->teardown;
+    current = object;
+    uintmax_t generation = 0;
+    seagrass_required_true(!triggerfish_mutex_lock(&teardown->lock));
+    for (;;) {
+        while (!teardown->stopping && generation == teardown->generation) {
+            seagrass_required_true(!pthread_cond_wait(&teardown->wake,
+                                                      &teardown->lock));
+        }
+        if (teardown->stopping) {
+            break;
+        }
+        generation = teardown->generation;
+        seagrass_required_true(!triggerfish_mutex_unlock(&teardown->lock));
+        drain(object);
+        seagrass_required_true(!triggerfish_mutex_lock(&teardown->lock));
+        if (!--teardown->running) {
+            seagrass_required_true(!pthread_cond_signal(&teardown->done));
+        }
+    }
+    seagrass_required_true(!triggerfish_mutex_unlock(&teardown->lock));
+    return NULL;
+}
+
+/* let the threads of the first workers exit and join them */
+static void stop(struct triggerfish_teardown *const object,
+                 const size_t workers) {
+    assert(object);
+    seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+    object->stopping = true;
+    seagrass_required_true(!pthread_cond_broadcast(&object->wake));
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    for (size_t i = 1; i < workers; i++) {
+        seagrass_required_true(!pthread_join(object->workers[i].thread,
+                                             NULL));
+    }
+}
+#endif
+
+/* free teardown once the first workers have been initialized */
+static void dispose(struct triggerfish_teardown *const object,
+                    const size_t workers) {
+    assert(object);
+    for (size_t i = 0; i < workers; i++) {
+        seagrass_required_true(!triggerfish_mutex_destroy(
+                &object->workers[i].lock));
+        free(object->workers[i].deque);
+    }
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    seagrass_required_true(!pthread_cond_destroy(&object->done));
+    seagrass_required_true(!pthread_cond_destroy(&object->wake));
+#endif
+    seagrass_required_true(!triggerfish_mutex_destroy(&object->lock));
+    seagrass_required_true(!triggerfish_mutex_destroy(&object->release));
+    free(object);
+}
+
+int triggerfish_teardown_of(size_t workers,
+                            struct triggerfish_teardown **const out) {
+    if (!workers) {
+        return TRIGGERFISH_TEARDOWN_ERROR_WORKERS_IS_ZERO;
+    }
+    if (!out) {
+        return TRIGGERFISH_TEARDOWN_ERROR_OUT_IS_NULL;
+    }
+#ifdef TRIGGERFISH_SINGLE_THREADED
+    workers = 1;
+#endif
+    struct triggerfish_teardown *object;
+    if (workers > (SIZE_MAX - sizeof(*object))
+                  / sizeof(struct triggerfish_teardown_worker)) {
+        return TRIGGERFISH_TEARDOWN_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    object = calloc(1, sizeof(*object)
+                       + workers * sizeof(struct triggerfish_teardown_worker));
+    if (!object) {
+        return TRIGGERFISH_TEARDOWN_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    switch (triggerfish_mutex_init(&object->release)) {
+        default: {
+            seagrass_required_true(false);
+        }
+        case ENOMEM: {
+            free(object);
+            return TRIGGERFISH_TEARDOWN_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+        case 0: {
+            break;
+        }
+    }
+    switch (triggerfish_mutex_init(&object->lock)) {
+        default: {
+            seagrass_required_true(false);
+        }
+        case ENOMEM: {
+            seagrass_required_true(!triggerfish_mutex_destroy(
+                    &object->release));
+            free(object);
+            return TRIGGERFISH_TEARDOWN_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+        case 0: {
+            break;
+        }
+    }
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    seagrass_required_true(!pthread_cond_init(&object->wake, NULL));
+    seagrass_required_true(!pthread_cond_init(&object->done, NULL));
+#endif
+    object->count = workers;
+    for (size_t i = 0; i < workers; i++) {
+        struct triggerfish_teardown_worker *const worker = &object->workers[i];
+        worker->teardown = object;
+        switch (triggerfish_mutex_init(&worker->lock)) {
+            default: {
+                seagrass_required_true(false);
+            }
+            case ENOMEM: {
+                dispose(object, i);
+                return TRIGGERFISH_TEARDOWN_ERROR_MEMORY_ALLOCATION_FAILED;
+            }
+            case 0: {
+                break;
+            }
+        }
+        worker->capacity = TRIGGERFISH_TEARDOWN_DEQUE;
+        worker->deque = malloc(worker->capacity * sizeof(*worker->deque));
+        if (!worker->deque) {
+            dispose(object, i + 1);
+            return TRIGGERFISH_TEARDOWN_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+    }
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    /* the releasing thread is the first worker */
+    for (size_t i = 1; i < workers; i++) {
+        switch (pthread_create(&object->workers[i].thread, NULL, work,
+                               &object->workers[i])) {
+            default: {
+                seagrass_required_true(false);
+            }
+            case EAGAIN: {
+                stop(object, i);
+                dispose(object, workers);
+                return TRIGGERFISH_TEARDOWN_ERROR_MEMORY_ALLOCATION_FAILED;
+            }
+            case 0: {
+                break;
+            }
+        }
+    }
+#endif
+    *out = object;
+    return 0;
+}
+
+int triggerfish_teardown_destroy(struct triggerfish_teardown *const object) {
+    if (!object) {
+        return TRIGGERFISH_TEARDOWN_ERROR_OBJECT_IS_NULL;
+    }
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    stop(object, object->count);
+#endif
+    dispose(object, object->count);
+    return 0;
+}
+
+int triggerfish_teardown_release(struct triggerfish_teardown *const object,
+                                 struct triggerfish_strong *const strong) {
+    if (!object) {
+        return TRIGGERFISH_TEARDOWN_ERROR_OBJECT_IS_NULL;
+    }
+    if (!strong) {
+        return TRIGGERFISH_TEARDOWN_ERROR_STRONG_IS_NULL;
+    }
+    if (current) {
+        /* released while destroying, queued on the current worker */
+        return triggerfish_strong_release(strong);
+    }
+    seagrass_required_true(!triggerfish_mutex_lock(&object->release));
+    current = &object->workers[0];
+    const int error = triggerfish_strong_release(strong);
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    const bool wake = object->count > 1
+                      && triggerfish_atomic_load(&object->pending);
+    if (wake) {
+        seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+        object->generation++;
+        object->running = object->count - 1;
+        seagrass_required_true(!pthread_cond_broadcast(&object->wake));
+        seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    }
+#endif
+    drain(current);
+#ifndef TRIGGERFISH_SINGLE_THREADED
+    if (wake) {
+        seagrass_required_true(!triggerfish_mutex_lock(&object->lock));
+        while (object->running) {
+            seagrass_required_true(!pthread_cond_wait(&object->done,
+                                                      &object->lock));
+        }
+        seagrass_required_true(!triggerfish_mutex_unlock(&object->lock));
+    }
+#endif
+    current = NULL;
+    seagrass_required_true(!triggerfish_mutex_unlock(&object->release));
+    return error;
+}
+
+bool triggerfish_teardown_defer(struct triggerfish_strong *const strong) {
+    assert(strong);
+    struct triggerfish_teardown_worker *const worker = current;
+    if (!worker) {
+        return false;
+    }
+    /* counted first so that pending never drops to zero too early */
+    triggerfish_atomic_add(&worker->teardown->pending, 1);
+    if (!push(worker, strong)) {
+        triggerfish_atomic_subtract(&worker->teardown->pending, 1);
+        return false;
+    }
+    return true;
+}
+
+void triggerfish_teardown_free(void *const pointer) {
+    struct triggerfish_teardown_worker *const worker = current;
+    if (!worker) {
+        free(pointer);
+        return;
+    }
+    if (TRIGGERFISH_TEARDOWN_BATCH == worker->batched) {
+        flush(worker);
+    }
+    worker->batch[worker->batched++] = pointer;
+}
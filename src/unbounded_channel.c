@@ -0,0 +1,160 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/unbounded_channel.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+int triggerfish_unbounded_channel_of(
+        struct triggerfish_unbounded_channel **const out) {
+    if (!out) {
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_unbounded_channel *object = calloc(1, sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    struct triggerfish_unbounded_channel_node *stub
+            = calloc(1, sizeof(*stub));
+    if (!stub) {
+        free(object);
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    atomic_init(&stub->next, NULL);
+    atomic_init(&object->head, stub);
+    object->tail = stub;
+    *out = object;
+    return 0;
+}
+
+int triggerfish_unbounded_channel_destroy(
+        struct triggerfish_unbounded_channel *const object) {
+    if (!object) {
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OBJECT_IS_NULL;
+    }
+    struct triggerfish_strong *strong;
+    while (!triggerfish_unbounded_channel_receive(object, &strong)) {
+        seagrass_required_true(!triggerfish_strong_release(strong));
+    }
+    free(object->tail);
+    free(object);
+    return 0;
+}
+
+/*
+ * Publish the already linked nodes first to last with a single exchange, see
+ * Dmitry Vyukov's intrusive MPSC node-based queue.
+ */
+static void push(struct triggerfish_unbounded_channel *const object,
+                 struct triggerfish_unbounded_channel_node *const first,
+                 struct triggerfish_unbounded_channel_node *const last) {
+    assert(object);
+    assert(first);
+    assert(last);
+    atomic_store_explicit(&last->next, NULL, memory_order_relaxed);
+    struct triggerfish_unbounded_channel_node *previous = atomic_exchange_explicit(
+            &object->head, last, memory_order_acq_rel);
+    atomic_store_explicit(&previous->next, first, memory_order_release);
+}
+
+int triggerfish_unbounded_channel_send(
+        struct triggerfish_unbounded_channel *const object,
+        struct triggerfish_strong *const strong) {
+    if (!strong) {
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_STRONG_IS_NULL;
+    }
+    return triggerfish_unbounded_channel_send_batch(object, &strong, 1);
+}
+
+int triggerfish_unbounded_channel_send_batch(
+        struct triggerfish_unbounded_channel *const object,
+        struct triggerfish_strong *const *const items,
+        const uintmax_t count) {
+    if (!object) {
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OBJECT_IS_NULL;
+    }
+    if (!items) {
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_ITEMS_IS_NULL;
+    }
+    if (!count) {
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_COUNT_IS_ZERO;
+    }
+    struct triggerfish_unbounded_channel_node *first = NULL;
+    struct triggerfish_unbounded_channel_node *last = NULL;
+    for (uintmax_t i = 0; i < count; i++) {
+        struct triggerfish_unbounded_channel_node *node
+                = malloc(sizeof(*node));
+        if (!node) {
+            for (struct triggerfish_unbounded_channel_node *next;
+                 first; first = next) {
+                next = atomic_load_explicit(&first->next,
+                                            memory_order_relaxed);
+                free(first);
+            }
+            return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+        node->strong = items[i];
+        atomic_init(&node->next, NULL);
+        if (last) {
+            atomic_store_explicit(&last->next, node, memory_order_relaxed);
+        } else {
+            first = node;
+        }
+        last = node;
+    }
+    push(object, first, last);
+    return 0;
+}
+
+int triggerfish_unbounded_channel_receive(
+        struct triggerfish_unbounded_channel *const object,
+        struct triggerfish_strong **const out) {
+    if (!out) {
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OUT_IS_NULL;
+    }
+    uintmax_t count;
+    return triggerfish_unbounded_channel_receive_batch(object, out, 1, &count);
+}
+
+int triggerfish_unbounded_channel_receive_batch(
+        struct triggerfish_unbounded_channel *const object,
+        struct triggerfish_strong **const items,
+        const uintmax_t count,
+        uintmax_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OBJECT_IS_NULL;
+    }
+    if (!items) {
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_ITEMS_IS_NULL;
+    }
+    if (!count) {
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_COUNT_IS_ZERO;
+    }
+    if (!out) {
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OUT_IS_NULL;
+    }
+    uintmax_t i = 0;
+    for (; i < count; i++) {
+        struct triggerfish_unbounded_channel_node *tail = object->tail;
+        /* a producer that is still linking its nodes reads as empty */
+        struct triggerfish_unbounded_channel_node *next
+                = atomic_load_explicit(&tail->next, memory_order_acquire);
+        if (!next) {
+            break;
+        }
+        items[i] = next->strong;
+        next->strong = NULL;
+        object->tail = next;
+        free(tail);
+    }
+    if (!i) {
+        return TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_CHANNEL_IS_EMPTY;
+    }
+    *out = i;
+    return 0;
+}
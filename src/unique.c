@@ -0,0 +1,94 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/unique.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+int triggerfish_unique_of(void *const instance,
+                          void (*const on_destroy)(void *instance),
+                          struct triggerfish_unique **const out) {
+    if (!instance) {
+        return TRIGGERFISH_UNIQUE_ERROR_INSTANCE_IS_NULL;
+    }
+    if (!on_destroy) {
+        return TRIGGERFISH_UNIQUE_ERROR_ON_DESTROY_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_UNIQUE_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_unique *object = malloc(sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_UNIQUE_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    *object = (struct triggerfish_unique) {
+            .instance = instance,
+            .on_destroy = on_destroy
+    };
+    *out = object;
+    return 0;
+}
+
+int triggerfish_unique_destroy(struct triggerfish_unique *const object) {
+    if (!object) {
+        return TRIGGERFISH_UNIQUE_ERROR_OBJECT_IS_NULL;
+    }
+    object->on_destroy(object->instance);
+    free(object->instance);
+    free(object);
+    return 0;
+}
+
+int triggerfish_unique_instance(const struct triggerfish_unique *const object,
+                                void **const out) {
+    if (!object) {
+        return TRIGGERFISH_UNIQUE_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_UNIQUE_ERROR_OUT_IS_NULL;
+    }
+    *out = object->instance;
+    return 0;
+}
+
+int triggerfish_unique_strong(struct triggerfish_unique *const object,
+                              struct triggerfish_strong **const out) {
+    if (!object) {
+        return TRIGGERFISH_UNIQUE_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_UNIQUE_ERROR_OUT_IS_NULL;
+    }
+    int error;
+    if ((error = triggerfish_strong_of(object->instance, object->on_destroy,
+                                       out))) {
+        seagrass_required_true(
+                TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED == error);
+        return TRIGGERFISH_UNIQUE_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    free(object);
+    return 0;
+}
+
+int triggerfish_unique_local(struct triggerfish_unique *const object,
+                             struct triggerfish_local **const out) {
+    if (!object) {
+        return TRIGGERFISH_UNIQUE_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_UNIQUE_ERROR_OUT_IS_NULL;
+    }
+    int error;
+    if ((error = triggerfish_local_of(object->instance, object->on_destroy,
+                                      out))) {
+        seagrass_required_true(
+                TRIGGERFISH_LOCAL_ERROR_MEMORY_ALLOCATION_FAILED == error);
+        return TRIGGERFISH_UNIQUE_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    free(object);
+    return 0;
+}
@@ -0,0 +1,308 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/vector.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+#define TRIGGERFISH_VECTOR_INDEX_BITS   (sizeof(uintmax_t) * CHAR_BIT)
+
+static struct triggerfish_vector_node *instance(
+        const struct triggerfish_strong *const strong) {
+    assert(strong);
+    return strong->instance;
+}
+
+static void on_destroy(void *const instance) {
+    struct triggerfish_vector_node *const node = instance;
+    for (uintmax_t i = 0; i < TRIGGERFISH_VECTOR_WIDTH; i++) {
+        if (node->slots[i]) {
+            seagrass_required_true(!triggerfish_strong_release(
+                    node->slots[i]));
+        }
+    }
+}
+
+static int node_of(const struct triggerfish_vector_node *const from,
+                   struct triggerfish_strong **const out) {
+    assert(out);
+    struct triggerfish_vector_node *node = from
+            ? malloc(sizeof(*node))
+            : calloc(1, sizeof(*node));
+    if (!node) {
+        return TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    int error;
+    if ((error = triggerfish_strong_of(node, on_destroy, out))) {
+        seagrass_required_true(
+                TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED == error);
+        free(node);
+        return TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    if (from) {
+        *node = *from;
+        for (uintmax_t i = 0; i < TRIGGERFISH_VECTOR_WIDTH; i++) {
+            if (node->slots[i]) {
+                seagrass_required_true(!triggerfish_strong_retain(
+                        node->slots[i]));
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Make the node in slot exclusively ours. A node only referred to by this
+ * version is changed in place, otherwise it is copied and the copy takes
+ * over our reference to the children.
+ */
+static int unique(struct triggerfish_strong **const slot) {
+    assert(slot);
+    assert(*slot);
+    if (1 == triggerfish_counter_count(
+            triggerfish_atomic_load(&(*slot)->counter))) {
+        return 0;
+    }
+    struct triggerfish_strong *copy;
+    const int error = node_of(instance(*slot), &copy);
+    if (!error) {
+        seagrass_required_true(!triggerfish_strong_release(*slot));
+        *slot = copy;
+    }
+    return error;
+}
+
+/*
+ * Make every node on the path to index exclusively ours, adding the nodes
+ * that are missing. The slots holding each node are stored root first.
+ */
+static int walk(struct triggerfish_vector *const object,
+                const uintmax_t index,
+                struct triggerfish_strong **path[]) {
+    assert(object);
+    assert(path);
+    struct triggerfish_strong **slot = &object->root;
+    for (uintmax_t level = object->shift, i = 0;;
+         level -= TRIGGERFISH_VECTOR_BITS, i++) {
+        path[i] = slot;
+        const int error = *slot ? unique(slot) : node_of(NULL, slot);
+        if (error) {
+            return error;
+        }
+        if (!level) {
+            return 0;
+        }
+        slot = &instance(*slot)->slots[(index >> level)
+                                        & TRIGGERFISH_VECTOR_MASK];
+    }
+}
+
+int triggerfish_vector_of(struct triggerfish_vector **const out) {
+    if (!out) {
+        return TRIGGERFISH_VECTOR_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_vector *object = calloc(1, sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    *out = object;
+    return 0;
+}
+
+int triggerfish_vector_destroy(struct triggerfish_vector *const object) {
+    if (!object) {
+        return TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL;
+    }
+    if (object->root) {
+        seagrass_required_true(!triggerfish_strong_release(object->root));
+    }
+    free(object);
+    return 0;
+}
+
+int triggerfish_vector_copy_of(const struct triggerfish_vector *const object,
+                               struct triggerfish_vector **const out) {
+    if (!object) {
+        return TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_VECTOR_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_vector *copy = malloc(sizeof(*copy));
+    if (!copy) {
+        return TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    *copy = *object;
+    if (copy->root) {
+        seagrass_required_true(!triggerfish_strong_retain(copy->root));
+    }
+    *out = copy;
+    return 0;
+}
+
+int triggerfish_vector_count(const struct triggerfish_vector *const object,
+                             uintmax_t *const out) {
+    if (!object) {
+        return TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_VECTOR_ERROR_OUT_IS_NULL;
+    }
+    *out = object->count;
+    return 0;
+}
+
+static int retain(struct triggerfish_strong *const strong) {
+    assert(strong);
+    int error;
+    if ((error = triggerfish_strong_retain(strong))) {
+        seagrass_required_true(TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID
+                               == error);
+        return TRIGGERFISH_VECTOR_ERROR_STRONG_IS_INVALID;
+    }
+    return 0;
+}
+
+int triggerfish_vector_add(struct triggerfish_vector *const object,
+                           struct triggerfish_strong *const strong) {
+    if (!object) {
+        return TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL;
+    }
+    if (!strong) {
+        return TRIGGERFISH_VECTOR_ERROR_STRONG_IS_NULL;
+    }
+    if (UINTMAX_MAX == object->count) {
+        return TRIGGERFISH_VECTOR_ERROR_VECTOR_IS_FULL;
+    }
+    int error;
+    if ((error = retain(strong))) {
+        return error;
+    }
+    const uintmax_t shift = object->shift + TRIGGERFISH_VECTOR_BITS;
+    if (object->root && shift < TRIGGERFISH_VECTOR_INDEX_BITS
+        && object->count == (uintmax_t) 1 << shift) {
+        /* root is full, grow the tree by one level */
+        struct triggerfish_strong *root;
+        if ((error = node_of(NULL, &root))) {
+            seagrass_required_true(!triggerfish_strong_release(strong));
+            return error;
+        }
+        instance(root)->slots[0] = object->root;
+        object->root = root;
+        object->shift = shift;
+    }
+    struct triggerfish_strong **path[TRIGGERFISH_VECTOR_MAX_DEPTH];
+    if ((error = walk(object, object->count, path))) {
+        seagrass_required_true(!triggerfish_strong_release(strong));
+        return error;
+    }
+    struct triggerfish_vector_node *const leaf
+            = instance(*path[object->shift / TRIGGERFISH_VECTOR_BITS]);
+    leaf->slots[object->count & TRIGGERFISH_VECTOR_MASK] = strong;
+    object->count += 1;
+    return 0;
+}
+
+int triggerfish_vector_remove_last(struct triggerfish_vector *const object) {
+    if (!object) {
+        return TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL;
+    }
+    if (!object->count) {
+        return TRIGGERFISH_VECTOR_ERROR_VECTOR_IS_EMPTY;
+    }
+    const uintmax_t index = object->count - 1;
+    struct triggerfish_strong **path[TRIGGERFISH_VECTOR_MAX_DEPTH];
+    int error;
+    if ((error = walk(object, index, path))) {
+        return error;
+    }
+    uintmax_t depth = object->shift / TRIGGERFISH_VECTOR_BITS;
+    struct triggerfish_strong **const slot
+            = &instance(*path[depth])->slots[index & TRIGGERFISH_VECTOR_MASK];
+    seagrass_required_true(!triggerfish_strong_release(*slot));
+    *slot = NULL;
+    /* drop the nodes that held nothing but the removed element */
+    for (uintmax_t level = TRIGGERFISH_VECTOR_BITS; depth;
+         depth--, level += TRIGGERFISH_VECTOR_BITS) {
+        if (index & (((uintmax_t) 1 << level) - 1)) {
+            break;
+        }
+        seagrass_required_true(!triggerfish_strong_release(*path[depth]));
+        *path[depth] = NULL;
+    }
+    object->count = index;
+    if (!index) {
+        seagrass_required_true(!triggerfish_strong_release(object->root));
+        object->root = NULL;
+        object->shift = 0;
+        return 0;
+    }
+    /* shrink the tree while the first child can hold every element */
+    while (object->shift && index <= (uintmax_t) 1 << object->shift) {
+        struct triggerfish_strong *const root = object->root;
+        object->root = instance(root)->slots[0];
+        seagrass_required_true(!triggerfish_strong_retain(object->root));
+        seagrass_required_true(!triggerfish_strong_release(root));
+        object->shift -= TRIGGERFISH_VECTOR_BITS;
+    }
+    return 0;
+}
+
+int triggerfish_vector_set(struct triggerfish_vector *const object,
+                           const uintmax_t index,
+                           struct triggerfish_strong *const strong) {
+    if (!object) {
+        return TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL;
+    }
+    if (!strong) {
+        return TRIGGERFISH_VECTOR_ERROR_STRONG_IS_NULL;
+    }
+    if (index >= object->count) {
+        return TRIGGERFISH_VECTOR_ERROR_INDEX_IS_OUT_OF_BOUNDS;
+    }
+    int error;
+    if ((error = retain(strong))) {
+        return error;
+    }
+    struct triggerfish_strong **path[TRIGGERFISH_VECTOR_MAX_DEPTH];
+    if ((error = walk(object, index, path))) {
+        seagrass_required_true(!triggerfish_strong_release(strong));
+        return error;
+    }
+    struct triggerfish_strong **const slot
+            = &instance(*path[object->shift / TRIGGERFISH_VECTOR_BITS])
+                    ->slots[index & TRIGGERFISH_VECTOR_MASK];
+    seagrass_required_true(!triggerfish_strong_release(*slot));
+    *slot = strong;
+    return 0;
+}
+
+int triggerfish_vector_get(const struct triggerfish_vector *const object,
+                           const uintmax_t index,
+                           struct triggerfish_strong **const out) {
+    if (!object) {
+        return TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_VECTOR_ERROR_OUT_IS_NULL;
+    }
+    if (index >= object->count) {
+        return TRIGGERFISH_VECTOR_ERROR_INDEX_IS_OUT_OF_BOUNDS;
+    }
+    const struct triggerfish_strong *node = object->root;
+    for (uintmax_t level = object->shift; level;
+         level -= TRIGGERFISH_VECTOR_BITS) {
+        node = instance(node)->slots[(index >> level)
+                                     & TRIGGERFISH_VECTOR_MASK];
+    }
+    struct triggerfish_strong *const strong
+            = instance(node)->slots[index & TRIGGERFISH_VECTOR_MASK];
+    seagrass_required_true(!triggerfish_strong_retain(strong));
+    *out = strong;
+    return 0;
+}
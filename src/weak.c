@@ -1,23 +1,107 @@
 #include <stdlib.h>
-#include <stdatomic.h>
 #include <assert.h>
+#include <errno.h>
 #include <seagrass.h>
 #include <triggerfish.h>
 
 #include "private/strong.h"
 #include "private/weak.h"
+#include "private/region.h"
+#include "private/reference_queue.h"
 
 #ifdef TEST
 #include <test/cmocka.h>
 #endif
 
+#ifdef TRIGGERFISH_DEBUG_OWNERSHIP
+/* weak references borrowed by the calling thread */
+static _Thread_local struct {
+    const struct triggerfish_weak *weak[TRIGGERFISH_WEAK_DEBUG_BORROWS];
+    uintmax_t count;
+    uintmax_t untracked;
+} borrowed;
+
+static void debug_borrow(const struct triggerfish_weak *const object) {
+    if (borrowed.count < TRIGGERFISH_WEAK_DEBUG_BORROWS) {
+        borrowed.weak[borrowed.count++] = object;
+    } else {
+        borrowed.untracked++;
+    }
+}
+
+static bool debug_is_borrowed(const struct triggerfish_weak *const object) {
+    for (uintmax_t i = 0; i < borrowed.count; i++) {
+        if (borrowed.weak[i] == object) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void debug_borrow_end(const struct triggerfish_weak *const object) {
+    for (uintmax_t i = borrowed.count; i; i--) {
+        if (borrowed.weak[i - 1] == object) {
+            borrowed.weak[i - 1] = borrowed.weak[--borrowed.count];
+            return;
+        }
+    }
+    /* ending a borrow that was never started */
+    seagrass_required_true(borrowed.untracked);
+    borrowed.untracked--;
+}
+
+/* weak references taken by the calling thread, freed once pushed out */
+static _Thread_local struct {
+    struct triggerfish_weak *weak[TRIGGERFISH_WEAK_DEBUG_TAKEN];
+    uintmax_t count;
+} taken;
+
+static void debug_take(struct triggerfish_weak *const object) {
+    triggerfish_atomic_store(&object->borrows, TRIGGERFISH_WEAK_TAKEN);
+    struct triggerfish_weak **const slot
+            = &taken.weak[taken.count++ % TRIGGERFISH_WEAK_DEBUG_TAKEN];
+    free(*slot);
+    *slot = object;
+}
+
+static void debug_is_not_taken(const struct triggerfish_weak *const object) {
+    /* using a weak reference after it was taken */
+    seagrass_required_true(!(triggerfish_atomic_load(&object->borrows)
+                             & TRIGGERFISH_WEAK_TAKEN));
+}
+#endif
+
+/* end a borrow, setting flags, and wake the destroyer if it waits for it */
+static triggerfish_counter_t unborrow(struct triggerfish_weak *const object,
+                                      const triggerfish_counter_t flags) {
+    assert(object);
+    triggerfish_counter_t desired;
+    triggerfish_counter_t expected = triggerfish_atomic_load(&object->borrows);
+    do {
+        seagrass_required_true(triggerfish_weak_borrows(expected));
+        /* the destroyer sets the flag again if it has to keep waiting */
+        desired = ((expected - 1) | flags) & ~TRIGGERFISH_COUNTER_WAITING;
+    } while (!triggerfish_atomic_compare_exchange(&object->borrows,
+                                                  &expected, desired));
+    if (expected & TRIGGERFISH_COUNTER_WAITING) {
+        triggerfish_counter_wake(&object->borrows);
+    }
+    return expected;
+}
+
 static int init(struct triggerfish_weak *const object,
                 struct triggerfish_strong *const strong) {
     assert(object);
     assert(strong);
+    /* aliases are freed once released, before their parent is destroyed */
+    if (strong->parent) {
+        return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_ALIAS;
+    }
     int error;
     *object = (struct triggerfish_weak) {0};
-    if ((error = triggerfish_strong_register(strong, object))) {
+    if ((error = strong->region
+                 ? triggerfish_region_register(strong->region, object)
+                 : triggerfish_strong_register(strong, object))) {
         switch (error) {
             default: {
                 seagrass_required_true(false);
@@ -28,7 +112,32 @@ static int init(struct triggerfish_weak *const object,
             }
         }
     }
-    atomic_store(&object->strong, (uintptr_t) strong);
+    triggerfish_atomic_store(&object->strong, (uintptr_t) strong);
+    return 0;
+}
+
+static int init_borrowed(struct triggerfish_weak *const object,
+                         struct triggerfish_strong *const strong) {
+    assert(object);
+    assert(strong);
+    int error;
+    *object = (struct triggerfish_weak) {0};
+    /* the destroyer may reach object before the borrow it waits on ends */
+    triggerfish_atomic_store(&object->strong, (uintptr_t) strong);
+    if ((error = strong->region
+                 ? triggerfish_region_register_borrowed(strong->region, object)
+                 : triggerfish_strong_register_borrowed(strong, object))) {
+        switch (error) {
+            default: {
+                seagrass_required_true(false);
+            }
+            case TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID:
+            case TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED: {
+                triggerfish_atomic_store(&object->strong, 0);
+                return error;
+            }
+        }
+    }
     return 0;
 }
 
@@ -65,11 +174,63 @@ int triggerfish_weak_destroy(struct triggerfish_weak *const object) {
     if (!object) {
         return TRIGGERFISH_WEAK_ERROR_OBJECT_IS_NULL;
     }
-    struct triggerfish_strong *strong = (void *) atomic_load(&object->strong);
-    if (strong) {
-        triggerfish_strong_unregister(strong, object);
+#ifdef TRIGGERFISH_DEBUG_OWNERSHIP
+    debug_is_not_taken(object);
+    /* destroying a weak reference that is still borrowed */
+    seagrass_required_true(!triggerfish_weak_borrows(
+            triggerfish_atomic_load(&object->borrows)));
+#endif
+    /* keeps the strong reference alive until it has been unregistered */
+    triggerfish_atomic_add(&object->borrows, 1);
+    struct triggerfish_strong *strong = (void *) triggerfish_atomic_load(&object->strong);
+    if (strong && (strong->region
+                   ? triggerfish_region_unregister(strong->region, object)
+                   : triggerfish_strong_unregister(strong, object))) {
+        unborrow(object, 0);
+        /* still set if the strong reference was never invalidated */
+        free(object->entry);
+        free(object);
+        return 0;
     }
-    free(object);
+    /* otherwise the destroyer frees object unless it is already done */
+    const triggerfish_counter_t expected = unborrow(
+            object, TRIGGERFISH_WEAK_DESTROYED);
+    if (!strong && !(expected & TRIGGERFISH_WEAK_CLAIMED)) {
+        free(object->entry);
+        free(object);
+    }
+    return 0;
+}
+
+int triggerfish_weak_of_queue(struct triggerfish_strong *const strong,
+                              struct triggerfish_reference_queue *const queue,
+                              void *const cookie,
+                              struct triggerfish_weak **const out) {
+    if (!strong) {
+        return TRIGGERFISH_WEAK_ERROR_STRONG_IS_NULL;
+    }
+    if (!queue) {
+        return TRIGGERFISH_WEAK_ERROR_QUEUE_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_WEAK_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_reference_queue_entry *entry;
+    int error;
+    if ((error = triggerfish_reference_queue_entry_of(queue, cookie, &entry))) {
+        seagrass_required_true(
+                TRIGGERFISH_REFERENCE_QUEUE_ERROR_MEMORY_ALLOCATION_FAILED
+                == error);
+        return TRIGGERFISH_WEAK_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    struct triggerfish_weak *object;
+    if ((error = triggerfish_weak_of(strong, &object))) {
+        free(entry);
+        return error;
+    }
+    /* strong is held by the caller so it cannot be invalidated meanwhile */
+    object->entry = entry;
+    *out = object;
     return 0;
 }
 
@@ -85,31 +246,33 @@ int triggerfish_weak_copy_of(const struct triggerfish_weak *const other,
     if (!object) {
         return TRIGGERFISH_WEAK_ERROR_MEMORY_ALLOCATION_FAILED;
     }
-    int error;
-    struct triggerfish_strong *strong;
-    if ((error = triggerfish_weak_strong(other, &strong))) {
-        seagrass_required_true(TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
-                               == error);
-        *out = object;
-        return 0;
-    }
-    if ((error = init(object, strong))) {
+    struct triggerfish_weak *const source = (struct triggerfish_weak *) other;
+#ifdef TRIGGERFISH_DEBUG_OWNERSHIP
+    debug_is_not_taken(source);
+#endif
+    triggerfish_atomic_add(&source->borrows, 1);
+    int error = 0;
+    struct triggerfish_strong *strong = (void *) triggerfish_atomic_load(&source->strong);
+    if (strong && (error = init_borrowed(object, strong))) {
         switch (error) {
             default: {
                 seagrass_required_true(false);
             }
-            case TRIGGERFISH_WEAK_ERROR_MEMORY_ALLOCATION_FAILED:
-            case TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID: {
+            case TRIGGERFISH_WEAK_ERROR_MEMORY_ALLOCATION_FAILED: {
                 free(object);
+                break;
+            }
+            case TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID: {
+                error = 0;
+                break;
             }
         }
-    } else {
+    }
+    unborrow(source, 0);
+    if (!error) {
         *out = object;
     }
-    seagrass_required_true(!triggerfish_strong_release(strong));
-    return error == TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID
-           ? 0
-           : error;
+    return error;
 }
 
 int triggerfish_weak_strong(const struct triggerfish_weak *const object,
@@ -120,7 +283,10 @@ int triggerfish_weak_strong(const struct triggerfish_weak *const object,
     if (!out) {
         return TRIGGERFISH_WEAK_ERROR_OUT_IS_NULL;
     }
-    struct triggerfish_strong *strong = (void *) atomic_load(&object->strong);
+#ifdef TRIGGERFISH_DEBUG_OWNERSHIP
+    debug_is_not_taken(object);
+#endif
+    struct triggerfish_strong *strong = (void *) triggerfish_atomic_load(&object->strong);
     if (!strong) {
         return TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID;
     }
@@ -134,3 +300,268 @@ int triggerfish_weak_strong(const struct triggerfish_weak *const object,
     return 0;
 }
 
+int triggerfish_weak_strong_take(struct triggerfish_weak *const object,
+                                 struct triggerfish_strong **const out) {
+    if (!object) {
+        return TRIGGERFISH_WEAK_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_WEAK_ERROR_OUT_IS_NULL;
+    }
+#ifdef TRIGGERFISH_DEBUG_OWNERSHIP
+    debug_is_not_taken(object);
+    /* taking a weak reference that is still borrowed */
+    seagrass_required_true(!triggerfish_weak_borrows(
+            triggerfish_atomic_load(&object->borrows)));
+#endif
+    /* keeps the strong reference alive until it has been retained */
+    triggerfish_atomic_add(&object->borrows, 1);
+    struct triggerfish_strong *strong = (void *) triggerfish_atomic_load(&object->strong);
+    int error;
+    if (!strong || (error = triggerfish_strong_retain(strong))) {
+        seagrass_required_true(!strong
+                               || TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID
+                                  == error);
+        unborrow(object, 0);
+        return TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID;
+    }
+    /* retained, so no destroyer waits for the borrow or invalidates object
+     * and its registration is handed over to the new reference */
+    seagrass_required_true(strong->region
+                           ? triggerfish_region_unregister(strong->region,
+                                                           object)
+                           : triggerfish_strong_unregister(strong, object));
+    free(object->entry);
+#ifdef TRIGGERFISH_DEBUG_OWNERSHIP
+    debug_take(object);
+#else
+    free(object);
+#endif
+    *out = strong;
+    return 0;
+}
+
+int triggerfish_weak_borrow(const struct triggerfish_weak *const object,
+                            void **const out) {
+    if (!object) {
+        return TRIGGERFISH_WEAK_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_WEAK_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_weak *const weak = (struct triggerfish_weak *) object;
+#ifdef TRIGGERFISH_DEBUG_OWNERSHIP
+    debug_is_not_taken(weak);
+#endif
+    triggerfish_atomic_add(&weak->borrows, 1);
+    /* while borrowed the destroyer cannot get past invalidating this weak */
+    struct triggerfish_strong *strong = (void *) triggerfish_atomic_load(&weak->strong);
+    int error;
+    if (!strong || (error = triggerfish_strong_instance(strong, out))) {
+        unborrow(weak, 0);
+        return TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID;
+    }
+#ifdef TRIGGERFISH_DEBUG_OWNERSHIP
+    debug_borrow(object);
+#endif
+    return 0;
+}
+
+int triggerfish_weak_borrow_end(const struct triggerfish_weak *const object) {
+    if (!object) {
+        return TRIGGERFISH_WEAK_ERROR_OBJECT_IS_NULL;
+    }
+#ifdef TRIGGERFISH_DEBUG_OWNERSHIP
+    debug_borrow_end(object);
+#endif
+    unborrow((struct triggerfish_weak *) object, 0);
+    return 0;
+}
+
+int triggerfish_weak_owner_compare(const void *a, const void *b) {
+    struct triggerfish_weak **A = (void *) a;
+    struct triggerfish_weak **B = (void *) b;
+    return seagrass_void_ptr_compare(*A, *B);
+}
+
+static int add(struct coral_red_black_tree_container *const weak_refs,
+               struct triggerfish_weak *const weak) {
+    assert(weak_refs);
+    assert(weak);
+    int error;
+    union {
+        struct coral_red_black_tree_container_entry *entry;
+        struct triggerfish_weak **weak;
+    } ptr;
+    if ((error = coral_red_black_tree_container_alloc(
+            sizeof(struct triggerfish_weak **), &ptr.entry))) {
+        seagrass_required_true(
+                CORAL_RED_BLACK_TREE_CONTAINER_ERROR_MEMORY_ALLOCATION_FAILED
+                == error);
+    } else {
+        *ptr.weak = weak;
+        if ((error = coral_red_black_tree_container_add(
+                weak_refs, ptr.entry))) {
+            seagrass_required_true(
+                    CORAL_RED_BLACK_TREE_CONTAINER_ERROR_ENTRY_ALREADY_EXISTS
+                    == error);
+            seagrass_required_true(!coral_red_black_tree_container_free(
+                    ptr.entry));
+        }
+    }
+    return error;
+}
+
+int triggerfish_weak_owner_register(
+        const struct triggerfish_weak_owner *const owner,
+        struct triggerfish_weak *const weak) {
+    assert(owner);
+    assert(weak);
+    int error;
+    if ((error = triggerfish_mutex_lock(owner->lock))) {
+        seagrass_required_true(EINVAL == error);
+        return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID;
+    }
+    error = add(owner->weak_refs, weak);
+    seagrass_required_true(!triggerfish_mutex_unlock(owner->lock));
+    return error;
+}
+
+/*
+ * Lock owner unless it is being destroyed, as its destroyer holds the lock
+ * while it waits for the borrows of the caller to end.
+ */
+static bool lock_unless_destroyed(
+        const struct triggerfish_weak_owner *const owner) {
+    assert(owner);
+    int error;
+    while ((error = triggerfish_mutex_trylock(owner->lock))) {
+        seagrass_required_true(EBUSY == error);
+        if (!triggerfish_atomic_load(owner->counter)) {
+            return false;
+        }
+        triggerfish_yield();
+    }
+    return true;
+}
+
+int triggerfish_weak_owner_register_borrowed(
+        const struct triggerfish_weak_owner *const owner,
+        struct triggerfish_weak *const weak) {
+    assert(owner);
+    assert(weak);
+    if (!lock_unless_destroyed(owner)) {
+        return TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID;
+    }
+    const int error = triggerfish_atomic_load(owner->counter)
+                      ? add(owner->weak_refs, weak)
+                      : TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID;
+    seagrass_required_true(!triggerfish_mutex_unlock(owner->lock));
+    return error;
+}
+
+bool triggerfish_weak_owner_unregister(
+        const struct triggerfish_weak_owner *const owner,
+        const struct triggerfish_weak *const weak) {
+    assert(owner);
+    assert(weak);
+    if (!lock_unless_destroyed(owner)) {
+        return false;
+    }
+    /* not yet reached by a destroyer, which has to wait for the lock */
+    int error;
+    union {
+        struct coral_red_black_tree_container_entry *entry;
+        struct triggerfish_weak **weak;
+    } ptr;
+    if ((error = coral_red_black_tree_container_get(
+            owner->weak_refs, &weak, &ptr.entry))) {
+        seagrass_required_true(
+                CORAL_RED_BLACK_TREE_CONTAINER_ERROR_ENTRY_NOT_FOUND
+                == error);
+    } else {
+        seagrass_required_true(!coral_red_black_tree_container_remove(
+                owner->weak_refs, ptr.entry));
+        seagrass_required_true(!coral_red_black_tree_container_free(ptr.entry));
+    }
+    seagrass_required_true(!triggerfish_mutex_unlock(owner->lock));
+    return true;
+}
+
+/* sleep until all the borrows started before the invalidation have ended */
+static void await_borrows(struct triggerfish_weak *const object) {
+    assert(object);
+    triggerfish_counter_t expected = triggerfish_atomic_load(&object->borrows);
+    if (!triggerfish_weak_borrows(expected)) {
+        return;
+    }
+#ifdef TRIGGERFISH_DEBUG_OWNERSHIP
+    /* final release while the calling thread still borrows the instance */
+    seagrass_required_true(!debug_is_borrowed(object));
+#endif
+    while (triggerfish_weak_borrows(expected)) {
+        if (!(expected & TRIGGERFISH_COUNTER_WAITING)) {
+            const triggerfish_counter_t desired
+                    = expected | TRIGGERFISH_COUNTER_WAITING;
+            if (!triggerfish_atomic_compare_exchange(&object->borrows,
+                                                     &expected, desired)) {
+                continue;
+            }
+            expected = desired;
+        }
+        /* fails only if there is no other thread that could ever wake us */
+        seagrass_required_true(triggerfish_counter_wait(&object->borrows,
+                                                        expected, NULL));
+        expected = triggerfish_atomic_load(&object->borrows);
+    }
+}
+
+/* done with the weak reference, free it if its destroy already ran */
+static void release_claim(struct triggerfish_weak *const object) {
+    assert(object);
+    triggerfish_counter_t desired;
+    triggerfish_counter_t expected = triggerfish_atomic_load(&object->borrows);
+    do {
+        desired = expected & ~TRIGGERFISH_WEAK_CLAIMED;
+    } while (!triggerfish_atomic_compare_exchange(&object->borrows,
+                                                  &expected, desired));
+    if (expected & TRIGGERFISH_WEAK_DESTROYED) {
+        free(object->entry);
+        free(object);
+    }
+}
+
+void triggerfish_weak_owner_invalidate(
+        const struct triggerfish_weak_owner *const owner) {
+    assert(owner);
+    int error;
+    seagrass_required_true(!triggerfish_mutex_lock(owner->lock));
+    union {
+        struct coral_red_black_tree_container_entry *entry;
+        struct triggerfish_weak **weak;
+    } ptr;
+    if (!(error = coral_red_black_tree_container_first(
+            owner->weak_refs, &ptr.entry))) {
+        do {
+            struct triggerfish_weak *const weak = *ptr.weak;
+            if (weak->entry) {
+                triggerfish_reference_queue_push(weak->entry);
+                weak->entry = NULL;
+            }
+            /* a concurrent destroy of weak leaves freeing it to us */
+            triggerfish_atomic_add(&weak->borrows, TRIGGERFISH_WEAK_CLAIMED);
+            triggerfish_atomic_store(&weak->strong, 0);
+            await_borrows(weak);
+            release_claim(weak);
+        } while (!(error = coral_red_black_tree_container_next(
+                ptr.entry, &ptr.entry)));
+        seagrass_required_true(
+                CORAL_RED_BLACK_TREE_CONTAINER_ERROR_END_OF_SEQUENCE
+                == error);
+    } else {
+        seagrass_required_true(
+                CORAL_RED_BLACK_TREE_CONTAINER_ERROR_CONTAINER_IS_EMPTY
+                == error);
+    }
+    seagrass_required_true(!triggerfish_mutex_unlock(owner->lock));
+}
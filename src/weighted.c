@@ -0,0 +1,137 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <seagrass.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/weighted.h"
+
+#ifdef TEST
+#include <test/cmocka.h>
+#endif
+
+int triggerfish_weighted_of(struct triggerfish_strong *const strong,
+                            struct triggerfish_weighted **const out) {
+    if (!strong) {
+        return TRIGGERFISH_WEIGHTED_ERROR_STRONG_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_WEIGHTED_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_weighted *object = malloc(sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_WEIGHTED_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    struct triggerfish_weighted_block *block = malloc(sizeof(*block));
+    if (!block) {
+        free(object);
+        return TRIGGERFISH_WEIGHTED_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    int error;
+    if ((error = triggerfish_strong_retain(strong))) {
+        seagrass_required_true(
+                TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID == error);
+        free(block);
+        free(object);
+        return TRIGGERFISH_WEIGHTED_ERROR_STRONG_IS_INVALID;
+    }
+    triggerfish_atomic_store(&block->weight, TRIGGERFISH_WEIGHTED_WEIGHT);
+    block->strong = strong;
+    *object = (struct triggerfish_weighted) {
+            .block = block,
+            .weight = TRIGGERFISH_WEIGHTED_WEIGHT
+    };
+    *out = object;
+    return 0;
+}
+
+/*
+ * Add weight to the shared counter, which cannot drop to zero meanwhile as
+ * the weight of the caller is part of it.
+ */
+static void borrow(struct triggerfish_weighted_block *const block) {
+    assert(block);
+    triggerfish_counter_t desired;
+    triggerfish_counter_t expected = triggerfish_atomic_load(&block->weight);
+    do {
+        seagrass_required_true(expected);
+        seagrass_required_true(TRIGGERFISH_COUNTER_MAX - expected
+                               >= TRIGGERFISH_WEIGHTED_WEIGHT);
+        desired = expected + TRIGGERFISH_WEIGHTED_WEIGHT;
+    } while (!triggerfish_atomic_compare_exchange(&block->weight,
+                                                  &expected, desired));
+}
+
+int triggerfish_weighted_copy_of(struct triggerfish_weighted *const other,
+                                 struct triggerfish_weighted **const out) {
+    if (!other) {
+        return TRIGGERFISH_WEIGHTED_ERROR_OTHER_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_WEIGHTED_ERROR_OUT_IS_NULL;
+    }
+    struct triggerfish_weighted *object = malloc(sizeof(*object));
+    if (!object) {
+        return TRIGGERFISH_WEIGHTED_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    assert(other->weight);
+    if (1 == other->weight) {
+        borrow(other->block);
+        other->weight += TRIGGERFISH_WEIGHTED_WEIGHT;
+    }
+    const triggerfish_counter_t weight = other->weight / 2;
+    other->weight -= weight;
+    *object = (struct triggerfish_weighted) {
+            .block = other->block,
+            .weight = weight
+    };
+    *out = object;
+    return 0;
+}
+
+int triggerfish_weighted_destroy(struct triggerfish_weighted *const object) {
+    if (!object) {
+        return TRIGGERFISH_WEIGHTED_ERROR_OBJECT_IS_NULL;
+    }
+    struct triggerfish_weighted_block *const block = object->block;
+    triggerfish_counter_t desired;
+    triggerfish_counter_t expected = triggerfish_atomic_load(&block->weight);
+    do {
+        seagrass_required_true(expected >= object->weight);
+        desired = expected - object->weight;
+    } while (!triggerfish_atomic_compare_exchange(&block->weight,
+                                                  &expected, desired));
+    free(object);
+    if (!desired) {
+        seagrass_required_true(!triggerfish_strong_release(block->strong));
+        free(block);
+    }
+    return 0;
+}
+
+int triggerfish_weighted_instance(
+        const struct triggerfish_weighted *const object,
+        void **const out) {
+    if (!object) {
+        return TRIGGERFISH_WEIGHTED_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_WEIGHTED_ERROR_OUT_IS_NULL;
+    }
+    seagrass_required_true(!triggerfish_strong_instance(
+            object->block->strong, out));
+    return 0;
+}
+
+int triggerfish_weighted_strong(const struct triggerfish_weighted *const object,
+                                struct triggerfish_strong **const out) {
+    if (!object) {
+        return TRIGGERFISH_WEIGHTED_ERROR_OBJECT_IS_NULL;
+    }
+    if (!out) {
+        return TRIGGERFISH_WEIGHTED_ERROR_OUT_IS_NULL;
+    }
+    seagrass_required_true(!triggerfish_strong_retain(object->block->strong));
+    *out = object->block->strong;
+    return 0;
+}
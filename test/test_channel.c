@@ -0,0 +1,394 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/channel.h"
+
+#include <test/cmocka.h>
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static struct triggerfish_strong *strong(void) {
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &out), 0);
+    return out;
+}
+
+static void check_of_error_on_capacity_is_zero(void **state) {
+    assert_int_equal(
+            triggerfish_channel_of(0, (void *) 1),
+            TRIGGERFISH_CHANNEL_ERROR_CAPACITY_IS_ZERO);
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_of(1, NULL),
+            TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_capacity_is_too_large(void **state) {
+    struct triggerfish_channel *out;
+    assert_int_equal(
+            triggerfish_channel_of(UINTMAX_MAX, &out),
+            TRIGGERFISH_CHANNEL_ERROR_CAPACITY_IS_TOO_LARGE);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_channel *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_channel_of(1, &out),
+            TRIGGERFISH_CHANNEL_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+}
+
+static void check_of(void **state) {
+    struct triggerfish_channel *object;
+    assert_int_equal(triggerfish_channel_of(5, &object), 0);
+    assert_non_null(object);
+    assert_int_equal(object->mask, 7);
+    assert_int_equal(atomic_load(&object->enqueue), 0);
+    assert_int_equal(atomic_load(&object->dequeue), 0);
+    for (uintmax_t i = 0; i <= object->mask; i++) {
+        assert_int_equal(atomic_load(&object->cells[i].sequence), i);
+    }
+    assert_int_equal(triggerfish_channel_destroy(object), 0);
+}
+
+static void check_destroy_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_destroy(NULL),
+            TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_destroy(void **state) {
+    struct triggerfish_channel *object;
+    assert_int_equal(triggerfish_channel_of(4, &object), 0);
+    for (uintmax_t i = 0; i < 3; i++) {
+        assert_int_equal(triggerfish_channel_send(object, strong()), 0);
+    }
+    expect_function_calls(on_destroy, 3);
+    assert_int_equal(triggerfish_channel_destroy(object), 0);
+}
+
+static void check_capacity_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_capacity(NULL, (void *) 1),
+            TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_capacity_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_capacity((void *) 1, NULL),
+            TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL);
+}
+
+static void check_capacity(void **state) {
+    struct triggerfish_channel *object;
+    assert_int_equal(triggerfish_channel_of(3, &object), 0);
+    uintmax_t out;
+    assert_int_equal(triggerfish_channel_capacity(object, &out), 0);
+    assert_int_equal(out, 4);
+    assert_int_equal(triggerfish_channel_destroy(object), 0);
+}
+
+static void check_send_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_send(NULL, (void *) 1),
+            TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_send_error_on_strong_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_send((void *) 1, NULL),
+            TRIGGERFISH_CHANNEL_ERROR_STRONG_IS_NULL);
+}
+
+static void check_send_error_on_channel_is_full(void **state) {
+    struct triggerfish_channel *object;
+    assert_int_equal(triggerfish_channel_of(1, &object), 0);
+    assert_int_equal(object->mask, 1);
+    assert_int_equal(triggerfish_channel_send(object, strong()), 0);
+    assert_int_equal(triggerfish_channel_send(object, strong()), 0);
+    struct triggerfish_strong *b = strong();
+    assert_int_equal(
+            triggerfish_channel_send(object, b),
+            TRIGGERFISH_CHANNEL_ERROR_CHANNEL_IS_FULL);
+    expect_function_calls(on_destroy, 3);
+    assert_int_equal(triggerfish_strong_release(b), 0);
+    assert_int_equal(triggerfish_channel_destroy(object), 0);
+}
+
+static void check_send(void **state) {
+    struct triggerfish_channel *object;
+    assert_int_equal(triggerfish_channel_of(2, &object), 0);
+    struct triggerfish_strong *a = strong();
+    assert_int_equal(triggerfish_channel_send(object, a), 0);
+    assert_int_equal(atomic_load(&object->enqueue), 1);
+    assert_ptr_equal(object->cells[0].strong, a);
+    assert_int_equal(atomic_load(&object->cells[0].sequence), 1);
+    /* ownership is handed over without touching the reference count */
+    assert_int_equal(atomic_load(&a->counter), 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_channel_destroy(object), 0);
+}
+
+static void check_send_batch_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_send_batch(NULL, (void *) 1, 1, (void *) 1),
+            TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_send_batch_error_on_items_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_send_batch((void *) 1, NULL, 1, (void *) 1),
+            TRIGGERFISH_CHANNEL_ERROR_ITEMS_IS_NULL);
+}
+
+static void check_send_batch_error_on_count_is_zero(void **state) {
+    assert_int_equal(
+            triggerfish_channel_send_batch((void *) 1, (void *) 1, 0,
+                                           (void *) 1),
+            TRIGGERFISH_CHANNEL_ERROR_COUNT_IS_ZERO);
+}
+
+static void check_send_batch_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_send_batch((void *) 1, (void *) 1, 1, NULL),
+            TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL);
+}
+
+static void check_send_batch(void **state) {
+    struct triggerfish_channel *object;
+    assert_int_equal(triggerfish_channel_of(4, &object), 0);
+    struct triggerfish_strong *items[6];
+    for (uintmax_t i = 0; i < 6; i++) {
+        items[i] = strong();
+    }
+    uintmax_t out;
+    assert_int_equal(triggerfish_channel_send_batch(
+            object, items, 3, &out), 0);
+    assert_int_equal(out, 3);
+    /* only the room that is left is claimed */
+    assert_int_equal(triggerfish_channel_send_batch(
+            object, items + 3, 3, &out), 0);
+    assert_int_equal(out, 1);
+    assert_int_equal(
+            triggerfish_channel_send_batch(object, items + 4, 2, &out),
+            TRIGGERFISH_CHANNEL_ERROR_CHANNEL_IS_FULL);
+    for (uintmax_t i = 0; i < 4; i++) {
+        assert_ptr_equal(object->cells[i].strong, items[i]);
+    }
+    expect_function_calls(on_destroy, 6);
+    assert_int_equal(triggerfish_strong_release(items[4]), 0);
+    assert_int_equal(triggerfish_strong_release(items[5]), 0);
+    assert_int_equal(triggerfish_channel_destroy(object), 0);
+}
+
+static void check_receive_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_receive(NULL, (void *) 1),
+            TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_receive_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_receive((void *) 1, NULL),
+            TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL);
+}
+
+static void check_receive_error_on_channel_is_empty(void **state) {
+    struct triggerfish_channel *object;
+    assert_int_equal(triggerfish_channel_of(1, &object), 0);
+    struct triggerfish_strong *out;
+    assert_int_equal(
+            triggerfish_channel_receive(object, &out),
+            TRIGGERFISH_CHANNEL_ERROR_CHANNEL_IS_EMPTY);
+    assert_int_equal(triggerfish_channel_destroy(object), 0);
+}
+
+static void check_receive(void **state) {
+    struct triggerfish_channel *object;
+    assert_int_equal(triggerfish_channel_of(2, &object), 0);
+    struct triggerfish_strong *a = strong();
+    struct triggerfish_strong *b = strong();
+    struct triggerfish_strong *out;
+    /* wrap around the ring a few times */
+    for (uintmax_t i = 0; i < 5; i++) {
+        assert_int_equal(triggerfish_channel_send(object, a), 0);
+        assert_int_equal(triggerfish_channel_send(object, b), 0);
+        assert_int_equal(triggerfish_channel_receive(object, &out), 0);
+        assert_ptr_equal(out, a);
+        assert_int_equal(triggerfish_channel_receive(object, &out), 0);
+        assert_ptr_equal(out, b);
+    }
+    assert_int_equal(atomic_load(&a->counter), 1);
+    assert_null(object->cells[0].strong);
+    assert_int_equal(atomic_load(&object->cells[0].sequence), 10);
+    expect_function_calls(on_destroy, 2);
+    assert_int_equal(triggerfish_strong_release(a), 0);
+    assert_int_equal(triggerfish_strong_release(b), 0);
+    assert_int_equal(triggerfish_channel_destroy(object), 0);
+}
+
+static void check_receive_batch_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_receive_batch(NULL, (void *) 1, 1,
+                                              (void *) 1),
+            TRIGGERFISH_CHANNEL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_receive_batch_error_on_items_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_receive_batch((void *) 1, NULL, 1,
+                                              (void *) 1),
+            TRIGGERFISH_CHANNEL_ERROR_ITEMS_IS_NULL);
+}
+
+static void check_receive_batch_error_on_count_is_zero(void **state) {
+    assert_int_equal(
+            triggerfish_channel_receive_batch((void *) 1, (void *) 1, 0,
+                                              (void *) 1),
+            TRIGGERFISH_CHANNEL_ERROR_COUNT_IS_ZERO);
+}
+
+static void check_receive_batch_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_channel_receive_batch((void *) 1, (void *) 1, 1,
+                                              NULL),
+            TRIGGERFISH_CHANNEL_ERROR_OUT_IS_NULL);
+}
+
+static void check_receive_batch(void **state) {
+    struct triggerfish_channel *object;
+    assert_int_equal(triggerfish_channel_of(4, &object), 0);
+    struct triggerfish_strong *items[3];
+    for (uintmax_t i = 0; i < 3; i++) {
+        items[i] = strong();
+    }
+    uintmax_t out;
+    assert_int_equal(triggerfish_channel_send_batch(
+            object, items, 3, &out), 0);
+    struct triggerfish_strong *received[4] = {};
+    assert_int_equal(triggerfish_channel_receive_batch(
+            object, received, 4, &out), 0);
+    assert_int_equal(out, 3);
+    for (uintmax_t i = 0; i < 3; i++) {
+        assert_ptr_equal(received[i], items[i]);
+    }
+    assert_int_equal(
+            triggerfish_channel_receive_batch(object, received, 4, &out),
+            TRIGGERFISH_CHANNEL_ERROR_CHANNEL_IS_EMPTY);
+    expect_function_calls(on_destroy, 3);
+    for (uintmax_t i = 0; i < 3; i++) {
+        assert_int_equal(triggerfish_strong_release(items[i]), 0);
+    }
+    assert_int_equal(triggerfish_channel_destroy(object), 0);
+}
+
+#define THREADS     4
+#define MESSAGES    10000
+
+static void ignore(void *instance) {
+}
+
+static void *produce(void *arg) {
+    struct triggerfish_channel *object = arg;
+    for (uintmax_t i = 0; i < MESSAGES; i++) {
+        struct triggerfish_strong *item;
+        assert_int_equal(triggerfish_strong_of(malloc(1), ignore, &item), 0);
+        while (triggerfish_channel_send(object, item)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *consume(void *arg) {
+    struct triggerfish_channel *object = arg;
+    struct triggerfish_strong *items[8];
+    uintmax_t received = 0;
+    while (received < MESSAGES) {
+        uintmax_t count;
+        if (triggerfish_channel_receive_batch(
+                object, items, 8 < MESSAGES - received
+                               ? 8 : MESSAGES - received, &count)) {
+            sched_yield();
+            continue;
+        }
+        for (uintmax_t i = 0; i < count; i++) {
+            assert_int_equal(triggerfish_strong_release(items[i]), 0);
+        }
+        received += count;
+    }
+    return NULL;
+}
+
+static void check_concurrent_send_and_receive(void **state) {
+    struct triggerfish_channel *object;
+    assert_int_equal(triggerfish_channel_of(16, &object), 0);
+    pthread_t producers[THREADS];
+    pthread_t consumers[THREADS];
+    for (uintmax_t i = 0; i < THREADS; i++) {
+        assert_int_equal(pthread_create(&producers[i], NULL, produce,
+                                        object), 0);
+        assert_int_equal(pthread_create(&consumers[i], NULL, consume,
+                                        object), 0);
+    }
+    for (uintmax_t i = 0; i < THREADS; i++) {
+        assert_int_equal(pthread_join(producers[i], NULL), 0);
+        assert_int_equal(pthread_join(consumers[i], NULL), 0);
+    }
+    assert_int_equal(atomic_load(&object->enqueue), THREADS * MESSAGES);
+    assert_int_equal(atomic_load(&object->dequeue), THREADS * MESSAGES);
+    assert_int_equal(triggerfish_channel_destroy(object), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_capacity_is_zero),
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_capacity_is_too_large),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_destroy_error_on_object_is_null),
+            cmocka_unit_test(check_destroy),
+            cmocka_unit_test(check_capacity_error_on_object_is_null),
+            cmocka_unit_test(check_capacity_error_on_out_is_null),
+            cmocka_unit_test(check_capacity),
+            cmocka_unit_test(check_send_error_on_object_is_null),
+            cmocka_unit_test(check_send_error_on_strong_is_null),
+            cmocka_unit_test(check_send_error_on_channel_is_full),
+            cmocka_unit_test(check_send),
+            cmocka_unit_test(check_send_batch_error_on_object_is_null),
+            cmocka_unit_test(check_send_batch_error_on_items_is_null),
+            cmocka_unit_test(check_send_batch_error_on_count_is_zero),
+            cmocka_unit_test(check_send_batch_error_on_out_is_null),
+            cmocka_unit_test(check_send_batch),
+            cmocka_unit_test(check_receive_error_on_object_is_null),
+            cmocka_unit_test(check_receive_error_on_out_is_null),
+            cmocka_unit_test(check_receive_error_on_channel_is_empty),
+            cmocka_unit_test(check_receive),
+            cmocka_unit_test(check_receive_batch_error_on_object_is_null),
+            cmocka_unit_test(check_receive_batch_error_on_items_is_null),
+            cmocka_unit_test(check_receive_batch_error_on_count_is_zero),
+            cmocka_unit_test(check_receive_batch_error_on_out_is_null),
+            cmocka_unit_test(check_receive_batch),
+            cmocka_unit_test(check_concurrent_send_and_receive),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,396 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/heap.h"
+
+#include <test/cmocka.h>
+
+#define MANY    (3 * TRIGGERFISH_HEAP_CHUNK)
+/* edges of 17 bytes each, more than the initial buffer holds */
+#define FAN     (TRIGGERFISH_HEAP_BUFFER_SIZE / 17 + 1)
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static void on_destroy_leaf(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static void on_destroy_holder(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static void on_destroy_unused(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+struct holder {
+    struct triggerfish_strong *held[2];
+};
+
+static size_t size_of_leaf(const void *instance) {
+    return 24;
+}
+
+static size_t size_of_holder(const void *instance) {
+    return sizeof(struct holder);
+}
+
+static void traverse_holder(const void *instance,
+                            void (*visit)(const struct triggerfish_strong *,
+                                          void *),
+                            void *context) {
+    const struct holder *holder = instance;
+    visit(holder->held[0], context);
+    visit(holder->held[1], context);
+}
+
+struct dump {
+    unsigned char *data;
+    size_t size;
+    size_t at;
+};
+
+static uint64_t get(struct dump *dump, size_t size) {
+    assert_true(dump->size - dump->at >= size);
+    uint64_t value = 0;
+    for (size_t i = size; i; i--) {
+        value = value << 8 | dump->data[dump->at + i - 1];
+    }
+    dump->at += size;
+    return value;
+}
+
+static struct dump dump_of(void) {
+    char path[] = "/tmp/triggerfish-test-heap-XXXXXX";
+    const int fd = mkstemp(path);
+    assert_int_not_equal(fd, -1);
+    assert_int_equal(unlink(path), 0);
+    assert_int_equal(triggerfish_heap_dump(fd), 0);
+    struct stat stat;
+    assert_int_equal(fstat(fd, &stat), 0);
+    struct dump dump = {
+            .data = malloc(stat.st_size),
+            .size = stat.st_size
+    };
+    assert_non_null(dump.data);
+    assert_int_equal(pread(fd, dump.data, dump.size, 0), dump.size);
+    assert_int_equal(close(fd), 0);
+    assert_true(dump.size >= 5);
+    assert_memory_equal(dump.data, "TFHD", 4);
+    dump.at = 4;
+    assert_int_equal(get(&dump, 1), TRIGGERFISH_HEAP_VERSION);
+    return dump;
+}
+
+struct node {
+    uint64_t type;
+    uint64_t size;
+    uint64_t count;
+    uintmax_t edges;
+    uint64_t held[2];
+};
+
+/* walk the records and look up the node and type id of a name */
+static bool find(struct dump *dump,
+                 const struct triggerfish_strong *strong,
+                 struct node *node,
+                 const char *name,
+                 uint64_t *type,
+                 uintmax_t *nodes) {
+    bool found = false;
+    uint64_t last = 0;
+    *nodes = 0;
+    for (;;) {
+        switch (get(dump, 1)) {
+            default: {
+                assert_true(false);
+            }
+            case 'T': {
+                const uint64_t id = get(dump, 4);
+                const uint64_t length = get(dump, 2);
+                assert_true(dump->size - dump->at >= length);
+                if (name && strlen(name) == length
+                    && !memcmp(dump->data + dump->at, name, length)) {
+                    *type = id;
+                }
+                dump->at += length;
+                break;
+            }
+            case 'N': {
+                last = get(dump, 8);
+                const uint64_t id = get(dump, 4);
+                const uint64_t size = get(dump, 8);
+                const uint64_t count = get(dump, 8);
+                *nodes += 1;
+                if (last == (uintptr_t) strong) {
+                    assert_false(found);
+                    found = true;
+                    *node = (struct node) {id, size, count};
+                }
+                break;
+            }
+            case 'E': {
+                assert_int_equal(get(dump, 8), last);
+                const uint64_t held = get(dump, 8);
+                if (found && last == (uintptr_t) strong) {
+                    assert_true(node->edges < 2);
+                    node->held[node->edges++] = held;
+                }
+                break;
+            }
+            case 'Z': {
+                assert_int_equal(dump->at, dump->size);
+                free(dump->data);
+                return found;
+            }
+        }
+    }
+}
+
+static void check_register_error_on_on_destroy_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_heap_register(NULL, (void *) 1, NULL, NULL),
+            TRIGGERFISH_HEAP_ERROR_ON_DESTROY_IS_NULL);
+}
+
+static void check_register_error_on_name_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_heap_register(on_destroy, NULL, NULL, NULL),
+            TRIGGERFISH_HEAP_ERROR_NAME_IS_NULL);
+}
+
+static void check_register_error_on_name_is_too_large(void **state) {
+    char *name = malloc(TRIGGERFISH_HEAP_NAME_LENGTH_MAX + 2);
+    assert_non_null(name);
+    memset(name, 'a', TRIGGERFISH_HEAP_NAME_LENGTH_MAX + 1);
+    name[TRIGGERFISH_HEAP_NAME_LENGTH_MAX + 1] = 0;
+    assert_int_equal(
+            triggerfish_heap_register(on_destroy, name, NULL, NULL),
+            TRIGGERFISH_HEAP_ERROR_NAME_IS_TOO_LARGE);
+    free(name);
+}
+
+static void check_register_error_on_memory_allocation_failed(void **state) {
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_heap_register(on_destroy_unused, "unused", NULL, NULL),
+            TRIGGERFISH_HEAP_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+}
+
+static void check_register_error_on_type_already_registered(void **state) {
+    assert_int_equal(
+            triggerfish_heap_register(on_destroy, "plain", NULL, NULL), 0);
+    assert_int_equal(
+            triggerfish_heap_register(on_destroy, "again", NULL, NULL),
+            TRIGGERFISH_HEAP_ERROR_TYPE_ALREADY_REGISTERED);
+}
+
+static void check_register(void **state) {
+    assert_int_equal(
+            triggerfish_heap_register(on_destroy_leaf, "leaf", size_of_leaf,
+                                      NULL), 0);
+    assert_int_equal(
+            triggerfish_heap_register(on_destroy_holder, "holder",
+                                      size_of_holder, traverse_holder), 0);
+}
+
+#ifdef TRIGGERFISH_HEAP_DUMP
+static void check_dump_error_on_fd_is_invalid(void **state) {
+    assert_int_equal(
+            triggerfish_heap_dump(-1),
+            TRIGGERFISH_HEAP_ERROR_FD_IS_INVALID);
+    int fds[2];
+    assert_int_equal(pipe(fds), 0);
+    assert_int_equal(
+            triggerfish_heap_dump(fds[0]),
+            TRIGGERFISH_HEAP_ERROR_FD_IS_INVALID);
+    assert_int_equal(close(fds[0]), 0);
+    assert_int_equal(close(fds[1]), 0);
+}
+
+static void check_dump_error_on_memory_allocation_failed(void **state) {
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_heap_dump(STDOUT_FILENO),
+            TRIGGERFISH_HEAP_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+}
+
+static void check_dump(void **state) {
+    struct triggerfish_strong *leaf;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy_leaf, &leaf),
+                     0);
+    struct triggerfish_strong *plain;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &plain), 0);
+    struct holder *instance = malloc(sizeof(*instance));
+    assert_non_null(instance);
+    instance->held[0] = leaf;
+    instance->held[1] = NULL;
+    struct triggerfish_strong *holder;
+    assert_int_equal(triggerfish_strong_of(instance, on_destroy_holder,
+                                           &holder), 0);
+    assert_int_equal(triggerfish_strong_retain(leaf), 0);
+    struct dump dump = dump_of();
+    struct node node = {};
+    uint64_t type = 0;
+    uintmax_t nodes;
+    assert_true(find(&dump, holder, &node, "holder", &type, &nodes));
+    assert_int_not_equal(type, 0);
+    assert_int_equal(node.type, type);
+    assert_int_equal(node.size, sizeof(struct holder));
+    assert_int_equal(node.count, 1);
+    assert_int_equal(node.edges, 1);
+    assert_int_equal(node.held[0], (uintptr_t) leaf);
+    dump = dump_of();
+    node = (struct node) {};
+    assert_true(find(&dump, leaf, &node, "leaf", &type, &nodes));
+    assert_int_equal(node.type, type);
+    assert_int_equal(node.size, 24);
+    assert_int_equal(node.count, 2);
+    assert_int_equal(node.edges, 0);
+    dump = dump_of();
+    node = (struct node) {};
+    assert_true(find(&dump, plain, &node, "plain", &type, &nodes));
+    assert_int_equal(node.type, type);
+    assert_int_equal(node.size, 0);
+    assert_int_equal(node.count, 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(plain), 0);
+    dump = dump_of();
+    assert_false(find(&dump, plain, &node, NULL, &type, &nodes));
+    assert_int_equal(nodes, 2);
+    expect_function_call(on_destroy_holder);
+    assert_int_equal(triggerfish_strong_release(holder), 0);
+    expect_function_call(on_destroy_leaf);
+    assert_int_equal(triggerfish_strong_release(leaf), 0);
+    assert_int_equal(triggerfish_strong_release(leaf), 0);
+    dump = dump_of();
+    assert_false(find(&dump, leaf, &node, NULL, &type, &nodes));
+    assert_int_equal(nodes, 0);
+}
+
+static void check_dump_alias(void **state) {
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(2), on_destroy, &strong), 0);
+    struct triggerfish_strong *alias;
+    assert_int_equal(triggerfish_strong_alias_of(
+            strong, (char *) strong->instance + 1, &alias), 0);
+    struct dump dump = dump_of();
+    struct node node = {};
+    uint64_t type;
+    uintmax_t nodes;
+    /* the alias is counted on the node of its parent */
+    assert_true(find(&dump, strong, &node, NULL, &type, &nodes));
+    assert_int_equal(nodes, 1);
+    assert_int_equal(node.count, 2);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(alias), 0);
+}
+
+static void check_dump_in_chunks(void **state) {
+    struct triggerfish_strong *strong[MANY];
+    for (uintmax_t i = 0; i < MANY; i++) {
+        assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy,
+                                               &strong[i]), 0);
+    }
+    struct dump dump = dump_of();
+    struct node node = {};
+    uint64_t type;
+    uintmax_t nodes;
+    assert_true(find(&dump, strong[0], &node, NULL, &type, &nodes));
+    assert_int_equal(nodes, MANY);
+    for (uintmax_t i = 0; i < MANY; i++) {
+        expect_function_call(on_destroy);
+        assert_int_equal(triggerfish_strong_release(strong[i]), 0);
+    }
+}
+
+static void on_destroy_fan(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static void traverse_fan(const void *instance,
+                         void (*visit)(const struct triggerfish_strong *,
+                                       void *),
+                         void *context) {
+    struct triggerfish_strong *const *held = instance;
+    for (uintmax_t i = 0; i < FAN; i++) {
+        visit(*held, context);
+    }
+}
+
+static void check_dump_grows_buffer(void **state) {
+    assert_int_equal(
+            triggerfish_heap_register(on_destroy_fan, "fan", NULL,
+                                      traverse_fan), 0);
+    struct triggerfish_strong *leaf;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy_leaf, &leaf),
+                     0);
+    struct triggerfish_strong **instance = malloc(sizeof(*instance));
+    assert_non_null(instance);
+    *instance = leaf;
+    struct triggerfish_strong *fan;
+    assert_int_equal(triggerfish_strong_of(instance, on_destroy_fan, &fan), 0);
+    struct dump dump = dump_of();
+    struct node node = {};
+    uint64_t type;
+    uintmax_t nodes;
+    assert_true(find(&dump, leaf, &node, NULL, &type, &nodes));
+    assert_int_equal(nodes, 2);
+    expect_function_call(on_destroy_fan);
+    assert_int_equal(triggerfish_strong_release(fan), 0);
+    expect_function_call(on_destroy_leaf);
+    assert_int_equal(triggerfish_strong_release(leaf), 0);
+}
+#else
+static void check_dump_error_on_heap_is_not_tracked(void **state) {
+    assert_int_equal(
+            triggerfish_heap_dump(STDOUT_FILENO),
+            TRIGGERFISH_HEAP_ERROR_HEAP_IS_NOT_TRACKED);
+}
+#endif
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_register_error_on_on_destroy_is_null),
+            cmocka_unit_test(check_register_error_on_name_is_null),
+            cmocka_unit_test(check_register_error_on_name_is_too_large),
+            cmocka_unit_test(check_register_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_register_error_on_type_already_registered),
+            cmocka_unit_test(check_register),
+#ifdef TRIGGERFISH_HEAP_DUMP
+            cmocka_unit_test(check_dump_error_on_fd_is_invalid),
+            cmocka_unit_test(check_dump_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_dump),
+            cmocka_unit_test(check_dump_alias),
+            cmocka_unit_test(check_dump_in_chunks),
+            cmocka_unit_test(check_dump_grows_buffer),
+#else
+            cmocka_unit_test(check_dump_error_on_heap_is_not_tracked),
+#endif
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
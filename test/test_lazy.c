@@ -0,0 +1,248 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/lazy.h"
+
+#include <test/cmocka.h>
+
+#define WORKERS     4
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static atomic_uintmax_t created;
+static atomic_uintmax_t destroyed;
+
+static void on_destroy_counted(void *instance) {
+    assert_non_null(instance);
+    atomic_fetch_add(&destroyed, 1);
+}
+
+static int factory(void *context, struct triggerfish_strong **out) {
+    function_called();
+    assert_ptr_equal(context, (void *) 1);
+    return triggerfish_strong_of(malloc(1), on_destroy, out);
+}
+
+static int factory_failing(void *context, struct triggerfish_strong **out) {
+    function_called();
+    return SEA_URCHIN_ERROR_VALUE_IS_INVALID;
+}
+
+static int factory_slowly(void *context, struct triggerfish_strong **out) {
+    atomic_fetch_add(&created, 1);
+    const struct timespec delay = {.tv_nsec = 10000000};
+    nanosleep(&delay, NULL);
+    return triggerfish_strong_of(malloc(1), on_destroy_counted, out);
+}
+
+static void check_of_error_on_factory_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_lazy_of(NULL, NULL, (void *) 1),
+            TRIGGERFISH_LAZY_ERROR_FACTORY_IS_NULL);
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_lazy_of(factory, NULL, NULL),
+            TRIGGERFISH_LAZY_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_lazy *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_lazy_of(factory, NULL, &out),
+            TRIGGERFISH_LAZY_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+}
+
+static void check_of(void **state) {
+    struct triggerfish_lazy *object;
+    assert_int_equal(triggerfish_lazy_of(factory, (void *) 1, &object), 0);
+    assert_ptr_equal(object->factory, factory);
+    assert_ptr_equal(object->context, (void *) 1);
+    assert_null(object->strong);
+    assert_int_equal(atomic_load(&object->state), TRIGGERFISH_LAZY_EMPTY);
+    assert_int_equal(triggerfish_lazy_destroy(object), 0);
+}
+
+static void check_destroy_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_lazy_destroy(NULL),
+            TRIGGERFISH_LAZY_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_get_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_lazy_get(NULL, (void *) 1),
+            TRIGGERFISH_LAZY_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_get_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_lazy_get((void *) 1, NULL),
+            TRIGGERFISH_LAZY_ERROR_OUT_IS_NULL);
+}
+
+static void check_get_error_on_factory_failed(void **state) {
+    struct triggerfish_lazy *object;
+    assert_int_equal(triggerfish_lazy_of(factory_failing, NULL, &object), 0);
+    struct triggerfish_strong *out;
+    expect_function_call(factory_failing);
+    assert_int_equal(
+            triggerfish_lazy_get(object, &out),
+            SEA_URCHIN_ERROR_VALUE_IS_INVALID);
+    assert_int_equal(atomic_load(&object->state), TRIGGERFISH_LAZY_EMPTY);
+    expect_function_call(factory_failing);
+    assert_int_equal(
+            triggerfish_lazy_get(object, &out),
+            SEA_URCHIN_ERROR_VALUE_IS_INVALID);
+    assert_int_equal(triggerfish_lazy_destroy(object), 0);
+}
+
+static void check_get(void **state) {
+    struct triggerfish_lazy *object;
+    assert_int_equal(triggerfish_lazy_of(factory, (void *) 1, &object), 0);
+    struct triggerfish_strong *out;
+    expect_function_call(factory);
+    assert_int_equal(triggerfish_lazy_get(object, &out), 0);
+    assert_ptr_equal(object->strong, out);
+    assert_int_equal(atomic_load(&object->state), TRIGGERFISH_LAZY_READY);
+    assert_int_equal(atomic_load(&out->counter), 2);
+    struct triggerfish_strong *other;
+    assert_int_equal(triggerfish_lazy_get(object, &other), 0);
+    assert_ptr_equal(other, out);
+    assert_int_equal(atomic_load(&out->counter), 3);
+    assert_int_equal(atomic_load(&object->state), TRIGGERFISH_LAZY_READY);
+    assert_int_equal(triggerfish_strong_release(other), 0);
+    assert_int_equal(triggerfish_strong_release(out), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_lazy_destroy(object), 0);
+}
+
+static void *get(void *object) {
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_lazy_get(object, &out), 0);
+    return out;
+}
+
+static void check_get_concurrently(void **state) {
+    atomic_store(&created, 0);
+    atomic_store(&destroyed, 0);
+    struct triggerfish_lazy *object;
+    assert_int_equal(triggerfish_lazy_of(factory_slowly, NULL, &object), 0);
+    pthread_t threads[WORKERS];
+    for (uintmax_t i = 0; i < WORKERS; i++) {
+        assert_int_equal(pthread_create(&threads[i], NULL, get, object), 0);
+    }
+    for (uintmax_t i = 0; i < WORKERS; i++) {
+        struct triggerfish_strong *out;
+        assert_int_equal(pthread_join(threads[i], (void **) &out), 0);
+        assert_ptr_equal(out, object->strong);
+        assert_int_equal(triggerfish_strong_release(out), 0);
+    }
+    assert_int_equal(atomic_load(&created), 1);
+    assert_int_equal(triggerfish_lazy_destroy(object), 0);
+    assert_int_equal(atomic_load(&destroyed), 1);
+}
+
+static void check_reset_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_lazy_reset(NULL),
+            TRIGGERFISH_LAZY_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_reset(void **state) {
+    struct triggerfish_lazy *object;
+    assert_int_equal(triggerfish_lazy_of(factory, (void *) 1, &object), 0);
+    assert_int_equal(triggerfish_lazy_reset(object), 0);
+    struct triggerfish_strong *out;
+    expect_function_call(factory);
+    assert_int_equal(triggerfish_lazy_get(object, &out), 0);
+    assert_int_equal(triggerfish_lazy_reset(object), 0);
+    assert_null(object->strong);
+    assert_int_equal(atomic_load(&object->state), TRIGGERFISH_LAZY_EMPTY);
+    /* handed out strong references keep the instance alive */
+    assert_int_equal(atomic_load(&out->counter), 1);
+    struct triggerfish_strong *other;
+    expect_function_call(factory);
+    assert_int_equal(triggerfish_lazy_get(object, &other), 0);
+    assert_ptr_not_equal(other, out);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(out), 0);
+    assert_int_equal(triggerfish_strong_release(other), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_lazy_destroy(object), 0);
+}
+
+static atomic_bool stop;
+
+static void *get_repeatedly(void *object) {
+    while (!atomic_load(&stop)) {
+        struct triggerfish_strong *out;
+        assert_int_equal(triggerfish_lazy_get(object, &out), 0);
+        void *instance;
+        assert_int_equal(triggerfish_strong_instance(out, &instance), 0);
+        assert_non_null(instance);
+        assert_int_equal(triggerfish_strong_release(out), 0);
+    }
+    return NULL;
+}
+
+static void check_reset_concurrently(void **state) {
+    atomic_store(&created, 0);
+    atomic_store(&destroyed, 0);
+    atomic_store(&stop, false);
+    struct triggerfish_lazy *object;
+    assert_int_equal(triggerfish_lazy_of(factory_slowly, NULL, &object), 0);
+    pthread_t threads[WORKERS];
+    for (uintmax_t i = 0; i < WORKERS; i++) {
+        assert_int_equal(pthread_create(&threads[i], NULL, get_repeatedly,
+                                        object), 0);
+    }
+    for (uintmax_t i = 0; i < 20; i++) {
+        const struct timespec delay = {.tv_nsec = 1000000};
+        nanosleep(&delay, NULL);
+        assert_int_equal(triggerfish_lazy_reset(object), 0);
+    }
+    atomic_store(&stop, true);
+    for (uintmax_t i = 0; i < WORKERS; i++) {
+        assert_int_equal(pthread_join(threads[i], NULL), 0);
+    }
+    assert_int_equal(triggerfish_lazy_reset(object), 0);
+    assert_int_equal(atomic_load(&created), atomic_load(&destroyed));
+    assert_int_equal(triggerfish_lazy_destroy(object), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_factory_is_null),
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_destroy_error_on_object_is_null),
+            cmocka_unit_test(check_get_error_on_object_is_null),
+            cmocka_unit_test(check_get_error_on_out_is_null),
+            cmocka_unit_test(check_get_error_on_factory_failed),
+            cmocka_unit_test(check_get),
+            cmocka_unit_test(check_get_concurrently),
+            cmocka_unit_test(check_reset_error_on_object_is_null),
+            cmocka_unit_test(check_reset),
+            cmocka_unit_test(check_reset_concurrently),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
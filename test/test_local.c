@@ -0,0 +1,227 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+#include <errno.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/local.h"
+
+#include <test/cmocka.h>
+
+static void check_of_error_on_instance_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_local_of(NULL, (void *) 1, (void *) 1),
+            TRIGGERFISH_LOCAL_ERROR_INSTANCE_IS_NULL);
+}
+
+static void check_of_error_on_on_destroy_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_local_of((void *) 1, NULL, (void *) 1),
+            TRIGGERFISH_LOCAL_ERROR_ON_DESTROY_IS_NULL);
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_local_of((void *) 1, (void *) 1, NULL),
+            TRIGGERFISH_LOCAL_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_local *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_local_of((void *) 1, (void *) 1, &out),
+            TRIGGERFISH_LOCAL_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+}
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static void check_of(void **state) {
+    void *instance = malloc(1);
+    struct triggerfish_local *object;
+    assert_int_equal(triggerfish_local_of(instance, on_destroy, &object), 0);
+    assert_non_null(object);
+    assert_ptr_equal(object->instance, instance);
+    assert_ptr_equal(object->on_destroy, on_destroy);
+    assert_null(object->strong);
+    assert_int_equal(object->counter, 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_local_release(object), 0);
+}
+
+static void check_count_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_local_count(NULL, (void *) 1),
+            TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_count_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_local_count((void *) 1, NULL),
+            TRIGGERFISH_LOCAL_ERROR_OUT_IS_NULL);
+}
+
+static void check_count(void **state) {
+    srand(time(NULL));
+    struct triggerfish_local object = {
+            .counter = rand() % UINTMAX_MAX
+    };
+    uintmax_t out;
+    assert_int_equal(triggerfish_local_count(&object, &out), 0);
+    assert_int_equal(out, object.counter);
+}
+
+static void check_retain_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_local_retain(NULL),
+            TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_retain_error_on_object_is_invalid(void **state) {
+    struct triggerfish_local object = {};
+    assert_int_equal(
+            triggerfish_local_retain(&object),
+            TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_INVALID);
+}
+
+static void check_retain(void **state) {
+    struct triggerfish_local *object;
+    assert_int_equal(triggerfish_local_of(malloc(1), on_destroy, &object), 0);
+    assert_int_equal(triggerfish_local_retain(object), 0);
+    assert_int_equal(object->counter, 2);
+    assert_int_equal(triggerfish_local_release(object), 0);
+    assert_int_equal(object->counter, 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_local_release(object), 0);
+}
+
+static void check_release_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_local_release(NULL),
+            TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_instance_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_local_instance(NULL, (void *) 1),
+            TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_instance_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_local_instance((void *) 1, NULL),
+            TRIGGERFISH_LOCAL_ERROR_OUT_IS_NULL);
+}
+
+static void check_instance_error_on_object_is_invalid(void **state) {
+    struct triggerfish_local object = {};
+    void *out;
+    assert_int_equal(
+            triggerfish_local_instance(&object, &out),
+            TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_INVALID);
+}
+
+static void check_instance(void **state) {
+    void *instance = malloc(1);
+    struct triggerfish_local *object;
+    assert_int_equal(triggerfish_local_of(instance, on_destroy, &object), 0);
+    void *out;
+    assert_int_equal(triggerfish_local_instance(object, &out), 0);
+    assert_ptr_equal(out, instance);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_local_release(object), 0);
+}
+
+static void check_strong_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_local_strong(NULL, (void *) 1),
+            TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_strong_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_local_strong((void *) 1, NULL),
+            TRIGGERFISH_LOCAL_ERROR_OUT_IS_NULL);
+}
+
+static void check_strong_error_on_object_is_invalid(void **state) {
+    struct triggerfish_local object = {};
+    struct triggerfish_strong *out;
+    assert_int_equal(
+            triggerfish_local_strong(&object, &out),
+            TRIGGERFISH_LOCAL_ERROR_OBJECT_IS_INVALID);
+}
+
+static void check_strong_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_local *object;
+    assert_int_equal(triggerfish_local_of(malloc(1), on_destroy, &object), 0);
+    struct triggerfish_strong *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_local_strong(object, &out),
+            TRIGGERFISH_LOCAL_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+    assert_null(object->strong);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_local_release(object), 0);
+}
+
+static void check_strong(void **state) {
+    void *instance = malloc(1);
+    struct triggerfish_local *object;
+    assert_int_equal(triggerfish_local_of(instance, on_destroy, &object), 0);
+    struct triggerfish_strong *a;
+    assert_int_equal(triggerfish_local_strong(object, &a), 0);
+    assert_ptr_equal(object->strong, a);
+    assert_ptr_equal(a->instance, instance);
+    assert_int_equal(atomic_load(&a->counter), 2);
+    struct triggerfish_strong *b;
+    assert_int_equal(triggerfish_local_strong(object, &b), 0);
+    assert_ptr_equal(a, b);
+    assert_int_equal(atomic_load(&a->counter), 3);
+    assert_int_equal(triggerfish_strong_release(a), 0);
+    assert_int_equal(triggerfish_local_release(object), 0);
+    assert_int_equal(atomic_load(&b->counter), 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(b), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_instance_is_null),
+            cmocka_unit_test(check_of_error_on_on_destroy_is_null),
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_count_error_on_object_is_null),
+            cmocka_unit_test(check_count_error_on_out_is_null),
+            cmocka_unit_test(check_count),
+            cmocka_unit_test(check_retain_error_on_object_is_null),
+            cmocka_unit_test(check_retain_error_on_object_is_invalid),
+            cmocka_unit_test(check_retain),
+            cmocka_unit_test(check_release_error_on_object_is_null),
+            cmocka_unit_test(check_instance_error_on_object_is_null),
+            cmocka_unit_test(check_instance_error_on_out_is_null),
+            cmocka_unit_test(check_instance_error_on_object_is_invalid),
+            cmocka_unit_test(check_instance),
+            cmocka_unit_test(check_strong_error_on_object_is_null),
+            cmocka_unit_test(check_strong_error_on_out_is_null),
+            cmocka_unit_test(check_strong_error_on_object_is_invalid),
+            cmocka_unit_test(check_strong_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_strong),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
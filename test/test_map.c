@@ -0,0 +1,452 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+#include <errno.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/map.h"
+
+#include <test/cmocka.h>
+
+static uintmax_t hash(const void *instance) {
+    return *(const uintmax_t *) instance;
+}
+
+static uintmax_t collide(const void *instance) {
+    return 42;
+}
+
+static int compare(const void *first, const void *second) {
+    const uintmax_t a = *(const uintmax_t *) first;
+    const uintmax_t b = *(const uintmax_t *) second;
+    return a < b ? -1 : a > b;
+}
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static void ignore(void *instance) {
+}
+
+static struct triggerfish_strong *number(const uintmax_t value) {
+    uintmax_t *instance = malloc(sizeof(*instance));
+    assert_non_null(instance);
+    *instance = value;
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_strong_of(instance, ignore, &out), 0);
+    return out;
+}
+
+static void put(struct triggerfish_map *object,
+                const uintmax_t key,
+                const uintmax_t value) {
+    struct triggerfish_strong *k = number(key);
+    struct triggerfish_strong *v = number(value);
+    assert_int_equal(triggerfish_map_put(object, k, v), 0);
+    assert_int_equal(triggerfish_strong_release(k), 0);
+    assert_int_equal(triggerfish_strong_release(v), 0);
+}
+
+static uintmax_t value_of(const struct triggerfish_map *object,
+                          const uintmax_t key) {
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_map_get(object, &key, &strong), 0);
+    void *instance;
+    assert_int_equal(triggerfish_strong_instance(strong, &instance), 0);
+    const uintmax_t value = *(uintmax_t *) instance;
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    return value;
+}
+
+static void check_of_error_on_hash_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_of(NULL, (void *) 1, (void *) 1),
+            TRIGGERFISH_MAP_ERROR_HASH_IS_NULL);
+}
+
+static void check_of_error_on_compare_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_of((void *) 1, NULL, (void *) 1),
+            TRIGGERFISH_MAP_ERROR_COMPARE_IS_NULL);
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_of((void *) 1, (void *) 1, NULL),
+            TRIGGERFISH_MAP_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_map *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_map_of(hash, compare, &out),
+            TRIGGERFISH_MAP_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+}
+
+static void check_of(void **state) {
+    struct triggerfish_map *object;
+    assert_int_equal(triggerfish_map_of(hash, compare, &object), 0);
+    assert_non_null(object);
+    assert_int_equal(object->count, 0);
+    assert_null(object->root);
+    assert_ptr_equal(object->hash, hash);
+    assert_ptr_equal(object->compare, compare);
+    assert_int_equal(triggerfish_map_destroy(object), 0);
+}
+
+static void check_destroy_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_destroy(NULL),
+            TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_destroy(void **state) {
+    struct triggerfish_map *object;
+    assert_int_equal(triggerfish_map_of(hash, compare, &object), 0);
+    for (uintmax_t i = 0; i < 40; i++) {
+        struct triggerfish_strong *key = number(i);
+        struct triggerfish_strong *value;
+        assert_int_equal(triggerfish_strong_of(
+                malloc(1), on_destroy, &value), 0);
+        assert_int_equal(triggerfish_map_put(object, key, value), 0);
+        assert_int_equal(triggerfish_strong_release(key), 0);
+        assert_int_equal(triggerfish_strong_release(value), 0);
+    }
+    expect_function_calls(on_destroy, 40);
+    assert_int_equal(triggerfish_map_destroy(object), 0);
+}
+
+static void check_copy_of_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_copy_of(NULL, (void *) 1),
+            TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_copy_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_copy_of((void *) 1, NULL),
+            TRIGGERFISH_MAP_ERROR_OUT_IS_NULL);
+}
+
+static void check_copy_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_map object = {};
+    struct triggerfish_map *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_map_copy_of(&object, &out),
+            TRIGGERFISH_MAP_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+}
+
+static void check_copy_of(void **state) {
+    struct triggerfish_map *object;
+    assert_int_equal(triggerfish_map_of(hash, compare, &object), 0);
+    for (uintmax_t i = 0; i < 100; i++) {
+        put(object, i, 2 * i);
+    }
+    struct triggerfish_map *copy;
+    assert_int_equal(triggerfish_map_copy_of(object, &copy), 0);
+    assert_ptr_equal(copy->root, object->root);
+    assert_int_equal(copy->count, 100);
+    assert_int_equal(atomic_load(&object->root->counter), 2);
+    assert_int_equal(triggerfish_map_destroy(object), 0);
+    for (uintmax_t i = 0; i < 100; i++) {
+        assert_int_equal(value_of(copy, i), 2 * i);
+    }
+    assert_int_equal(triggerfish_map_destroy(copy), 0);
+}
+
+static void check_count_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_count(NULL, (void *) 1),
+            TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_count_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_count((void *) 1, NULL),
+            TRIGGERFISH_MAP_ERROR_OUT_IS_NULL);
+}
+
+static void check_count(void **state) {
+    srand(time(NULL));
+    struct triggerfish_map object = {
+            .count = rand() % UINTMAX_MAX
+    };
+    uintmax_t out;
+    assert_int_equal(triggerfish_map_count(&object, &out), 0);
+    assert_int_equal(out, object.count);
+}
+
+static void check_put_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_put(NULL, (void *) 1, (void *) 1),
+            TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_put_error_on_key_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_put((void *) 1, NULL, (void *) 1),
+            TRIGGERFISH_MAP_ERROR_KEY_IS_NULL);
+}
+
+static void check_put_error_on_value_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_put((void *) 1, (void *) 1, NULL),
+            TRIGGERFISH_MAP_ERROR_VALUE_IS_NULL);
+}
+
+static void check_put_error_on_key_is_invalid(void **state) {
+    struct triggerfish_map object = {};
+    struct triggerfish_strong key = {};
+    assert_int_equal(
+            triggerfish_map_put(&object, &key, (void *) 1),
+            TRIGGERFISH_MAP_ERROR_KEY_IS_INVALID);
+}
+
+static void check_put_error_on_value_is_invalid(void **state) {
+    struct triggerfish_map object = {};
+    struct triggerfish_strong *key = number(1);
+    struct triggerfish_strong value = {};
+    assert_int_equal(
+            triggerfish_map_put(&object, key, &value),
+            TRIGGERFISH_MAP_ERROR_VALUE_IS_INVALID);
+    assert_int_equal(atomic_load(&key->counter), 1);
+    assert_int_equal(triggerfish_strong_release(key), 0);
+}
+
+static void check_put_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_map *object;
+    assert_int_equal(triggerfish_map_of(hash, compare, &object), 0);
+    struct triggerfish_strong *key = number(1);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_map_put(object, key, key),
+            TRIGGERFISH_MAP_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+    assert_int_equal(object->count, 0);
+    assert_int_equal(atomic_load(&key->counter), 1);
+    assert_int_equal(triggerfish_strong_release(key), 0);
+    assert_int_equal(triggerfish_map_destroy(object), 0);
+}
+
+static void check_put(void **state) {
+    struct triggerfish_map *object;
+    assert_int_equal(triggerfish_map_of(hash, compare, &object), 0);
+    for (uintmax_t i = 0; i < 1000; i++) {
+        put(object, i * 7919, i);
+    }
+    assert_int_equal(object->count, 1000);
+    for (uintmax_t i = 0; i < 1000; i++) {
+        assert_int_equal(value_of(object, i * 7919), i);
+    }
+    /* an equal key only replaces the value */
+    const struct triggerfish_strong *root = object->root;
+    put(object, 0, 1000);
+    assert_int_equal(object->count, 1000);
+    assert_int_equal(value_of(object, 0), 1000);
+    assert_ptr_equal(object->root, root);
+    assert_int_equal(triggerfish_map_destroy(object), 0);
+}
+
+static void check_put_shares_nodes(void **state) {
+    struct triggerfish_map *a;
+    assert_int_equal(triggerfish_map_of(hash, compare, &a), 0);
+    for (uintmax_t i = 0; i < 1024; i++) {
+        put(a, i, i);
+    }
+    struct triggerfish_map *b;
+    assert_int_equal(triggerfish_map_copy_of(a, &b), 0);
+    put(b, 0, 1);
+    assert_int_equal(value_of(a, 0), 0);
+    assert_int_equal(value_of(b, 0), 1);
+    /* only the path to the entry was copied */
+    const struct triggerfish_map_node *root_a = a->root->instance;
+    const struct triggerfish_map_node *root_b = b->root->instance;
+    assert_ptr_not_equal(root_a, root_b);
+    assert_ptr_not_equal(root_a->slots[0].value, root_b->slots[0].value);
+    for (uint32_t i = 1; i < root_a->count; i++) {
+        assert_ptr_equal(root_a->slots[i].value, root_b->slots[i].value);
+    }
+    assert_int_equal(triggerfish_map_destroy(a), 0);
+    assert_int_equal(triggerfish_map_destroy(b), 0);
+}
+
+static void check_put_on_hash_collision(void **state) {
+    struct triggerfish_map *object;
+    assert_int_equal(triggerfish_map_of(collide, compare, &object), 0);
+    for (uintmax_t i = 0; i < 10; i++) {
+        put(object, i, i);
+    }
+    put(object, 3, 30);
+    assert_int_equal(object->count, 10);
+    for (uintmax_t i = 0; i < 10; i++) {
+        assert_int_equal(value_of(object, i), 3 == i ? 30 : i);
+    }
+    for (uintmax_t i = 0; i < 9; i++) {
+        assert_int_equal(triggerfish_map_remove(object, &i), 0);
+    }
+    /* the last entry is pulled up to the root */
+    const struct triggerfish_map_node *root = object->root->instance;
+    assert_int_equal(root->count, 1);
+    assert_non_null(root->slots[0].key);
+    assert_int_equal(value_of(object, 9), 9);
+    assert_int_equal(triggerfish_map_destroy(object), 0);
+}
+
+static void check_remove_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_remove(NULL, (void *) 1),
+            TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_remove_error_on_key_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_remove((void *) 1, NULL),
+            TRIGGERFISH_MAP_ERROR_KEY_IS_NULL);
+}
+
+static void check_remove_error_on_key_not_found(void **state) {
+    struct triggerfish_map *object;
+    assert_int_equal(triggerfish_map_of(hash, compare, &object), 0);
+    const uintmax_t key = 1;
+    assert_int_equal(
+            triggerfish_map_remove(object, &key),
+            TRIGGERFISH_MAP_ERROR_KEY_NOT_FOUND);
+    put(object, 33, 0);
+    assert_int_equal(
+            triggerfish_map_remove(object, &key),
+            TRIGGERFISH_MAP_ERROR_KEY_NOT_FOUND);
+    assert_int_equal(triggerfish_map_destroy(object), 0);
+}
+
+static void check_remove(void **state) {
+    struct triggerfish_map *object;
+    assert_int_equal(triggerfish_map_of(hash, compare, &object), 0);
+    for (uintmax_t i = 0; i < 1000; i++) {
+        put(object, i, i);
+    }
+    struct triggerfish_map *copy;
+    assert_int_equal(triggerfish_map_copy_of(object, &copy), 0);
+    for (uintmax_t i = 0; i < 1000; i += 2) {
+        assert_int_equal(triggerfish_map_remove(object, &i), 0);
+    }
+    assert_int_equal(object->count, 500);
+    struct triggerfish_strong *out;
+    for (uintmax_t i = 0; i < 1000; i++) {
+        if (i % 2) {
+            assert_int_equal(value_of(object, i), i);
+        } else {
+            assert_int_equal(
+                    triggerfish_map_get(object, &i, &out),
+                    TRIGGERFISH_MAP_ERROR_KEY_NOT_FOUND);
+        }
+        assert_int_equal(value_of(copy, i), i);
+    }
+    for (uintmax_t i = 1; i < 1000; i += 2) {
+        assert_int_equal(triggerfish_map_remove(object, &i), 0);
+    }
+    assert_int_equal(object->count, 0);
+    assert_null(object->root);
+    assert_int_equal(triggerfish_map_destroy(object), 0);
+    assert_int_equal(triggerfish_map_destroy(copy), 0);
+}
+
+static void check_get_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_get(NULL, (void *) 1, (void *) 1),
+            TRIGGERFISH_MAP_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_get_error_on_key_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_get((void *) 1, NULL, (void *) 1),
+            TRIGGERFISH_MAP_ERROR_KEY_IS_NULL);
+}
+
+static void check_get_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_map_get((void *) 1, (void *) 1, NULL),
+            TRIGGERFISH_MAP_ERROR_OUT_IS_NULL);
+}
+
+static void check_get_error_on_key_not_found(void **state) {
+    struct triggerfish_map *object;
+    assert_int_equal(triggerfish_map_of(hash, compare, &object), 0);
+    const uintmax_t key = 1;
+    struct triggerfish_strong *out;
+    assert_int_equal(
+            triggerfish_map_get(object, &key, &out),
+            TRIGGERFISH_MAP_ERROR_KEY_NOT_FOUND);
+    assert_int_equal(triggerfish_map_destroy(object), 0);
+}
+
+static void check_get(void **state) {
+    struct triggerfish_map *object;
+    assert_int_equal(triggerfish_map_of(hash, compare, &object), 0);
+    struct triggerfish_strong *key = number(1);
+    struct triggerfish_strong *value = number(2);
+    assert_int_equal(triggerfish_map_put(object, key, value), 0);
+    const uintmax_t k = 1;
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_map_get(object, &k, &out), 0);
+    assert_ptr_equal(out, value);
+    assert_int_equal(atomic_load(&value->counter), 3);
+    assert_int_equal(triggerfish_strong_release(out), 0);
+    assert_int_equal(triggerfish_strong_release(key), 0);
+    assert_int_equal(triggerfish_strong_release(value), 0);
+    assert_int_equal(triggerfish_map_destroy(object), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_hash_is_null),
+            cmocka_unit_test(check_of_error_on_compare_is_null),
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_destroy_error_on_object_is_null),
+            cmocka_unit_test(check_destroy),
+            cmocka_unit_test(check_copy_of_error_on_object_is_null),
+            cmocka_unit_test(check_copy_of_error_on_out_is_null),
+            cmocka_unit_test(check_copy_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_copy_of),
+            cmocka_unit_test(check_count_error_on_object_is_null),
+            cmocka_unit_test(check_count_error_on_out_is_null),
+            cmocka_unit_test(check_count),
+            cmocka_unit_test(check_put_error_on_object_is_null),
+            cmocka_unit_test(check_put_error_on_key_is_null),
+            cmocka_unit_test(check_put_error_on_value_is_null),
+            cmocka_unit_test(check_put_error_on_key_is_invalid),
+            cmocka_unit_test(check_put_error_on_value_is_invalid),
+            cmocka_unit_test(check_put_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_put),
+            cmocka_unit_test(check_put_shares_nodes),
+            cmocka_unit_test(check_put_on_hash_collision),
+            cmocka_unit_test(check_remove_error_on_object_is_null),
+            cmocka_unit_test(check_remove_error_on_key_is_null),
+            cmocka_unit_test(check_remove_error_on_key_not_found),
+            cmocka_unit_test(check_remove),
+            cmocka_unit_test(check_get_error_on_object_is_null),
+            cmocka_unit_test(check_get_error_on_key_is_null),
+            cmocka_unit_test(check_get_error_on_out_is_null),
+            cmocka_unit_test(check_get_error_on_key_not_found),
+            cmocka_unit_test(check_get),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
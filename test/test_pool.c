@@ -0,0 +1,257 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <errno.h>
+#include <string.h>
+#include <pthread.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/pool.h"
+
+#include <test/cmocka.h>
+
+#define WORKERS     4
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static void on_destroy_quietly(void *instance) {
+    assert_non_null(instance);
+}
+
+static void reset(void *instance) {
+    assert_non_null(instance);
+    function_called();
+    memset(instance, 0xaa, sizeof(uintmax_t));
+}
+
+static void check_of_error_on_size_is_zero(void **state) {
+    assert_int_equal(
+            triggerfish_pool_of(0, NULL, (void *) 1),
+            TRIGGERFISH_POOL_ERROR_SIZE_IS_ZERO);
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_pool_of(1, NULL, NULL),
+            TRIGGERFISH_POOL_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_pool *out;
+    assert_int_equal(
+            triggerfish_pool_of(SIZE_MAX, NULL, &out),
+            TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_pool_of(1, NULL, &out),
+            TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+    pthread_mutex_init_is_overridden = true;
+    will_return(cmocka_test_pthread_mutex_init, ENOMEM);
+    assert_int_equal(
+            triggerfish_pool_of(1, NULL, &out),
+            TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED);
+    pthread_mutex_init_is_overridden = false;
+}
+
+static void check_of(void **state) {
+    struct triggerfish_pool *object;
+    assert_int_equal(triggerfish_pool_of(sizeof(uintmax_t), reset, &object),
+                     0);
+    assert_int_equal(object->size, sizeof(uintmax_t));
+    assert_true(object->offset >= sizeof(struct triggerfish_strong));
+    assert_ptr_equal(object->reset, reset);
+    assert_null(object->first);
+    assert_null(object->caches);
+    assert_int_equal(triggerfish_pool_destroy(object), 0);
+}
+
+static void check_destroy_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_pool_destroy(NULL),
+            TRIGGERFISH_POOL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_strong_of_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_pool_strong_of(NULL, (void *) 1, (void *) 1),
+            TRIGGERFISH_POOL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_strong_of_error_on_on_destroy_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_pool_strong_of((void *) 1, NULL, (void *) 1),
+            TRIGGERFISH_POOL_ERROR_ON_DESTROY_IS_NULL);
+}
+
+static void check_strong_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_pool_strong_of((void *) 1, (void *) 1, NULL),
+            TRIGGERFISH_POOL_ERROR_OUT_IS_NULL);
+}
+
+static void check_strong_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_pool *object;
+    assert_int_equal(triggerfish_pool_of(sizeof(uintmax_t), NULL, &object),
+                     0);
+    struct triggerfish_strong *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_pool_strong_of(object, on_destroy, &out),
+            TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+    pthread_mutex_init_is_overridden = true;
+    will_return(cmocka_test_pthread_mutex_init, ENOMEM);
+    assert_int_equal(
+            triggerfish_pool_strong_of(object, on_destroy, &out),
+            TRIGGERFISH_POOL_ERROR_MEMORY_ALLOCATION_FAILED);
+    pthread_mutex_init_is_overridden = false;
+    assert_int_equal(triggerfish_pool_destroy(object), 0);
+}
+
+static void check_strong_of(void **state) {
+    struct triggerfish_pool *object;
+    assert_int_equal(triggerfish_pool_of(sizeof(uintmax_t), reset, &object),
+                     0);
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_pool_strong_of(object, on_destroy, &out), 0);
+    assert_ptr_equal(out->pool, object);
+    assert_ptr_equal(out->on_destroy, on_destroy);
+    assert_ptr_equal(out->instance, (unsigned char *) out + object->offset);
+    assert_int_equal(*(uintmax_t *) out->instance, 0);
+    uintmax_t count;
+    assert_int_equal(triggerfish_strong_count(out, &count), 0);
+    assert_int_equal(count, 1);
+    expect_function_call(on_destroy);
+    expect_function_call(reset);
+    assert_int_equal(triggerfish_strong_release(out), 0);
+    assert_int_equal(triggerfish_pool_destroy(object), 0);
+}
+
+static void check_strong_of_recycles(void **state) {
+    struct triggerfish_pool *object;
+    assert_int_equal(triggerfish_pool_of(sizeof(uintmax_t), reset, &object),
+                     0);
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_pool_strong_of(object, on_destroy, &out), 0);
+    struct triggerfish_strong *const first = out;
+    *(uintmax_t *) out->instance = 7;
+    expect_function_call(on_destroy);
+    expect_function_call(reset);
+    assert_int_equal(triggerfish_strong_release(out), 0);
+    assert_non_null(object->caches);
+    assert_int_equal(object->caches->count, 1);
+    assert_int_equal(triggerfish_pool_strong_of(object, on_destroy_quietly,
+                                                &out), 0);
+    assert_ptr_equal(out, first);
+    assert_ptr_equal(out->on_destroy, on_destroy_quietly);
+    assert_int_equal(object->caches->count, 0);
+    uintmax_t value;
+    memset(&value, 0xaa, sizeof(value));
+    assert_int_equal(*(uintmax_t *) out->instance, value);
+    uintmax_t count;
+    assert_int_equal(triggerfish_strong_count(out, &count), 0);
+    assert_int_equal(count, 1);
+    expect_function_call(reset);
+    assert_int_equal(triggerfish_strong_release(out), 0);
+    assert_int_equal(triggerfish_pool_destroy(object), 0);
+}
+
+static void check_strong_of_hands_over_full_cache(void **state) {
+    struct triggerfish_pool *object;
+    assert_int_equal(triggerfish_pool_of(1, NULL, &object), 0);
+    struct triggerfish_strong *out[TRIGGERFISH_POOL_CACHE_MAX + 1];
+    for (uintmax_t i = 0; i <= TRIGGERFISH_POOL_CACHE_MAX; i++) {
+        assert_int_equal(triggerfish_pool_strong_of(
+                object, on_destroy_quietly, &out[i]), 0);
+    }
+    for (uintmax_t i = 0; i <= TRIGGERFISH_POOL_CACHE_MAX; i++) {
+        assert_int_equal(triggerfish_strong_release(out[i]), 0);
+    }
+    assert_int_equal(object->caches->count, 1);
+    assert_ptr_equal(object->caches->first, out[TRIGGERFISH_POOL_CACHE_MAX]);
+    uintmax_t handed_over = 0;
+    for (struct triggerfish_pool_entry *entry = object->first; entry;
+         entry = entry->next) {
+        handed_over++;
+    }
+    assert_int_equal(handed_over, TRIGGERFISH_POOL_CACHE_MAX);
+    /* an empty cache refills itself from the pool */
+    struct triggerfish_strong *strong;
+    for (uintmax_t i = 0; i < 2; i++) {
+        assert_int_equal(triggerfish_pool_strong_of(
+                object, on_destroy_quietly, &strong), 0);
+        assert_int_equal(triggerfish_strong_release(strong), 0);
+        assert_int_equal(triggerfish_pool_strong_of(
+                object, on_destroy_quietly, &out[i]), 0);
+    }
+    assert_int_equal(object->caches->count,
+                     TRIGGERFISH_POOL_CACHE_MAX / 2);
+    for (uintmax_t i = 0; i < 2; i++) {
+        assert_int_equal(triggerfish_strong_release(out[i]), 0);
+    }
+    assert_int_equal(triggerfish_pool_destroy(object), 0);
+}
+
+static void *worker(void *pool) {
+    for (uintmax_t i = 0; i < 1000; i++) {
+        struct triggerfish_strong *out;
+        assert_int_equal(triggerfish_pool_strong_of(
+                pool, on_destroy_quietly, &out), 0);
+        void *instance;
+        assert_int_equal(triggerfish_strong_instance(out, &instance), 0);
+        *(uintmax_t *) instance = i;
+        assert_int_equal(triggerfish_strong_retain(out), 0);
+        assert_int_equal(triggerfish_strong_release(out), 0);
+        assert_int_equal(triggerfish_strong_release(out), 0);
+    }
+    return NULL;
+}
+
+static void check_strong_of_concurrently(void **state) {
+    struct triggerfish_pool *object;
+    assert_int_equal(triggerfish_pool_of(sizeof(uintmax_t), NULL, &object),
+                     0);
+    pthread_t threads[WORKERS];
+    for (uintmax_t i = 0; i < WORKERS; i++) {
+        assert_int_equal(pthread_create(&threads[i], NULL, worker, object),
+                         0);
+    }
+    for (uintmax_t i = 0; i < WORKERS; i++) {
+        assert_int_equal(pthread_join(threads[i], NULL), 0);
+    }
+    /* exited threads handed over their cache */
+    assert_null(object->caches);
+    assert_non_null(object->first);
+    assert_int_equal(triggerfish_pool_destroy(object), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_size_is_zero),
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_destroy_error_on_object_is_null),
+            cmocka_unit_test(check_strong_of_error_on_object_is_null),
+            cmocka_unit_test(check_strong_of_error_on_on_destroy_is_null),
+            cmocka_unit_test(check_strong_of_error_on_out_is_null),
+            cmocka_unit_test(check_strong_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_strong_of),
+            cmocka_unit_test(check_strong_of_recycles),
+            cmocka_unit_test(check_strong_of_hands_over_full_cache),
+            cmocka_unit_test(check_strong_of_concurrently),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
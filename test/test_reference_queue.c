@@ -0,0 +1,272 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <errno.h>
+#include <string.h>
+#include <pthread.h>
+#include <triggerfish.h>
+
+#include "private/reference_queue.h"
+
+#include <test/cmocka.h>
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static void on_destroy_quietly(void *instance) {
+    assert_non_null(instance);
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_reference_queue_of(NULL),
+            TRIGGERFISH_REFERENCE_QUEUE_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_reference_queue *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_reference_queue_of(&out),
+            TRIGGERFISH_REFERENCE_QUEUE_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+}
+
+static void check_of_error_on_mutex_init_failed(void **state) {
+    struct triggerfish_reference_queue *out;
+    pthread_mutex_init_is_overridden = true;
+    will_return(cmocka_test_pthread_mutex_init, ENOMEM);
+    assert_int_equal(
+            triggerfish_reference_queue_of(&out),
+            TRIGGERFISH_REFERENCE_QUEUE_ERROR_MEMORY_ALLOCATION_FAILED);
+    pthread_mutex_init_is_overridden = false;
+}
+
+static void check_of(void **state) {
+    struct triggerfish_reference_queue *out;
+    assert_int_equal(triggerfish_reference_queue_of(&out), 0);
+    assert_null(atomic_load(&out->pushed));
+    assert_null(out->first);
+    assert_int_equal(triggerfish_reference_queue_destroy(out), 0);
+}
+
+static void check_destroy_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_reference_queue_destroy(NULL),
+            TRIGGERFISH_REFERENCE_QUEUE_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_destroy_with_pending_cookies(void **state) {
+    struct triggerfish_reference_queue *object;
+    assert_int_equal(triggerfish_reference_queue_of(&object), 0);
+    for (uintptr_t i = 0; i < 3; i++) {
+        struct triggerfish_reference_queue_entry *entry;
+        assert_int_equal(triggerfish_reference_queue_entry_of(
+                object, (void *) i, &entry), 0);
+        triggerfish_reference_queue_push(entry);
+    }
+    void *cookie;
+    uintmax_t count;
+    assert_int_equal(triggerfish_reference_queue_poll(
+            object, &cookie, 1, &count), 0);
+    assert_int_equal(triggerfish_reference_queue_destroy(object), 0);
+}
+
+static void check_poll_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_reference_queue_poll(
+                    NULL, (void *) 1, 1, (void *) 1),
+            TRIGGERFISH_REFERENCE_QUEUE_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_poll_error_on_cookies_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_reference_queue_poll(
+                    (void *) 1, NULL, 1, (void *) 1),
+            TRIGGERFISH_REFERENCE_QUEUE_ERROR_COOKIES_IS_NULL);
+}
+
+static void check_poll_error_on_count_is_zero(void **state) {
+    assert_int_equal(
+            triggerfish_reference_queue_poll(
+                    (void *) 1, (void *) 1, 0, (void *) 1),
+            TRIGGERFISH_REFERENCE_QUEUE_ERROR_COUNT_IS_ZERO);
+}
+
+static void check_poll_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_reference_queue_poll(
+                    (void *) 1, (void *) 1, 1, NULL),
+            TRIGGERFISH_REFERENCE_QUEUE_ERROR_OUT_IS_NULL);
+}
+
+static void check_poll_error_on_queue_is_empty(void **state) {
+    struct triggerfish_reference_queue *object;
+    assert_int_equal(triggerfish_reference_queue_of(&object), 0);
+    void *cookies[4];
+    uintmax_t count;
+    assert_int_equal(
+            triggerfish_reference_queue_poll(object, cookies, 4, &count),
+            TRIGGERFISH_REFERENCE_QUEUE_ERROR_QUEUE_IS_EMPTY);
+    assert_int_equal(triggerfish_reference_queue_destroy(object), 0);
+}
+
+static void check_poll(void **state) {
+    struct triggerfish_reference_queue *object;
+    assert_int_equal(triggerfish_reference_queue_of(&object), 0);
+    struct triggerfish_strong *strong[5];
+    struct triggerfish_weak *weak[5];
+    for (uintptr_t i = 0; i < 5; i++) {
+        assert_int_equal(triggerfish_strong_of(
+                malloc(1), on_destroy, &strong[i]), 0);
+        assert_int_equal(triggerfish_weak_of_queue(
+                strong[i], object, (void *) (i + 1), &weak[i]), 0);
+    }
+    void *cookies[3];
+    uintmax_t count;
+    for (uintptr_t i = 0; i < 5; i++) {
+        expect_function_call(on_destroy);
+        assert_int_equal(triggerfish_strong_release(strong[i]), 0);
+    }
+    assert_int_equal(
+            triggerfish_reference_queue_poll(object, cookies, 3, &count), 0);
+    assert_int_equal(count, 3);
+    assert_ptr_equal(cookies[0], (void *) 1);
+    assert_ptr_equal(cookies[1], (void *) 2);
+    assert_ptr_equal(cookies[2], (void *) 3);
+    assert_int_equal(
+            triggerfish_reference_queue_poll(object, cookies, 3, &count), 0);
+    assert_int_equal(count, 2);
+    assert_ptr_equal(cookies[0], (void *) 4);
+    assert_ptr_equal(cookies[1], (void *) 5);
+    assert_int_equal(
+            triggerfish_reference_queue_poll(object, cookies, 3, &count),
+            TRIGGERFISH_REFERENCE_QUEUE_ERROR_QUEUE_IS_EMPTY);
+    for (uintptr_t i = 0; i < 5; i++) {
+        assert_int_equal(triggerfish_weak_destroy(weak[i]), 0);
+    }
+    assert_int_equal(triggerfish_reference_queue_destroy(object), 0);
+}
+
+static void check_poll_skips_destroyed_weak(void **state) {
+    struct triggerfish_reference_queue *object;
+    assert_int_equal(triggerfish_reference_queue_of(&object), 0);
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_weak *weak;
+    assert_int_equal(triggerfish_weak_of_queue(
+            strong, object, (void *) 1, &weak), 0);
+    assert_int_equal(triggerfish_weak_destroy(weak), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    void *cookie;
+    uintmax_t count;
+    assert_int_equal(
+            triggerfish_reference_queue_poll(object, &cookie, 1, &count),
+            TRIGGERFISH_REFERENCE_QUEUE_ERROR_QUEUE_IS_EMPTY);
+    assert_int_equal(triggerfish_reference_queue_destroy(object), 0);
+}
+
+static void check_poll_region(void **state) {
+    struct triggerfish_reference_queue *object;
+    assert_int_equal(triggerfish_reference_queue_of(&object), 0);
+    struct triggerfish_region *region;
+    assert_int_equal(triggerfish_region_of(&region), 0);
+    struct triggerfish_strong *strong[2];
+    struct triggerfish_weak *weak[2];
+    for (uintptr_t i = 0; i < 2; i++) {
+        assert_int_equal(triggerfish_region_strong_of(
+                region, 1, on_destroy, &strong[i]), 0);
+        assert_int_equal(triggerfish_weak_of_queue(
+                strong[i], object, (void *) (i + 1), &weak[i]), 0);
+        assert_int_equal(triggerfish_strong_release(strong[i]), 0);
+    }
+    expect_function_calls(on_destroy, 2);
+    assert_int_equal(triggerfish_region_release(region), 0);
+    void *cookies[2];
+    uintmax_t count;
+    assert_int_equal(
+            triggerfish_reference_queue_poll(object, cookies, 2, &count), 0);
+    assert_int_equal(count, 2);
+    for (uintptr_t i = 0; i < 2; i++) {
+        assert_int_equal(triggerfish_weak_destroy(weak[i]), 0);
+    }
+    assert_int_equal(triggerfish_reference_queue_destroy(object), 0);
+}
+
+#define PRODUCERS   4
+#define RELEASES    1000
+
+static void *produce(void *arg) {
+    struct triggerfish_reference_queue *const object = arg;
+    for (uintptr_t i = 0; i < RELEASES; i++) {
+        struct triggerfish_strong *strong;
+        assert_int_equal(triggerfish_strong_of(
+                malloc(1), on_destroy_quietly, &strong), 0);
+        struct triggerfish_weak *weak;
+        assert_int_equal(triggerfish_weak_of_queue(
+                strong, object, (void *) 1, &weak), 0);
+        assert_int_equal(triggerfish_strong_release(strong), 0);
+        assert_int_equal(triggerfish_weak_destroy(weak), 0);
+    }
+    return NULL;
+}
+
+static void check_poll_concurrently(void **state) {
+    struct triggerfish_reference_queue *object;
+    assert_int_equal(triggerfish_reference_queue_of(&object), 0);
+    pthread_t threads[PRODUCERS];
+    for (uintmax_t i = 0; i < PRODUCERS; i++) {
+        assert_int_equal(pthread_create(
+                &threads[i], NULL, produce, object), 0);
+    }
+    uintmax_t total = 0;
+    void *cookies[64];
+    while (total < PRODUCERS * RELEASES) {
+        uintmax_t count;
+        const int error = triggerfish_reference_queue_poll(
+                object, cookies, 64, &count);
+        if (error) {
+            assert_int_equal(error,
+                             TRIGGERFISH_REFERENCE_QUEUE_ERROR_QUEUE_IS_EMPTY);
+            continue;
+        }
+        for (uintmax_t i = 0; i < count; i++) {
+            assert_ptr_equal(cookies[i], (void *) 1);
+        }
+        total += count;
+    }
+    for (uintmax_t i = 0; i < PRODUCERS; i++) {
+        assert_int_equal(pthread_join(threads[i], NULL), 0);
+    }
+    assert_int_equal(total, PRODUCERS * RELEASES);
+    assert_int_equal(triggerfish_reference_queue_destroy(object), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of_error_on_mutex_init_failed),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_destroy_error_on_object_is_null),
+            cmocka_unit_test(check_destroy_with_pending_cookies),
+            cmocka_unit_test(check_poll_error_on_object_is_null),
+            cmocka_unit_test(check_poll_error_on_cookies_is_null),
+            cmocka_unit_test(check_poll_error_on_count_is_zero),
+            cmocka_unit_test(check_poll_error_on_out_is_null),
+            cmocka_unit_test(check_poll_error_on_queue_is_empty),
+            cmocka_unit_test(check_poll),
+            cmocka_unit_test(check_poll_skips_destroyed_weak),
+            cmocka_unit_test(check_poll_region),
+            cmocka_unit_test(check_poll_concurrently),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,266 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+#include <errno.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/weak.h"
+#include "private/region.h"
+
+#include <test/cmocka.h>
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_region_of(NULL),
+            TRIGGERFISH_REGION_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_region *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_region_of(&out),
+            TRIGGERFISH_REGION_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+    pthread_mutex_init_is_overridden = true;
+    will_return(cmocka_test_pthread_mutex_init, ENOMEM);
+    assert_int_equal(
+            triggerfish_region_of(&out),
+            TRIGGERFISH_REGION_ERROR_MEMORY_ALLOCATION_FAILED);
+    pthread_mutex_init_is_overridden = false;
+}
+
+static void check_of(void **state) {
+    struct triggerfish_region *object;
+    assert_int_equal(triggerfish_region_of(&object), 0);
+    assert_non_null(object);
+    assert_int_equal(atomic_load(&object->counter), 1);
+    assert_null(object->chunks);
+    assert_null(object->entries);
+    assert_int_equal(triggerfish_region_release(object), 0);
+}
+
+static void check_count_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_region_count(NULL, (void *) 1),
+            TRIGGERFISH_REGION_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_count_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_region_count((void *) 1, NULL),
+            TRIGGERFISH_REGION_ERROR_OUT_IS_NULL);
+}
+
+static void check_count(void **state) {
+    srand(time(NULL));
+    struct triggerfish_region object = {
+            .counter = rand() % UINTMAX_MAX
+    };
+    uintmax_t out;
+    assert_int_equal(triggerfish_region_count(&object, &out), 0);
+    assert_int_equal(out, object.counter);
+}
+
+static void check_retain_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_region_retain(NULL),
+            TRIGGERFISH_REGION_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_retain_error_on_object_is_invalid(void **state) {
+    struct triggerfish_region object = {};
+    assert_int_equal(
+            triggerfish_region_retain(&object),
+            TRIGGERFISH_REGION_ERROR_OBJECT_IS_INVALID);
+}
+
+static void check_retain(void **state) {
+    struct triggerfish_region *object;
+    assert_int_equal(triggerfish_region_of(&object), 0);
+    assert_int_equal(triggerfish_region_retain(object), 0);
+    assert_int_equal(atomic_load(&object->counter), 2);
+    assert_int_equal(triggerfish_region_release(object), 0);
+    assert_int_equal(atomic_load(&object->counter), 1);
+    assert_int_equal(triggerfish_region_release(object), 0);
+}
+
+static void check_release_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_region_release(NULL),
+            TRIGGERFISH_REGION_ERROR_OBJECT_IS_NULL);
+}
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static void check_release(void **state) {
+    struct triggerfish_region *object;
+    assert_int_equal(triggerfish_region_of(&object), 0);
+    struct triggerfish_strong *strong;
+    for (uintmax_t i = 0; i < 3; i++) {
+        assert_int_equal(triggerfish_region_strong_of(
+                object, 1, on_destroy, &strong), 0);
+        assert_int_equal(triggerfish_strong_release(strong), 0);
+    }
+    assert_int_equal(triggerfish_region_strong_of(
+            object, 1, NULL, &strong), 0);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    expect_function_calls(on_destroy, 3);
+    assert_int_equal(triggerfish_region_release(object), 0);
+}
+
+static void check_strong_of_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_region_strong_of(NULL, 1, NULL, (void *) 1),
+            TRIGGERFISH_REGION_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_strong_of_error_on_size_is_zero(void **state) {
+    assert_int_equal(
+            triggerfish_region_strong_of((void *) 1, 0, NULL, (void *) 1),
+            TRIGGERFISH_REGION_ERROR_SIZE_IS_ZERO);
+}
+
+static void check_strong_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_region_strong_of((void *) 1, 1, NULL, NULL),
+            TRIGGERFISH_REGION_ERROR_OUT_IS_NULL);
+}
+
+static void check_strong_of_error_on_object_is_invalid(void **state) {
+    struct triggerfish_region object = {};
+    struct triggerfish_strong *out;
+    pthread_mutex_lock_is_overridden = true;
+    will_return(cmocka_test_pthread_mutex_lock, EINVAL);
+    assert_int_equal(
+            triggerfish_region_strong_of(&object, 1, NULL, &out),
+            TRIGGERFISH_REGION_ERROR_OBJECT_IS_INVALID);
+    pthread_mutex_lock_is_overridden = false;
+}
+
+static void check_strong_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_region *object;
+    assert_int_equal(triggerfish_region_of(&object), 0);
+    struct triggerfish_strong *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_region_strong_of(object, 1, NULL, &out),
+            TRIGGERFISH_REGION_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+    assert_int_equal(triggerfish_region_release(object), 0);
+}
+
+static void check_strong_of(void **state) {
+    struct triggerfish_region *object;
+    assert_int_equal(triggerfish_region_of(&object), 0);
+    struct triggerfish_strong *a;
+    assert_int_equal(triggerfish_region_strong_of(
+            object, sizeof(uintmax_t), NULL, &a), 0);
+    assert_ptr_equal(a->region, object);
+    assert_non_null(a->instance);
+    assert_int_equal(*(uintmax_t *) a->instance, 0);
+    struct triggerfish_strong *b;
+    assert_int_equal(triggerfish_region_strong_of(
+            object, 2 * TRIGGERFISH_REGION_CHUNK_SIZE, NULL, &b), 0);
+    struct triggerfish_strong *c;
+    assert_int_equal(triggerfish_region_strong_of(
+            object, sizeof(uintmax_t), NULL, &c), 0);
+    /* oversized instance must not start a new bump chunk */
+    assert_non_null(object->chunks->next);
+    assert_null(object->chunks->next->next);
+    assert_ptr_equal(object->chunks->next->data, b);
+    assert_ptr_not_equal(a->instance, c->instance);
+    assert_int_equal(atomic_load(&object->counter), 4);
+    assert_int_equal(triggerfish_strong_release(a), 0);
+    assert_int_equal(triggerfish_strong_release(b), 0);
+    assert_int_equal(triggerfish_strong_release(c), 0);
+    assert_int_equal(atomic_load(&object->counter), 1);
+    assert_int_equal(triggerfish_region_release(object), 0);
+}
+
+static void check_strong_shares_region_count(void **state) {
+    struct triggerfish_region *object;
+    assert_int_equal(triggerfish_region_of(&object), 0);
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_region_strong_of(
+            object, 1, on_destroy, &strong), 0);
+    uintmax_t count;
+    assert_int_equal(triggerfish_strong_count(strong, &count), 0);
+    assert_int_equal(count, 2);
+    assert_int_equal(triggerfish_region_release(object), 0);
+    void *instance;
+    assert_int_equal(triggerfish_strong_instance(strong, &instance), 0);
+    assert_ptr_equal(instance, strong->instance);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+}
+
+static void check_weak_is_cleared_when_region_is_released(void **state) {
+    struct triggerfish_region *object;
+    assert_int_equal(triggerfish_region_of(&object), 0);
+    struct triggerfish_strong *a;
+    assert_int_equal(triggerfish_region_strong_of(
+            object, 1, NULL, &a), 0);
+    struct triggerfish_strong *b;
+    assert_int_equal(triggerfish_region_strong_of(
+            object, 1, NULL, &b), 0);
+    struct triggerfish_weak *weak_a;
+    assert_int_equal(triggerfish_weak_of(a, &weak_a), 0);
+    struct triggerfish_weak *weak_b;
+    assert_int_equal(triggerfish_weak_of(b, &weak_b), 0);
+    assert_int_equal(triggerfish_strong_release(a), 0);
+    assert_int_equal(triggerfish_strong_release(b), 0);
+    uintmax_t count;
+    assert_int_equal(coral_red_black_tree_container_count(
+            &object->weak_refs, &count), 0);
+    assert_int_equal(count, 2);
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_weak_strong(weak_b, &out), 0);
+    assert_ptr_equal(out, b);
+    assert_int_equal(atomic_load(&object->counter), 2);
+    assert_int_equal(triggerfish_strong_release(out), 0);
+    assert_int_equal(triggerfish_weak_destroy(weak_b), 0);
+    assert_int_equal(coral_red_black_tree_container_count(
+            &object->weak_refs, &count), 0);
+    assert_int_equal(count, 1);
+    assert_int_equal(triggerfish_region_release(object), 0);
+    assert_ptr_equal(atomic_load(&weak_a->strong), 0);
+    assert_int_equal(triggerfish_weak_destroy(weak_a), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_count_error_on_object_is_null),
+            cmocka_unit_test(check_count_error_on_out_is_null),
+            cmocka_unit_test(check_count),
+            cmocka_unit_test(check_retain_error_on_object_is_null),
+            cmocka_unit_test(check_retain_error_on_object_is_invalid),
+            cmocka_unit_test(check_retain),
+            cmocka_unit_test(check_release_error_on_object_is_null),
+            cmocka_unit_test(check_release),
+            cmocka_unit_test(check_strong_of_error_on_object_is_null),
+            cmocka_unit_test(check_strong_of_error_on_size_is_zero),
+            cmocka_unit_test(check_strong_of_error_on_out_is_null),
+            cmocka_unit_test(check_strong_of_error_on_object_is_invalid),
+            cmocka_unit_test(check_strong_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_strong_of),
+            cmocka_unit_test(check_strong_shares_region_count),
+            cmocka_unit_test(check_weak_is_cleared_when_region_is_released),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
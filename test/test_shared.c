@@ -0,0 +1,539 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdalign.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <triggerfish.h>
+
+#include "private/shared.h"
+
+#include <test/cmocka.h>
+
+static atomic_uint_least64_t *pids(
+        const struct triggerfish_shared_segment *const segment) {
+    return (void *) ((unsigned char *) segment + segment->pids);
+}
+
+static struct triggerfish_shared_block *blocks(
+        const struct triggerfish_shared_segment *const segment) {
+    return (void *) ((unsigned char *) segment + segment->blocks);
+}
+
+static atomic_uint_least64_t *hold(
+        const struct triggerfish_shared_segment *const segment,
+        const uint64_t process,
+        const uint64_t index) {
+    atomic_uint_least64_t *holds
+            = (void *) ((unsigned char *) segment + segment->holds);
+    return &holds[process * segment->count + index];
+}
+
+static const char *name(void) {
+    static char name[64];
+    snprintf(name, sizeof(name), "/triggerfish-test-shared-%ld",
+             (long) getpid());
+    return name;
+}
+
+static struct triggerfish_shared *segment(const uintmax_t count,
+                                          const uintmax_t processes) {
+    struct triggerfish_shared *out;
+    triggerfish_shared_unlink(name());
+    assert_int_equal(triggerfish_shared_of(name(), 24, count, processes,
+                                           &out), 0);
+    return out;
+}
+
+static void check_of_error_on_name_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_of(NULL, 1, 1, 1, (void *) 1),
+            TRIGGERFISH_SHARED_ERROR_NAME_IS_NULL);
+}
+
+static void check_of_error_on_size_is_zero(void **state) {
+    assert_int_equal(
+            triggerfish_shared_of(name(), 0, 1, 1, (void *) 1),
+            TRIGGERFISH_SHARED_ERROR_SIZE_IS_ZERO);
+}
+
+static void check_of_error_on_count_is_zero(void **state) {
+    assert_int_equal(
+            triggerfish_shared_of(name(), 1, 0, 1, (void *) 1),
+            TRIGGERFISH_SHARED_ERROR_COUNT_IS_ZERO);
+}
+
+static void check_of_error_on_processes_is_zero(void **state) {
+    assert_int_equal(
+            triggerfish_shared_of(name(), 1, 1, 0, (void *) 1),
+            TRIGGERFISH_SHARED_ERROR_PROCESSES_IS_ZERO);
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_of(name(), 1, 1, 1, NULL),
+            TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_segment_is_too_large(void **state) {
+    struct triggerfish_shared *out;
+    assert_int_equal(
+            triggerfish_shared_of(name(), SIZE_MAX, 2, 1, &out),
+            TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_TOO_LARGE);
+    assert_int_equal(
+            triggerfish_shared_of(name(), 1, UINT32_MAX, 1, &out),
+            TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_TOO_LARGE);
+}
+
+static void check_of_error_on_name_is_invalid(void **state) {
+    struct triggerfish_shared *out;
+    assert_int_equal(
+            triggerfish_shared_of("/triggerfish/invalid", 1, 1, 1, &out),
+            TRIGGERFISH_SHARED_ERROR_NAME_IS_INVALID);
+}
+
+static void check_of_error_on_name_already_exists(void **state) {
+    struct triggerfish_shared *object = segment(1, 1);
+    struct triggerfish_shared *out;
+    assert_int_equal(
+            triggerfish_shared_of(name(), 1, 1, 1, &out),
+            TRIGGERFISH_SHARED_ERROR_NAME_ALREADY_EXISTS);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_shared *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_shared_of(name(), 1, 1, 1, &out),
+            TRIGGERFISH_SHARED_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+    assert_int_equal(
+            triggerfish_shared_unlink(name()),
+            TRIGGERFISH_SHARED_ERROR_SEGMENT_NOT_FOUND);
+}
+
+static void check_of(void **state) {
+    struct triggerfish_shared *object = segment(3, 2);
+    struct triggerfish_shared_segment *segment = object->segment;
+    assert_int_equal(atomic_load(&segment->magic), TRIGGERFISH_SHARED_MAGIC);
+    assert_int_equal(segment->count, 3);
+    assert_int_equal(segment->processes, 2);
+    assert_true(segment->stride >= 24);
+    assert_int_equal(segment->stride % alignof(max_align_t), 0);
+    assert_int_equal(segment->data % alignof(max_align_t), 0);
+    assert_int_equal(segment->size, segment->data + 3 * segment->stride);
+    assert_int_equal(object->process, 0);
+    assert_int_equal(atomic_load(&segment->free), 1);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_open_error_on_name_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_open(NULL, (void *) 1),
+            TRIGGERFISH_SHARED_ERROR_NAME_IS_NULL);
+}
+
+static void check_open_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_open(name(), NULL),
+            TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL);
+}
+
+static void check_open_error_on_segment_not_found(void **state) {
+    struct triggerfish_shared *out;
+    triggerfish_shared_unlink(name());
+    assert_int_equal(
+            triggerfish_shared_open(name(), &out),
+            TRIGGERFISH_SHARED_ERROR_SEGMENT_NOT_FOUND);
+}
+
+static void check_open_error_on_processes_are_full(void **state) {
+    struct triggerfish_shared *object = segment(1, 1);
+    struct triggerfish_shared *out;
+    assert_int_equal(
+            triggerfish_shared_open(name(), &out),
+            TRIGGERFISH_SHARED_ERROR_PROCESSES_ARE_FULL);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_open_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_shared *object = segment(1, 2);
+    struct triggerfish_shared *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_shared_open(name(), &out),
+            TRIGGERFISH_SHARED_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_open(void **state) {
+    struct triggerfish_shared *object = segment(2, 2);
+    struct triggerfish_shared *other;
+    assert_int_equal(triggerfish_shared_open(name(), &other), 0);
+    assert_int_equal(other->process, 1);
+    assert_ptr_not_equal(other->segment, object->segment);
+    uintmax_t offset;
+    assert_int_equal(triggerfish_shared_alloc(object, &offset), 0);
+    char *a;
+    char *b;
+    assert_int_equal(triggerfish_shared_at(object, offset, (void **) &a), 0);
+    assert_int_equal(triggerfish_shared_at(other, offset, (void **) &b), 0);
+    strcpy(a, "triggerfish");
+    assert_string_equal(b, "triggerfish");
+    assert_int_equal(triggerfish_shared_close(other), 0);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_close_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_close(NULL),
+            TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_close(void **state) {
+    struct triggerfish_shared *object = segment(2, 2);
+    struct triggerfish_shared *other;
+    assert_int_equal(triggerfish_shared_open(name(), &other), 0);
+    uintmax_t a;
+    uintmax_t b;
+    assert_int_equal(triggerfish_shared_alloc(other, &a), 0);
+    assert_int_equal(triggerfish_shared_alloc(other, &b), 0);
+    assert_int_equal(triggerfish_shared_retain(object, a), 0);
+    assert_int_equal(triggerfish_shared_retain(other, a), 0);
+    assert_int_equal(triggerfish_shared_close(other), 0);
+    uintmax_t count;
+    assert_int_equal(triggerfish_shared_count(object, a, &count), 0);
+    assert_int_equal(count, 1);
+    assert_int_equal(triggerfish_shared_count(object, b, &count), 0);
+    assert_int_equal(count, 0);
+    assert_int_equal(atomic_load(&pids(object->segment)[1]), 0);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_unlink_error_on_name_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_unlink(NULL),
+            TRIGGERFISH_SHARED_ERROR_NAME_IS_NULL);
+}
+
+static void check_unlink_error_on_segment_not_found(void **state) {
+    triggerfish_shared_unlink(name());
+    assert_int_equal(
+            triggerfish_shared_unlink(name()),
+            TRIGGERFISH_SHARED_ERROR_SEGMENT_NOT_FOUND);
+}
+
+static void check_alloc_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_alloc(NULL, (void *) 1),
+            TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_alloc_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_alloc((void *) 1, NULL),
+            TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL);
+}
+
+static void check_alloc_error_on_segment_is_full(void **state) {
+    struct triggerfish_shared *object = segment(2, 1);
+    uintmax_t offset;
+    assert_int_equal(triggerfish_shared_alloc(object, &offset), 0);
+    assert_int_equal(triggerfish_shared_alloc(object, &offset), 0);
+    assert_int_equal(
+            triggerfish_shared_alloc(object, &offset),
+            TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_FULL);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_alloc(void **state) {
+    struct triggerfish_shared *object = segment(2, 1);
+    struct triggerfish_shared_segment *segment = object->segment;
+    uintmax_t a;
+    uintmax_t b;
+    assert_int_equal(triggerfish_shared_alloc(object, &a), 0);
+    assert_int_equal(a, segment->data);
+    assert_int_equal(triggerfish_shared_alloc(object, &b), 0);
+    assert_int_equal(b, segment->data + segment->stride);
+    assert_int_equal(atomic_load(&blocks(segment)[0].counter), 1);
+    assert_int_equal(atomic_load(hold(segment, 0, 1)), 1);
+    unsigned char *instance;
+    assert_int_equal(triggerfish_shared_at(object, a, (void **) &instance), 0);
+    memset(instance, 0xff, segment->stride);
+    /* a reused block is zeroed again */
+    assert_int_equal(triggerfish_shared_release(object, a), 0);
+    assert_int_equal(triggerfish_shared_alloc(object, &a), 0);
+    assert_int_equal(a, segment->data);
+    for (uint64_t i = 0; i < segment->stride; i++) {
+        assert_int_equal(instance[i], 0);
+    }
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_at_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_at(NULL, 0, (void *) 1),
+            TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_at_error_on_offset_is_invalid(void **state) {
+    struct triggerfish_shared *object = segment(1, 1);
+    const struct triggerfish_shared_segment *segment = object->segment;
+    void *out;
+    assert_int_equal(
+            triggerfish_shared_at(object, 0, &out),
+            TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID);
+    assert_int_equal(
+            triggerfish_shared_at(object, segment->data + 1, &out),
+            TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID);
+    assert_int_equal(
+            triggerfish_shared_at(object, segment->size, &out),
+            TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_at_error_on_out_is_null(void **state) {
+    struct triggerfish_shared *object = segment(1, 1);
+    assert_int_equal(
+            triggerfish_shared_at(object, object->segment->data, NULL),
+            TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_count_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_count(NULL, 0, (void *) 1),
+            TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_count_error_on_offset_is_invalid(void **state) {
+    struct triggerfish_shared *object = segment(1, 1);
+    uintmax_t out;
+    assert_int_equal(
+            triggerfish_shared_count(object, 0, &out),
+            TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_count_error_on_out_is_null(void **state) {
+    struct triggerfish_shared *object = segment(1, 1);
+    assert_int_equal(
+            triggerfish_shared_count(object, object->segment->data, NULL),
+            TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_retain_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_retain(NULL, 0),
+            TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_retain_error_on_offset_is_invalid(void **state) {
+    struct triggerfish_shared *object = segment(1, 1);
+    assert_int_equal(
+            triggerfish_shared_retain(object, 0),
+            TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_retain_error_on_block_is_invalid(void **state) {
+    struct triggerfish_shared *object = segment(1, 1);
+    assert_int_equal(
+            triggerfish_shared_retain(object, object->segment->data),
+            TRIGGERFISH_SHARED_ERROR_BLOCK_IS_INVALID);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_retain(void **state) {
+    struct triggerfish_shared *object = segment(1, 2);
+    struct triggerfish_shared *other;
+    assert_int_equal(triggerfish_shared_open(name(), &other), 0);
+    uintmax_t offset;
+    assert_int_equal(triggerfish_shared_alloc(object, &offset), 0);
+    assert_int_equal(triggerfish_shared_retain(other, offset), 0);
+    assert_int_equal(triggerfish_shared_retain(other, offset), 0);
+    uintmax_t count;
+    assert_int_equal(triggerfish_shared_count(object, offset, &count), 0);
+    assert_int_equal(count, 3);
+    assert_int_equal(atomic_load(hold(object->segment, 0, 0)), 1);
+    assert_int_equal(atomic_load(hold(object->segment, 1, 0)), 2);
+    assert_int_equal(triggerfish_shared_close(other), 0);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_release_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_release(NULL, 0),
+            TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_release_error_on_offset_is_invalid(void **state) {
+    struct triggerfish_shared *object = segment(1, 1);
+    assert_int_equal(
+            triggerfish_shared_release(object, 0),
+            TRIGGERFISH_SHARED_ERROR_OFFSET_IS_INVALID);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_release_error_on_block_is_not_held(void **state) {
+    struct triggerfish_shared *object = segment(1, 2);
+    struct triggerfish_shared *other;
+    assert_int_equal(triggerfish_shared_open(name(), &other), 0);
+    uintmax_t offset;
+    assert_int_equal(triggerfish_shared_alloc(object, &offset), 0);
+    assert_int_equal(
+            triggerfish_shared_release(other, offset),
+            TRIGGERFISH_SHARED_ERROR_BLOCK_IS_NOT_HELD);
+    assert_int_equal(triggerfish_shared_close(other), 0);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_release(void **state) {
+    struct triggerfish_shared *object = segment(1, 2);
+    struct triggerfish_shared *other;
+    assert_int_equal(triggerfish_shared_open(name(), &other), 0);
+    uintmax_t offset;
+    assert_int_equal(triggerfish_shared_alloc(object, &offset), 0);
+    assert_int_equal(triggerfish_shared_retain(other, offset), 0);
+    assert_int_equal(triggerfish_shared_release(object, offset), 0);
+    uintmax_t count;
+    assert_int_equal(triggerfish_shared_count(object, offset, &count), 0);
+    assert_int_equal(count, 1);
+    assert_int_equal(
+            triggerfish_shared_alloc(object, &offset),
+            TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_FULL);
+    assert_int_equal(triggerfish_shared_release(other, offset), 0);
+    assert_int_equal(triggerfish_shared_count(object, offset, &count), 0);
+    assert_int_equal(count, 0);
+    assert_int_equal(triggerfish_shared_alloc(object, &offset), 0);
+    assert_int_equal(triggerfish_shared_close(other), 0);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+static void check_recover_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_recover(NULL, (void *) 1),
+            TRIGGERFISH_SHARED_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_recover_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_shared_recover((void *) 1, NULL),
+            TRIGGERFISH_SHARED_ERROR_OUT_IS_NULL);
+}
+
+static void check_recover(void **state) {
+    struct triggerfish_shared *object = segment(2, 2);
+    uintmax_t offset;
+    assert_int_equal(triggerfish_shared_alloc(object, &offset), 0);
+    char path[64];
+    strcpy(path, name());
+    const pid_t child = fork();
+    assert_int_not_equal(child, -1);
+    if (!child) {
+        /* exit without closing the segment */
+        struct triggerfish_shared *other;
+        uintmax_t ignored;
+        _exit(triggerfish_shared_open(path, &other)
+              || triggerfish_shared_retain(other, offset)
+              || triggerfish_shared_alloc(other, &ignored));
+    }
+    int status;
+    assert_int_equal(waitpid(child, &status, 0), child);
+    assert_true(WIFEXITED(status));
+    assert_int_equal(WEXITSTATUS(status), 0);
+    uintmax_t count;
+    assert_int_equal(triggerfish_shared_count(object, offset, &count), 0);
+    assert_int_equal(count, 2);
+    assert_int_equal(
+            triggerfish_shared_alloc(object, &offset),
+            TRIGGERFISH_SHARED_ERROR_SEGMENT_IS_FULL);
+    assert_int_equal(triggerfish_shared_recover(object, &count), 0);
+    assert_int_equal(count, 1);
+    assert_int_equal(triggerfish_shared_count(object, offset, &count), 0);
+    assert_int_equal(count, 1);
+    assert_int_equal(atomic_load(&pids(object->segment)[1]), 0);
+    assert_int_equal(triggerfish_shared_alloc(object, &offset), 0);
+    assert_int_equal(triggerfish_shared_recover(object, &count), 0);
+    assert_int_equal(count, 0);
+    assert_int_equal(triggerfish_shared_close(object), 0);
+    assert_int_equal(triggerfish_shared_unlink(name()), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_name_is_null),
+            cmocka_unit_test(check_of_error_on_size_is_zero),
+            cmocka_unit_test(check_of_error_on_count_is_zero),
+            cmocka_unit_test(check_of_error_on_processes_is_zero),
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_segment_is_too_large),
+            cmocka_unit_test(check_of_error_on_name_is_invalid),
+            cmocka_unit_test(check_of_error_on_name_already_exists),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_open_error_on_name_is_null),
+            cmocka_unit_test(check_open_error_on_out_is_null),
+            cmocka_unit_test(check_open_error_on_segment_not_found),
+            cmocka_unit_test(check_open_error_on_processes_are_full),
+            cmocka_unit_test(check_open_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_open),
+            cmocka_unit_test(check_close_error_on_object_is_null),
+            cmocka_unit_test(check_close),
+            cmocka_unit_test(check_unlink_error_on_name_is_null),
+            cmocka_unit_test(check_unlink_error_on_segment_not_found),
+            cmocka_unit_test(check_alloc_error_on_object_is_null),
+            cmocka_unit_test(check_alloc_error_on_out_is_null),
+            cmocka_unit_test(check_alloc_error_on_segment_is_full),
+            cmocka_unit_test(check_alloc),
+            cmocka_unit_test(check_at_error_on_object_is_null),
+            cmocka_unit_test(check_at_error_on_offset_is_invalid),
+            cmocka_unit_test(check_at_error_on_out_is_null),
+            cmocka_unit_test(check_count_error_on_object_is_null),
+            cmocka_unit_test(check_count_error_on_offset_is_invalid),
+            cmocka_unit_test(check_count_error_on_out_is_null),
+            cmocka_unit_test(check_retain_error_on_object_is_null),
+            cmocka_unit_test(check_retain_error_on_offset_is_invalid),
+            cmocka_unit_test(check_retain_error_on_block_is_invalid),
+            cmocka_unit_test(check_retain),
+            cmocka_unit_test(check_release_error_on_object_is_null),
+            cmocka_unit_test(check_release_error_on_offset_is_invalid),
+            cmocka_unit_test(check_release_error_on_block_is_not_held),
+            cmocka_unit_test(check_release),
+            cmocka_unit_test(check_recover_error_on_object_is_null),
+            cmocka_unit_test(check_recover_error_on_out_is_null),
+            cmocka_unit_test(check_recover),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,247 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/soft.h"
+#include "private/soft_cache.h"
+
+#include <test/cmocka.h>
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static void check_of_error_on_cache_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_of(NULL, (void *) 1, 1, (void *) 1),
+            TRIGGERFISH_SOFT_ERROR_CACHE_IS_NULL);
+}
+
+static void check_of_error_on_strong_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_of((void *) 1, NULL, 1, (void *) 1),
+            TRIGGERFISH_SOFT_ERROR_STRONG_IS_NULL);
+}
+
+static void check_of_error_on_size_is_zero(void **state) {
+    assert_int_equal(
+            triggerfish_soft_of((void *) 1, (void *) 1, 0, (void *) 1),
+            TRIGGERFISH_SOFT_ERROR_SIZE_IS_ZERO);
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_of((void *) 1, (void *) 1, 1, NULL),
+            TRIGGERFISH_SOFT_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_soft *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_soft_of((void *) 1, (void *) 1, 1, &out),
+            TRIGGERFISH_SOFT_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+}
+
+static void check_of_error_on_strong_is_invalid(void **state) {
+    struct triggerfish_soft_cache *cache;
+    assert_int_equal(triggerfish_soft_cache_of(100, &cache), 0);
+    /* a borrowed strong reference that was destroyed meanwhile */
+    struct triggerfish_strong invalid = {};
+    struct triggerfish_soft *out;
+    pthread_mutex_lock_is_overridden = true;
+    will_return(cmocka_test_pthread_mutex_lock, EINVAL);
+    assert_int_equal(
+            triggerfish_soft_of(cache, &invalid, 1, &out),
+            TRIGGERFISH_SOFT_ERROR_STRONG_IS_INVALID);
+    pthread_mutex_lock_is_overridden = false;
+    assert_int_equal(triggerfish_soft_cache_destroy(cache), 0);
+}
+
+static void check_of(void **state) {
+    struct triggerfish_soft_cache *cache;
+    assert_int_equal(triggerfish_soft_cache_of(100, &cache), 0);
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_soft *object;
+    assert_int_equal(triggerfish_soft_of(cache, strong, 10, &object), 0);
+    assert_ptr_equal(object->cache, cache);
+    assert_ptr_equal(object->strong, strong);
+    assert_non_null(object->weak);
+    assert_int_equal(object->size, 10);
+    assert_false(object->referenced);
+    assert_ptr_equal(cache->hand, object);
+    assert_int_equal(cache->usage, 10);
+    assert_int_equal(atomic_load(&strong->counter), 2);
+    /* the soft reference keeps the instance alive on its own */
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_soft_destroy(object), 0);
+    assert_int_equal(triggerfish_soft_cache_destroy(cache), 0);
+}
+
+static void check_of_over_budget(void **state) {
+    struct triggerfish_soft_cache *cache;
+    assert_int_equal(triggerfish_soft_cache_of(15, &cache), 0);
+    struct triggerfish_strong *a;
+    struct triggerfish_strong *b;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &a), 0);
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &b), 0);
+    struct triggerfish_soft *A;
+    struct triggerfish_soft *B;
+    assert_int_equal(triggerfish_soft_of(cache, a, 10, &A), 0);
+    assert_int_equal(triggerfish_strong_release(a), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_soft_of(cache, b, 10, &B), 0);
+    assert_null(A->strong);
+    assert_ptr_equal(B->strong, b);
+    assert_int_equal(cache->usage, 10);
+    assert_int_equal(triggerfish_soft_destroy(A), 0);
+    assert_int_equal(triggerfish_soft_destroy(B), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(b), 0);
+    assert_int_equal(triggerfish_soft_cache_destroy(cache), 0);
+}
+
+static void check_destroy_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_destroy(NULL),
+            TRIGGERFISH_SOFT_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_destroy(void **state) {
+    struct triggerfish_soft_cache *cache;
+    assert_int_equal(triggerfish_soft_cache_of(100, &cache), 0);
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_soft *object;
+    assert_int_equal(triggerfish_soft_of(cache, strong, 10, &object), 0);
+    assert_int_equal(triggerfish_soft_destroy(object), 0);
+    assert_null(cache->hand);
+    assert_int_equal(cache->usage, 0);
+    assert_int_equal(atomic_load(&strong->counter), 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    assert_int_equal(triggerfish_soft_cache_destroy(cache), 0);
+}
+
+static void check_is_cleared_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_is_cleared(NULL, (void *) 1),
+            TRIGGERFISH_SOFT_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_is_cleared_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_is_cleared((void *) 1, NULL),
+            TRIGGERFISH_SOFT_ERROR_OUT_IS_NULL);
+}
+
+static void check_is_cleared(void **state) {
+    struct triggerfish_soft_cache *cache;
+    assert_int_equal(triggerfish_soft_cache_of(100, &cache), 0);
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_soft *object;
+    assert_int_equal(triggerfish_soft_of(cache, strong, 10, &object), 0);
+    bool out;
+    assert_int_equal(triggerfish_soft_is_cleared(object, &out), 0);
+    assert_false(out);
+    assert_int_equal(triggerfish_soft_cache_shrink(cache, 0), 0);
+    assert_int_equal(triggerfish_soft_is_cleared(object, &out), 0);
+    assert_true(out);
+    assert_int_equal(triggerfish_soft_destroy(object), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    assert_int_equal(triggerfish_soft_cache_destroy(cache), 0);
+}
+
+static void check_strong_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_strong(NULL, (void *) 1),
+            TRIGGERFISH_SOFT_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_strong_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_strong((void *) 1, NULL),
+            TRIGGERFISH_SOFT_ERROR_OUT_IS_NULL);
+}
+
+static void check_strong_error_on_strong_is_invalid(void **state) {
+    struct triggerfish_soft_cache *cache;
+    assert_int_equal(triggerfish_soft_cache_of(100, &cache), 0);
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_soft *object;
+    assert_int_equal(triggerfish_soft_of(cache, strong, 10, &object), 0);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_soft_cache_shrink(cache, 0), 0);
+    struct triggerfish_strong *out;
+    assert_int_equal(
+            triggerfish_soft_strong(object, &out),
+            TRIGGERFISH_SOFT_ERROR_STRONG_IS_INVALID);
+    assert_int_equal(triggerfish_soft_destroy(object), 0);
+    assert_int_equal(triggerfish_soft_cache_destroy(cache), 0);
+}
+
+static void check_strong(void **state) {
+    struct triggerfish_soft_cache *cache;
+    assert_int_equal(triggerfish_soft_cache_of(100, &cache), 0);
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_soft *object;
+    assert_int_equal(triggerfish_soft_of(cache, strong, 10, &object), 0);
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_soft_strong(object, &out), 0);
+    assert_ptr_equal(out, strong);
+    assert_true(object->referenced);
+    assert_int_equal(atomic_load(&strong->counter), 3);
+    assert_int_equal(triggerfish_strong_release(out), 0);
+    /* once cleared the instance is reachable while others keep it alive */
+    assert_int_equal(triggerfish_soft_cache_shrink(cache, 0), 0);
+    assert_int_equal(atomic_load(&strong->counter), 1);
+    assert_int_equal(triggerfish_soft_strong(object, &out), 0);
+    assert_ptr_equal(out, strong);
+    assert_int_equal(triggerfish_strong_release(out), 0);
+    assert_int_equal(triggerfish_soft_destroy(object), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    assert_int_equal(triggerfish_soft_cache_destroy(cache), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_cache_is_null),
+            cmocka_unit_test(check_of_error_on_strong_is_null),
+            cmocka_unit_test(check_of_error_on_size_is_zero),
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of_error_on_strong_is_invalid),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_of_over_budget),
+            cmocka_unit_test(check_destroy_error_on_object_is_null),
+            cmocka_unit_test(check_destroy),
+            cmocka_unit_test(check_is_cleared_error_on_object_is_null),
+            cmocka_unit_test(check_is_cleared_error_on_out_is_null),
+            cmocka_unit_test(check_is_cleared),
+            cmocka_unit_test(check_strong_error_on_object_is_null),
+            cmocka_unit_test(check_strong_error_on_out_is_null),
+            cmocka_unit_test(check_strong_error_on_strong_is_invalid),
+            cmocka_unit_test(check_strong),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,315 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/soft.h"
+#include "private/soft_cache.h"
+
+#include <test/cmocka.h>
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static struct triggerfish_soft *soft(struct triggerfish_soft_cache *cache,
+                                     const size_t size) {
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_soft *out;
+    assert_int_equal(triggerfish_soft_of(cache, strong, size, &out), 0);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    return out;
+}
+
+static void write_file(const char *path, const char *content) {
+    FILE *file = fopen(path, "w");
+    assert_non_null(file);
+    assert_int_equal(fputs(content, file) < 0, false);
+    assert_int_equal(fclose(file), 0);
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_cache_of(0, NULL),
+            TRIGGERFISH_SOFT_CACHE_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_soft_cache *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_soft_cache_of(0, &out),
+            TRIGGERFISH_SOFT_CACHE_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+}
+
+static void check_of_error_on_mutex_init_failed(void **state) {
+    struct triggerfish_soft_cache *out;
+    pthread_mutex_init_is_overridden = true;
+    will_return(cmocka_test_pthread_mutex_init, ENOMEM);
+    assert_int_equal(
+            triggerfish_soft_cache_of(0, &out),
+            TRIGGERFISH_SOFT_CACHE_ERROR_MEMORY_ALLOCATION_FAILED);
+    pthread_mutex_init_is_overridden = false;
+}
+
+static void check_of(void **state) {
+    struct triggerfish_soft_cache *object;
+    assert_int_equal(triggerfish_soft_cache_of(100, &object), 0);
+    assert_int_equal(object->budget, 100);
+    assert_int_equal(object->usage, 0);
+    assert_null(object->hand);
+    assert_false(object->polled);
+    assert_int_equal(triggerfish_soft_cache_destroy(object), 0);
+}
+
+static void check_destroy_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_cache_destroy(NULL),
+            TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_budget_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_cache_budget(NULL, (void *) 1),
+            TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_budget_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_cache_budget((void *) 1, NULL),
+            TRIGGERFISH_SOFT_CACHE_ERROR_OUT_IS_NULL);
+}
+
+static void check_budget(void **state) {
+    struct triggerfish_soft_cache *object;
+    assert_int_equal(triggerfish_soft_cache_of(42, &object), 0);
+    size_t out;
+    assert_int_equal(triggerfish_soft_cache_budget(object, &out), 0);
+    assert_int_equal(out, 42);
+    assert_int_equal(triggerfish_soft_cache_destroy(object), 0);
+}
+
+static void check_set_budget_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_cache_set_budget(NULL, 0),
+            TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_set_budget(void **state) {
+    struct triggerfish_soft_cache *object;
+    assert_int_equal(triggerfish_soft_cache_of(30, &object), 0);
+    struct triggerfish_soft *a = soft(object, 10);
+    struct triggerfish_soft *b = soft(object, 10);
+    struct triggerfish_soft *c = soft(object, 10);
+    expect_function_calls(on_destroy, 2);
+    assert_int_equal(triggerfish_soft_cache_set_budget(object, 15), 0);
+    assert_int_equal(object->budget, 15);
+    assert_int_equal(object->usage, 10);
+    assert_null(a->strong);
+    assert_null(b->strong);
+    assert_non_null(c->strong);
+    assert_int_equal(triggerfish_soft_destroy(a), 0);
+    assert_int_equal(triggerfish_soft_destroy(b), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_soft_destroy(c), 0);
+    assert_int_equal(triggerfish_soft_cache_destroy(object), 0);
+}
+
+static void check_usage_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_cache_usage(NULL, (void *) 1),
+            TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_usage_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_cache_usage((void *) 1, NULL),
+            TRIGGERFISH_SOFT_CACHE_ERROR_OUT_IS_NULL);
+}
+
+static void check_usage(void **state) {
+    struct triggerfish_soft_cache *object;
+    assert_int_equal(triggerfish_soft_cache_of(100, &object), 0);
+    struct triggerfish_soft *a = soft(object, 7);
+    size_t out;
+    assert_int_equal(triggerfish_soft_cache_usage(object, &out), 0);
+    assert_int_equal(out, 7);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_soft_destroy(a), 0);
+    assert_int_equal(triggerfish_soft_cache_usage(object, &out), 0);
+    assert_int_equal(out, 0);
+    assert_int_equal(triggerfish_soft_cache_destroy(object), 0);
+}
+
+static void check_shrink_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_cache_shrink(NULL, 0),
+            TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_shrink(void **state) {
+    struct triggerfish_soft_cache *object;
+    assert_int_equal(triggerfish_soft_cache_of(100, &object), 0);
+    struct triggerfish_soft *a = soft(object, 10);
+    struct triggerfish_soft *b = soft(object, 10);
+    struct triggerfish_soft *c = soft(object, 10);
+    /* a was used recently so the hand passes it once */
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_soft_strong(a, &strong), 0);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    expect_function_calls(on_destroy, 2);
+    assert_int_equal(triggerfish_soft_cache_shrink(object, 10), 0);
+    assert_int_equal(object->usage, 10);
+    assert_non_null(a->strong);
+    assert_false(a->referenced);
+    assert_null(b->strong);
+    assert_null(c->strong);
+    assert_ptr_equal(object->hand, a);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_soft_cache_shrink(object, 0), 0);
+    assert_null(object->hand);
+    assert_int_equal(triggerfish_soft_destroy(a), 0);
+    assert_int_equal(triggerfish_soft_destroy(b), 0);
+    assert_int_equal(triggerfish_soft_destroy(c), 0);
+    assert_int_equal(triggerfish_soft_cache_destroy(object), 0);
+}
+
+static void check_poll_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_cache_poll(NULL, (void *) 1, (void *) 1),
+            TRIGGERFISH_SOFT_CACHE_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_poll_error_on_path_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_cache_poll((void *) 1, NULL, (void *) 1),
+            TRIGGERFISH_SOFT_CACHE_ERROR_PATH_IS_NULL);
+}
+
+static void check_poll_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_soft_cache_poll((void *) 1, (void *) 1, NULL),
+            TRIGGERFISH_SOFT_CACHE_ERROR_OUT_IS_NULL);
+}
+
+static void check_poll_error_on_path_is_invalid(void **state) {
+    struct triggerfish_soft_cache *object;
+    assert_int_equal(triggerfish_soft_cache_of(100, &object), 0);
+    bool out;
+    assert_int_equal(
+            triggerfish_soft_cache_poll(object, "/triggerfish/missing", &out),
+            TRIGGERFISH_SOFT_CACHE_ERROR_PATH_IS_INVALID);
+    char path[] = "/tmp/triggerfish-test-soft-cache-XXXXXX";
+    const int fd = mkstemp(path);
+    assert_int_not_equal(fd, -1);
+    assert_int_equal(close(fd), 0);
+    write_file(path, "anything 1\n");
+    assert_int_equal(
+            triggerfish_soft_cache_poll(object, path, &out),
+            TRIGGERFISH_SOFT_CACHE_ERROR_PATH_IS_INVALID);
+    assert_int_equal(unlink(path), 0);
+    assert_int_equal(triggerfish_soft_cache_destroy(object), 0);
+}
+
+static void check_poll_pressure_stall_information(void **state) {
+    struct triggerfish_soft_cache *object;
+    assert_int_equal(triggerfish_soft_cache_of(100, &object), 0);
+    struct triggerfish_soft *a = soft(object, 10);
+    struct triggerfish_soft *b = soft(object, 10);
+    char path[] = "/tmp/triggerfish-test-soft-cache-XXXXXX";
+    const int fd = mkstemp(path);
+    assert_int_not_equal(fd, -1);
+    assert_int_equal(close(fd), 0);
+    write_file(path,
+               "some avg10=0.00 avg60=0.00 avg300=0.00 total=1000\n"
+               "full avg10=0.00 avg60=0.00 avg300=0.00 total=500\n");
+    bool out;
+    assert_int_equal(triggerfish_soft_cache_poll(object, path, &out), 0);
+    assert_false(out);
+    assert_int_equal(object->pressure, 1000);
+    assert_int_equal(triggerfish_soft_cache_poll(object, path, &out), 0);
+    assert_false(out);
+    write_file(path,
+               "some avg10=1.00 avg60=0.20 avg300=0.00 total=1500\n"
+               "full avg10=0.50 avg60=0.10 avg300=0.00 total=700\n");
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_soft_cache_poll(object, path, &out), 0);
+    assert_true(out);
+    assert_int_equal(object->usage, 10);
+    assert_null(a->strong);
+    assert_non_null(b->strong);
+    assert_int_equal(unlink(path), 0);
+    assert_int_equal(triggerfish_soft_destroy(a), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_soft_destroy(b), 0);
+    assert_int_equal(triggerfish_soft_cache_destroy(object), 0);
+}
+
+static void check_poll_memory_events(void **state) {
+    struct triggerfish_soft_cache *object;
+    assert_int_equal(triggerfish_soft_cache_of(100, &object), 0);
+    struct triggerfish_soft *a = soft(object, 10);
+    char path[] = "/tmp/triggerfish-test-soft-cache-XXXXXX";
+    const int fd = mkstemp(path);
+    assert_int_not_equal(fd, -1);
+    assert_int_equal(close(fd), 0);
+    write_file(path, "low 0\nhigh 2\nmax 0\noom 0\noom_kill 0\n");
+    bool out;
+    assert_int_equal(triggerfish_soft_cache_poll(object, path, &out), 0);
+    assert_false(out);
+    assert_int_equal(object->pressure, 2);
+    /* low events are not pressure on this cgroup */
+    write_file(path, "low 5\nhigh 2\nmax 0\noom 0\noom_kill 0\n");
+    assert_int_equal(triggerfish_soft_cache_poll(object, path, &out), 0);
+    assert_false(out);
+    write_file(path, "low 5\nhigh 2\nmax 1\noom 0\noom_kill 0\n");
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_soft_cache_poll(object, path, &out), 0);
+    assert_true(out);
+    assert_int_equal(object->usage, 0);
+    assert_int_equal(unlink(path), 0);
+    assert_int_equal(triggerfish_soft_destroy(a), 0);
+    assert_int_equal(triggerfish_soft_cache_destroy(object), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of_error_on_mutex_init_failed),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_destroy_error_on_object_is_null),
+            cmocka_unit_test(check_budget_error_on_object_is_null),
+            cmocka_unit_test(check_budget_error_on_out_is_null),
+            cmocka_unit_test(check_budget),
+            cmocka_unit_test(check_set_budget_error_on_object_is_null),
+            cmocka_unit_test(check_set_budget),
+            cmocka_unit_test(check_usage_error_on_object_is_null),
+            cmocka_unit_test(check_usage_error_on_out_is_null),
+            cmocka_unit_test(check_usage),
+            cmocka_unit_test(check_shrink_error_on_object_is_null),
+            cmocka_unit_test(check_shrink),
+            cmocka_unit_test(check_poll_error_on_object_is_null),
+            cmocka_unit_test(check_poll_error_on_path_is_null),
+            cmocka_unit_test(check_poll_error_on_out_is_null),
+            cmocka_unit_test(check_poll_error_on_path_is_invalid),
+            cmocka_unit_test(check_poll_pressure_stall_information),
+            cmocka_unit_test(check_poll_memory_events),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -5,6 +5,7 @@
 #include <cmocka.h>
 #include <string.h>
 #include <errno.h>
+#include <pthread.h>
 #include <triggerfish.h>
 
 #include "private/strong.h"
@@ -38,12 +39,14 @@ static void check_of_error_on_memory_allocation_failed(void **state) {
             TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED);
     malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
             posix_memalign_is_overridden = false;
+#if !defined(TRIGGERFISH_SINGLE_THREADED) && !defined(TRIGGERFISH_NO_WEAK)
     pthread_mutex_init_is_overridden = true;
     will_return(cmocka_test_pthread_mutex_init, ENOMEM);
     assert_int_equal(
             triggerfish_strong_of((void *) 1, (void *) 1, &out),
             TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED);
     pthread_mutex_init_is_overridden = false;
+#endif
 }
 
 static void on_destroy(void *instance) {
@@ -63,6 +66,110 @@ static void check_of(void **state) {
     assert_int_equal(triggerfish_strong_release(object), 0);
 }
 
+static void check_alias_of_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_strong_alias_of(NULL, (void *) 1, (void *) 1),
+            TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_alias_of_error_on_instance_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_strong_alias_of((void *) 1, NULL, (void *) 1),
+            TRIGGERFISH_STRONG_ERROR_INSTANCE_IS_NULL);
+}
+
+static void check_alias_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_strong_alias_of((void *) 1, (void *) 1, NULL),
+            TRIGGERFISH_STRONG_ERROR_OUT_IS_NULL);
+}
+
+static void check_alias_of_error_on_object_is_invalid(void **state) {
+    struct triggerfish_strong object = {};
+    struct triggerfish_strong *out;
+    assert_int_equal(
+            triggerfish_strong_alias_of(&object, (void *) 1, &out),
+            TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID);
+}
+
+static void check_alias_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &object), 0);
+    struct triggerfish_strong *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_strong_alias_of(object, object->instance, &out),
+            TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+    assert_int_equal(atomic_load(&object->counter), 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+}
+
+static void check_alias_of(void **state) {
+    uintmax_t *instance = calloc(4, sizeof(*instance));
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(instance, on_destroy, &object), 0);
+    struct triggerfish_strong *alias;
+    assert_int_equal(triggerfish_strong_alias_of(object, &instance[2], &alias),
+                     0);
+    assert_ptr_equal(alias->parent, object);
+    assert_int_equal(atomic_load(&object->counter), 2);
+    uintmax_t count;
+    assert_int_equal(triggerfish_strong_count(alias, &count), 0);
+    assert_int_equal(count, 2);
+    void *out;
+    assert_int_equal(triggerfish_strong_instance(alias, &out), 0);
+    assert_ptr_equal(out, &instance[2]);
+    assert_int_equal(triggerfish_strong_retain(alias),
+                     TRIGGERFISH_STRONG_ERROR_OBJECT_IS_ALIAS);
+    /* the alias alone keeps the instance alive */
+    assert_int_equal(triggerfish_strong_release(object), 0);
+    assert_int_equal(atomic_load(&object->counter), 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(alias), 0);
+}
+
+static void check_alias_of_alias(void **state) {
+    uintmax_t *instance = calloc(4, sizeof(*instance));
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(instance, on_destroy, &object), 0);
+    struct triggerfish_strong *alias;
+    assert_int_equal(triggerfish_strong_alias_of(object, &instance[2], &alias),
+                     0);
+    struct triggerfish_strong *other;
+    assert_int_equal(triggerfish_strong_alias_of(alias, &instance[3], &other),
+                     0);
+    assert_ptr_equal(other->parent, object);
+    assert_int_equal(atomic_load(&object->counter), 3);
+    /* freed while its parent lives on */
+    assert_int_equal(triggerfish_strong_release(alias), 0);
+    assert_int_equal(atomic_load(&object->counter), 2);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(other), 0);
+}
+
+static void check_alias_of_in_region(void **state) {
+    struct triggerfish_region *region;
+    assert_int_equal(triggerfish_region_of(&region), 0);
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_region_strong_of(
+            region, 2 * sizeof(uintmax_t), on_destroy, &object), 0);
+    struct triggerfish_strong *alias;
+    assert_int_equal(triggerfish_strong_alias_of(
+            object, (uintmax_t *) object->instance + 1, &alias), 0);
+    uintmax_t count;
+    assert_int_equal(triggerfish_region_count(region, &count), 0);
+    assert_int_equal(count, 3);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+    assert_int_equal(triggerfish_region_release(region), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(alias), 0);
+}
+
 static void check_count_error_on_object_is_null(void **state) {
     assert_int_equal(
             triggerfish_strong_count(NULL, (void *) 1),
@@ -159,14 +266,18 @@ static void check_instance(void **state) {
     assert_int_equal(triggerfish_strong_release(object), 0);
 }
 
+#ifndef TRIGGERFISH_NO_WEAK
+#ifndef TRIGGERFISH_SINGLE_THREADED
 static void check_register_error_on_object_is_invalid(void **state) {
+    struct triggerfish_strong object = {};
     pthread_mutex_lock_is_overridden = true;
     will_return(cmocka_test_pthread_mutex_lock, EINVAL);
     assert_int_equal(
-            triggerfish_strong_register((void *) 1, (void *) 1),
+            triggerfish_strong_register(&object, (void *) 1),
             TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID);
     pthread_mutex_lock_is_overridden = false;
 }
+#endif
 
 static void check_register_error_on_weak_already_registered(void **state) {
     struct triggerfish_strong *object;
@@ -194,6 +305,336 @@ static void check_register_error_on_memory_allocation_failed(void **state) {
     expect_function_call(on_destroy);
     assert_int_equal(triggerfish_strong_release(object), 0);
 }
+#endif
+
+static void check_is_unique_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_strong_is_unique(NULL, (void *) 1),
+            TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_is_unique_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_strong_is_unique((void *) 1, NULL),
+            TRIGGERFISH_STRONG_ERROR_OUT_IS_NULL);
+}
+
+#if !defined(TRIGGERFISH_SINGLE_THREADED) && !defined(TRIGGERFISH_NO_WEAK)
+static void check_is_unique_error_on_object_is_invalid(void **state) {
+    struct triggerfish_strong object = {};
+    bool out;
+    pthread_mutex_lock_is_overridden = true;
+    will_return(cmocka_test_pthread_mutex_lock, EINVAL);
+    assert_int_equal(
+            triggerfish_strong_is_unique(&object, &out),
+            TRIGGERFISH_STRONG_ERROR_OBJECT_IS_INVALID);
+    pthread_mutex_lock_is_overridden = false;
+}
+#endif
+
+static void check_is_unique(void **state) {
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &object), 0);
+    bool out;
+    assert_int_equal(triggerfish_strong_is_unique(object, &out), 0);
+    assert_true(out);
+    assert_int_equal(triggerfish_strong_retain(object), 0);
+    assert_int_equal(triggerfish_strong_is_unique(object, &out), 0);
+    assert_false(out);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+#ifndef TRIGGERFISH_NO_WEAK
+    struct triggerfish_weak *weak;
+    assert_int_equal(triggerfish_weak_of(object, &weak), 0);
+    assert_int_equal(triggerfish_strong_is_unique(object, &out), 0);
+    assert_false(out);
+    assert_int_equal(triggerfish_weak_destroy(weak), 0);
+    assert_int_equal(triggerfish_strong_is_unique(object, &out), 0);
+    assert_true(out);
+#endif
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+}
+
+static void check_is_unique_alias(void **state) {
+    unsigned char *instance = malloc(2);
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(instance, on_destroy, &object), 0);
+    struct triggerfish_strong *alias;
+    assert_int_equal(triggerfish_strong_alias_of(object, &instance[1], &alias),
+                     0);
+    /* the parent still has a second holder */
+    bool out;
+    assert_int_equal(triggerfish_strong_is_unique(alias, &out), 0);
+    assert_false(out);
+    assert_int_equal(triggerfish_strong_is_unique(object, &out), 0);
+    assert_false(out);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+    assert_int_equal(triggerfish_strong_is_unique(alias, &out), 0);
+    assert_true(out);
+#ifndef TRIGGERFISH_NO_WEAK
+    struct triggerfish_weak *weak;
+    assert_int_equal(triggerfish_weak_of(object, &weak), 0);
+    assert_int_equal(triggerfish_strong_is_unique(alias, &out), 0);
+    assert_false(out);
+    assert_int_equal(triggerfish_weak_destroy(weak), 0);
+#endif
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(alias), 0);
+}
+
+static void check_is_unique_in_region(void **state) {
+    struct triggerfish_region *region;
+    assert_int_equal(triggerfish_region_of(&region), 0);
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_region_strong_of(
+            region, 1, NULL, &object), 0);
+    bool out = true;
+    assert_int_equal(triggerfish_strong_is_unique(object, &out), 0);
+    assert_false(out);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+    assert_int_equal(triggerfish_region_release(region), 0);
+}
+
+static int copy(const void *instance, void **out) {
+    function_called();
+    if (!(*out = malloc(1))) {
+        return TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    memcpy(*out, instance, 1);
+    return 0;
+}
+
+static void check_make_unique_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_strong_make_unique(NULL, copy),
+            TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL);
+    struct triggerfish_strong *object = NULL;
+    assert_int_equal(
+            triggerfish_strong_make_unique(&object, copy),
+            TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_make_unique_error_on_clone_is_null(void **state) {
+    struct triggerfish_strong *object = (void *) 1;
+    assert_int_equal(
+            triggerfish_strong_make_unique(&object, NULL),
+            TRIGGERFISH_STRONG_ERROR_CLONE_IS_NULL);
+}
+
+static void check_make_unique_when_unique(void **state) {
+    void *instance = malloc(1);
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(instance, on_destroy, &object), 0);
+    struct triggerfish_strong *const original = object;
+    assert_int_equal(triggerfish_strong_make_unique(&object, copy), 0);
+    assert_ptr_equal(object, original);
+    assert_ptr_equal(object->instance, instance);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+}
+
+static void check_make_unique_when_shared(void **state) {
+    unsigned char *instance = malloc(1);
+    *instance = 42;
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(instance, on_destroy, &object), 0);
+    assert_int_equal(triggerfish_strong_retain(object), 0);
+    struct triggerfish_strong *const original = object;
+    expect_function_call(copy);
+    assert_int_equal(triggerfish_strong_make_unique(&object, copy), 0);
+    assert_ptr_not_equal(object, original);
+    assert_ptr_not_equal(object->instance, instance);
+    assert_int_equal(*(unsigned char *) object->instance, 42);
+    assert_ptr_equal(object->on_destroy, on_destroy);
+    assert_int_equal(atomic_load(&original->counter), 1);
+    assert_int_equal(atomic_load(&object->counter), 1);
+    expect_function_calls(on_destroy, 2);
+    assert_int_equal(triggerfish_strong_release(original), 0);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+}
+
+static void check_make_unique_alias_when_shared(void **state) {
+    unsigned char *instance = malloc(2);
+    instance[1] = 42;
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(instance, on_destroy, &object), 0);
+    struct triggerfish_strong *alias;
+    assert_int_equal(triggerfish_strong_alias_of(object, &instance[1], &alias),
+                     0);
+    struct triggerfish_strong *const original = alias;
+    expect_function_call(copy);
+    assert_int_equal(triggerfish_strong_make_unique(&alias, copy), 0);
+    assert_ptr_not_equal(alias, original);
+    assert_null(alias->parent);
+    assert_int_equal(*(unsigned char *) alias->instance, 42);
+    assert_int_equal(atomic_load(&object->counter), 1);
+    assert_int_equal(triggerfish_strong_release(alias), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+}
+
+static int copy_failed(const void *instance, void **out) {
+    return TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED;
+}
+
+static void check_make_unique_error_on_clone_failed(void **state) {
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &object), 0);
+    assert_int_equal(triggerfish_strong_retain(object), 0);
+    struct triggerfish_strong *const original = object;
+    assert_int_equal(
+            triggerfish_strong_make_unique(&object, copy_failed),
+            TRIGGERFISH_STRONG_ERROR_MEMORY_ALLOCATION_FAILED);
+    assert_ptr_equal(object, original);
+    assert_int_equal(atomic_load(&object->counter), 2);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+}
+
+static void check_wait_unique_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_strong_wait_unique(NULL, NULL),
+            TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_wait_unique_error_on_timeout_is_invalid(void **state) {
+    const struct timespec timeout = {.tv_nsec = 1000000000L};
+    assert_int_equal(
+            triggerfish_strong_wait_unique((void *) 1, &timeout),
+            TRIGGERFISH_STRONG_ERROR_TIMEOUT_IS_INVALID);
+}
+
+static void check_wait_unique_error_on_timed_out(void **state) {
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &object), 0);
+    assert_int_equal(triggerfish_strong_retain(object), 0);
+    const struct timespec timeout = {.tv_nsec = 1000000};
+    assert_int_equal(
+            triggerfish_strong_wait_unique(object, &timeout),
+            TRIGGERFISH_STRONG_ERROR_TIMED_OUT);
+    assert_true(atomic_load(&object->counter) & TRIGGERFISH_COUNTER_WAITING);
+    uintmax_t count;
+    assert_int_equal(triggerfish_strong_count(object, &count), 0);
+    assert_int_equal(count, 2);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+    assert_int_equal(atomic_load(&object->counter), 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+}
+
+static void check_wait_unique(void **state) {
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &object), 0);
+    assert_int_equal(triggerfish_strong_wait_unique(object, NULL), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+}
+
+#ifndef TRIGGERFISH_SINGLE_THREADED
+static void *release_later(void *arg) {
+    struct triggerfish_strong *const object = arg;
+    const struct timespec delay = {.tv_nsec = 10000000};
+    nanosleep(&delay, NULL);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+    return NULL;
+}
+
+static void check_wait_unique_until_released(void **state) {
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &object), 0);
+    pthread_t threads[4];
+    for (uintmax_t i = 0; i < 4; i++) {
+        assert_int_equal(triggerfish_strong_retain(object), 0);
+        assert_int_equal(pthread_create(
+                &threads[i], NULL, release_later, object), 0);
+    }
+    assert_int_equal(triggerfish_strong_wait_unique(object, NULL), 0);
+    uintmax_t count;
+    assert_int_equal(triggerfish_strong_count(object, &count), 0);
+    assert_int_equal(count, 1);
+    for (uintmax_t i = 0; i < 4; i++) {
+        assert_int_equal(pthread_join(threads[i], NULL), 0);
+    }
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+}
+#endif
+
+static void check_release_wait_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_strong_release_wait(NULL, NULL),
+            TRIGGERFISH_STRONG_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_release_wait_error_on_timeout_is_invalid(void **state) {
+    const struct timespec timeout = {.tv_sec = -1};
+    assert_int_equal(
+            triggerfish_strong_release_wait((void *) 1, &timeout),
+            TRIGGERFISH_STRONG_ERROR_TIMEOUT_IS_INVALID);
+}
+
+static void check_release_wait_error_on_timed_out(void **state) {
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &object), 0);
+    assert_int_equal(triggerfish_strong_retain(object), 0);
+    const struct timespec timeout = {0};
+    assert_int_equal(
+            triggerfish_strong_release_wait(object, &timeout),
+            TRIGGERFISH_STRONG_ERROR_TIMED_OUT);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(object), 0);
+}
+
+#ifndef TRIGGERFISH_SINGLE_THREADED
+static void check_release_wait_until_released(void **state) {
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &object), 0);
+    pthread_t threads[4];
+    for (uintmax_t i = 0; i < 4; i++) {
+        assert_int_equal(triggerfish_strong_retain(object), 0);
+        assert_int_equal(pthread_create(
+                &threads[i], NULL, release_later, object), 0);
+    }
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release_wait(object, NULL), 0);
+    for (uintmax_t i = 0; i < 4; i++) {
+        assert_int_equal(pthread_join(threads[i], NULL), 0);
+    }
+}
+
+static void check_release_wait_alias(void **state) {
+    unsigned char *instance = malloc(2);
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_strong_of(instance, on_destroy, &object), 0);
+    struct triggerfish_strong *alias;
+    assert_int_equal(triggerfish_strong_alias_of(object, &instance[1], &alias),
+                     0);
+    pthread_t thread;
+    assert_int_equal(pthread_create(&thread, NULL, release_later, object), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release_wait(alias, NULL), 0);
+    assert_int_equal(pthread_join(thread, NULL), 0);
+}
+
+static void check_release_wait_in_region(void **state) {
+    struct triggerfish_region *region;
+    assert_int_equal(triggerfish_region_of(&region), 0);
+    struct triggerfish_strong *object;
+    assert_int_equal(triggerfish_region_strong_of(
+            region, 1, on_destroy, &object), 0);
+    const struct timespec timeout = {.tv_nsec = 1000000};
+    assert_int_equal(
+            triggerfish_strong_wait_unique(object, &timeout),
+            TRIGGERFISH_STRONG_ERROR_TIMED_OUT);
+    pthread_t thread;
+    assert_int_equal(pthread_create(&thread, NULL, release_later, object), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release_wait(object, NULL), 0);
+    assert_int_equal(pthread_join(thread, NULL), 0);
+}
+#endif
 
 int main(int argc, char *argv[]) {
     const struct CMUnitTest tests[] = {
@@ -202,6 +643,14 @@ int main(int argc, char *argv[]) {
             cmocka_unit_test(check_of_error_on_out_is_null),
             cmocka_unit_test(check_of_error_on_memory_allocation_failed),
             cmocka_unit_test(check_of),
+            cmocka_unit_test(check_alias_of_error_on_object_is_null),
+            cmocka_unit_test(check_alias_of_error_on_instance_is_null),
+            cmocka_unit_test(check_alias_of_error_on_out_is_null),
+            cmocka_unit_test(check_alias_of_error_on_object_is_invalid),
+            cmocka_unit_test(check_alias_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_alias_of),
+            cmocka_unit_test(check_alias_of_alias),
+            cmocka_unit_test(check_alias_of_in_region),
             cmocka_unit_test(check_count_error_on_object_is_null),
             cmocka_unit_test(check_count_error_on_out_is_null),
             cmocka_unit_test(check_count),
@@ -210,13 +659,46 @@ int main(int argc, char *argv[]) {
             cmocka_unit_test(check_retain),
             cmocka_unit_test(check_release_error_on_object_is_null),
             cmocka_unit_test(check_release),
+            cmocka_unit_test(check_wait_unique_error_on_object_is_null),
+            cmocka_unit_test(check_wait_unique_error_on_timeout_is_invalid),
+            cmocka_unit_test(check_wait_unique_error_on_timed_out),
+            cmocka_unit_test(check_wait_unique),
+#ifndef TRIGGERFISH_SINGLE_THREADED
+            cmocka_unit_test(check_wait_unique_until_released),
+#endif
+            cmocka_unit_test(check_release_wait_error_on_object_is_null),
+            cmocka_unit_test(check_release_wait_error_on_timeout_is_invalid),
+            cmocka_unit_test(check_release_wait_error_on_timed_out),
+#ifndef TRIGGERFISH_SINGLE_THREADED
+            cmocka_unit_test(check_release_wait_until_released),
+            cmocka_unit_test(check_release_wait_alias),
+            cmocka_unit_test(check_release_wait_in_region),
+#endif
             cmocka_unit_test(check_instance_error_on_object_is_null),
             cmocka_unit_test(check_instance_error_on_out_is_null),
             cmocka_unit_test(check_instance_error_on_object_is_invalid),
             cmocka_unit_test(check_instance),
+#ifndef TRIGGERFISH_NO_WEAK
+#ifndef TRIGGERFISH_SINGLE_THREADED
             cmocka_unit_test(check_register_error_on_object_is_invalid),
+#endif
             cmocka_unit_test(check_register_error_on_weak_already_registered),
             cmocka_unit_test(check_register_error_on_memory_allocation_failed),
+#endif
+            cmocka_unit_test(check_is_unique_error_on_object_is_null),
+            cmocka_unit_test(check_is_unique_error_on_out_is_null),
+#if !defined(TRIGGERFISH_SINGLE_THREADED) && !defined(TRIGGERFISH_NO_WEAK)
+            cmocka_unit_test(check_is_unique_error_on_object_is_invalid),
+#endif
+            cmocka_unit_test(check_is_unique),
+            cmocka_unit_test(check_is_unique_alias),
+            cmocka_unit_test(check_is_unique_in_region),
+            cmocka_unit_test(check_make_unique_error_on_object_is_null),
+            cmocka_unit_test(check_make_unique_error_on_clone_is_null),
+            cmocka_unit_test(check_make_unique_when_unique),
+            cmocka_unit_test(check_make_unique_when_shared),
+            cmocka_unit_test(check_make_unique_alias_when_shared),
+            cmocka_unit_test(check_make_unique_error_on_clone_failed),
     };
     //cmocka_set_message_output(CM_OUTPUT_XML);
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,303 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <errno.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/teardown.h"
+
+#include <test/cmocka.h>
+
+#define WORKERS     4
+#define FANOUT      4
+#define DEPTH       7
+#define LENGTH      100000
+
+struct node {
+    struct triggerfish_teardown *teardown;
+    struct triggerfish_strong *children[FANOUT];
+};
+
+static atomic_uintmax_t destroyed;
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static void on_destroy_node(void *instance) {
+    assert_non_null(instance);
+    struct node *const node = instance;
+    for (uintmax_t i = 0; i < FANOUT; i++) {
+        if (node->children[i]) {
+            assert_int_equal(triggerfish_strong_release(node->children[i]),
+                             0);
+        }
+    }
+    atomic_fetch_add(&destroyed, 1);
+}
+
+static void on_destroy_wait(void *instance) {
+    assert_non_null(instance);
+    struct node *const node = instance;
+    if (node->children[0]) {
+        assert_int_equal(triggerfish_strong_release_wait(node->children[0],
+                                                         NULL), 0);
+    }
+    atomic_fetch_add(&destroyed, 1);
+}
+
+static void on_destroy_nested(void *instance) {
+    assert_non_null(instance);
+    struct node *const node = instance;
+    assert_int_equal(triggerfish_teardown_release(node->teardown,
+                                                  node->children[0]), 0);
+    atomic_fetch_add(&destroyed, 1);
+}
+
+static struct triggerfish_strong *node_of(
+        void (*const on_destroy)(void *instance)) {
+    struct node *const node = calloc(1, sizeof(*node));
+    assert_non_null(node);
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_strong_of(node, on_destroy, &out), 0);
+    return out;
+}
+
+/* tree of FANOUT^depth leaves, counting the created nodes */
+static struct triggerfish_strong *tree_of(const uintmax_t depth,
+                                          uintmax_t *const count) {
+    struct triggerfish_strong *const out = node_of(on_destroy_node);
+    (*count)++;
+    if (depth) {
+        struct node *node;
+        assert_int_equal(triggerfish_strong_instance(out, (void **) &node), 0);
+        for (uintmax_t i = 0; i < FANOUT; i++) {
+            node->children[i] = tree_of(depth - 1, count);
+        }
+    }
+    return out;
+}
+
+static void check_of_error_on_workers_is_zero(void **state) {
+    assert_int_equal(
+            triggerfish_teardown_of(0, (void *) 1),
+            TRIGGERFISH_TEARDOWN_ERROR_WORKERS_IS_ZERO);
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_teardown_of(1, NULL),
+            TRIGGERFISH_TEARDOWN_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_teardown *out;
+    assert_int_equal(
+            triggerfish_teardown_of(SIZE_MAX, &out),
+            TRIGGERFISH_TEARDOWN_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_teardown_of(1, &out),
+            TRIGGERFISH_TEARDOWN_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+    pthread_mutex_init_is_overridden = true;
+    will_return(cmocka_test_pthread_mutex_init, ENOMEM);
+    assert_int_equal(
+            triggerfish_teardown_of(1, &out),
+            TRIGGERFISH_TEARDOWN_ERROR_MEMORY_ALLOCATION_FAILED);
+    pthread_mutex_init_is_overridden = false;
+}
+
+static void check_of(void **state) {
+    struct triggerfish_teardown *object;
+    assert_int_equal(triggerfish_teardown_of(WORKERS, &object), 0);
+    assert_int_equal(object->count, WORKERS);
+    assert_int_equal(atomic_load(&object->pending), 0);
+    for (uintmax_t i = 0; i < WORKERS; i++) {
+        assert_ptr_equal(object->workers[i].teardown, object);
+        assert_int_equal(object->workers[i].capacity,
+                         TRIGGERFISH_TEARDOWN_DEQUE);
+        assert_non_null(object->workers[i].deque);
+    }
+    assert_int_equal(triggerfish_teardown_destroy(object), 0);
+}
+
+static void check_destroy_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_teardown_destroy(NULL),
+            TRIGGERFISH_TEARDOWN_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_release_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_teardown_release(NULL, (void *) 1),
+            TRIGGERFISH_TEARDOWN_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_release_error_on_strong_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_teardown_release((void *) 1, NULL),
+            TRIGGERFISH_TEARDOWN_ERROR_STRONG_IS_NULL);
+}
+
+static void check_release(void **state) {
+    struct triggerfish_teardown *object;
+    assert_int_equal(triggerfish_teardown_of(WORKERS, &object), 0);
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong),
+                     0);
+    assert_int_equal(triggerfish_strong_retain(strong), 0);
+    assert_int_equal(triggerfish_teardown_release(object, strong), 0);
+    uintmax_t count;
+    assert_int_equal(triggerfish_strong_count(strong, &count), 0);
+    assert_int_equal(count, 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_teardown_release(object, strong), 0);
+    assert_int_equal(triggerfish_teardown_destroy(object), 0);
+}
+
+static void release_tree(const size_t workers) {
+    atomic_store(&destroyed, 0);
+    struct triggerfish_teardown *object;
+    assert_int_equal(triggerfish_teardown_of(workers, &object), 0);
+    uintmax_t count = 0;
+    struct triggerfish_strong *const strong = tree_of(DEPTH, &count);
+    assert_int_equal(triggerfish_teardown_release(object, strong), 0);
+    assert_int_equal(atomic_load(&destroyed), count);
+    assert_int_equal(atomic_load(&object->pending), 0);
+    for (uintmax_t i = 0; i < object->count; i++) {
+        assert_int_equal(object->workers[i].batched, 0);
+        assert_int_equal(object->workers[i].top,
+                         object->workers[i].bottom);
+    }
+    assert_int_equal(triggerfish_teardown_destroy(object), 0);
+}
+
+static void check_release_tree(void **state) {
+    release_tree(1);
+}
+
+static void check_release_tree_concurrently(void **state) {
+    release_tree(WORKERS);
+    /* the threads are reused by the next release */
+    struct triggerfish_teardown *object;
+    assert_int_equal(triggerfish_teardown_of(WORKERS, &object), 0);
+    for (uintmax_t i = 0; i < 3; i++) {
+        atomic_store(&destroyed, 0);
+        uintmax_t count = 0;
+        struct triggerfish_strong *const strong = tree_of(DEPTH - 2, &count);
+        assert_int_equal(triggerfish_teardown_release(object, strong), 0);
+        assert_int_equal(atomic_load(&destroyed), count);
+    }
+    assert_int_equal(triggerfish_teardown_destroy(object), 0);
+}
+
+static void check_release_shared(void **state) {
+    atomic_store(&destroyed, 0);
+    struct triggerfish_teardown *object;
+    assert_int_equal(triggerfish_teardown_of(WORKERS, &object), 0);
+    /* every child of the root is the same tree */
+    uintmax_t count = 0;
+    struct triggerfish_strong *const shared = tree_of(DEPTH - 2, &count);
+    struct triggerfish_strong *const strong = node_of(on_destroy_node);
+    count++;
+    struct node *node;
+    assert_int_equal(triggerfish_strong_instance(strong, (void **) &node), 0);
+    for (uintmax_t i = 0; i < FANOUT; i++) {
+        assert_int_equal(triggerfish_strong_retain(shared), 0);
+        node->children[i] = shared;
+    }
+    assert_int_equal(triggerfish_strong_release(shared), 0);
+    assert_int_equal(triggerfish_teardown_release(object, strong), 0);
+    assert_int_equal(atomic_load(&destroyed), count);
+    assert_int_equal(triggerfish_teardown_destroy(object), 0);
+}
+
+static void check_release_chain(void **state) {
+    atomic_store(&destroyed, 0);
+    struct triggerfish_teardown *object;
+    assert_int_equal(triggerfish_teardown_of(1, &object), 0);
+    /* too long to be destroyed recursively */
+    struct triggerfish_strong *strong = NULL;
+    for (uintmax_t i = 0; i < LENGTH; i++) {
+        struct triggerfish_strong *const next = node_of(on_destroy_node);
+        struct node *node;
+        assert_int_equal(triggerfish_strong_instance(next, (void **) &node),
+                         0);
+        node->children[0] = strong;
+        strong = next;
+    }
+    assert_int_equal(triggerfish_teardown_release(object, strong), 0);
+    assert_int_equal(atomic_load(&destroyed), LENGTH);
+    assert_int_equal(triggerfish_teardown_destroy(object), 0);
+}
+
+static void check_release_wait_chain(void **state) {
+    atomic_store(&destroyed, 0);
+    struct triggerfish_teardown *object;
+    assert_int_equal(triggerfish_teardown_of(1, &object), 0);
+    /* too long to be destroyed recursively */
+    struct triggerfish_strong *strong = NULL;
+    for (uintmax_t i = 0; i < LENGTH; i++) {
+        struct triggerfish_strong *const next = node_of(on_destroy_wait);
+        struct node *node;
+        assert_int_equal(triggerfish_strong_instance(next, (void **) &node),
+                         0);
+        node->children[0] = strong;
+        strong = next;
+    }
+    assert_int_equal(triggerfish_teardown_release(object, strong), 0);
+    assert_int_equal(atomic_load(&destroyed), LENGTH);
+    assert_int_equal(triggerfish_teardown_destroy(object), 0);
+}
+
+static void check_release_nested(void **state) {
+    atomic_store(&destroyed, 0);
+    struct triggerfish_teardown *object;
+    assert_int_equal(triggerfish_teardown_of(WORKERS, &object), 0);
+    struct triggerfish_strong *const strong = node_of(on_destroy_nested);
+    struct node *node;
+    assert_int_equal(triggerfish_strong_instance(strong, (void **) &node), 0);
+    node->teardown = object;
+    uintmax_t count = 1;
+    node->children[0] = tree_of(DEPTH - 2, &count);
+    assert_int_equal(triggerfish_teardown_release(object, strong), 0);
+    assert_int_equal(atomic_load(&destroyed), count);
+    assert_int_equal(triggerfish_teardown_destroy(object), 0);
+}
+
+static void check_release_without_teardown(void **state) {
+    atomic_store(&destroyed, 0);
+    uintmax_t count = 0;
+    struct triggerfish_strong *const strong = tree_of(DEPTH - 2, &count);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    assert_int_equal(atomic_load(&destroyed), count);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_workers_is_zero),
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_destroy_error_on_object_is_null),
+            cmocka_unit_test(check_release_error_on_object_is_null),
+            cmocka_unit_test(check_release_error_on_strong_is_null),
+            cmocka_unit_test(check_release),
+            cmocka_unit_test(check_release_tree),
+            cmocka_unit_test(check_release_tree_concurrently),
+            cmocka_unit_test(check_release_shared),
+            cmocka_unit_test(check_release_chain),
+            cmocka_unit_test(check_release_wait_chain),
+            cmocka_unit_test(check_release_nested),
+            cmocka_unit_test(check_release_without_teardown),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
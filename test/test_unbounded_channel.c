@@ -0,0 +1,326 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/unbounded_channel.h"
+
+#include <test/cmocka.h>
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static struct triggerfish_strong *strong(void) {
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &out), 0);
+    return out;
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unbounded_channel_of(NULL),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_unbounded_channel *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_unbounded_channel_of(&out),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+}
+
+static void check_of(void **state) {
+    struct triggerfish_unbounded_channel *object;
+    assert_int_equal(triggerfish_unbounded_channel_of(&object), 0);
+    assert_non_null(object);
+    assert_non_null(object->tail);
+    assert_ptr_equal(atomic_load(&object->head), object->tail);
+    assert_null(atomic_load(&object->tail->next));
+    assert_int_equal(triggerfish_unbounded_channel_destroy(object), 0);
+}
+
+static void check_destroy_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unbounded_channel_destroy(NULL),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_destroy(void **state) {
+    struct triggerfish_unbounded_channel *object;
+    assert_int_equal(triggerfish_unbounded_channel_of(&object), 0);
+    for (uintmax_t i = 0; i < 3; i++) {
+        assert_int_equal(triggerfish_unbounded_channel_send(
+                object, strong()), 0);
+    }
+    expect_function_calls(on_destroy, 3);
+    assert_int_equal(triggerfish_unbounded_channel_destroy(object), 0);
+}
+
+static void check_send_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unbounded_channel_send(NULL, (void *) 1),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_send_error_on_strong_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unbounded_channel_send((void *) 1, NULL),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_STRONG_IS_NULL);
+}
+
+static void check_send_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_unbounded_channel *object;
+    assert_int_equal(triggerfish_unbounded_channel_of(&object), 0);
+    struct triggerfish_strong *a = strong();
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_unbounded_channel_send(object, a),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(a), 0);
+    assert_int_equal(triggerfish_unbounded_channel_destroy(object), 0);
+}
+
+static void check_send(void **state) {
+    struct triggerfish_unbounded_channel *object;
+    assert_int_equal(triggerfish_unbounded_channel_of(&object), 0);
+    struct triggerfish_strong *a = strong();
+    assert_int_equal(triggerfish_unbounded_channel_send(object, a), 0);
+    struct triggerfish_unbounded_channel_node *node
+            = atomic_load(&object->tail->next);
+    assert_non_null(node);
+    assert_ptr_equal(atomic_load(&object->head), node);
+    assert_ptr_equal(node->strong, a);
+    /* ownership is handed over without touching the reference count */
+    assert_int_equal(atomic_load(&a->counter), 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_unbounded_channel_destroy(object), 0);
+}
+
+static void check_send_batch_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unbounded_channel_send_batch(NULL, (void *) 1, 1),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_send_batch_error_on_items_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unbounded_channel_send_batch((void *) 1, NULL, 1),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_ITEMS_IS_NULL);
+}
+
+static void check_send_batch_error_on_count_is_zero(void **state) {
+    assert_int_equal(
+            triggerfish_unbounded_channel_send_batch((void *) 1,
+                                                     (void *) 1, 0),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_COUNT_IS_ZERO);
+}
+
+static void check_send_batch(void **state) {
+    struct triggerfish_unbounded_channel *object;
+    assert_int_equal(triggerfish_unbounded_channel_of(&object), 0);
+    struct triggerfish_strong *items[3];
+    for (uintmax_t i = 0; i < 3; i++) {
+        items[i] = strong();
+    }
+    assert_int_equal(triggerfish_unbounded_channel_send_batch(
+            object, items, 3), 0);
+    struct triggerfish_unbounded_channel_node *node = object->tail;
+    for (uintmax_t i = 0; i < 3; i++) {
+        node = atomic_load(&node->next);
+        assert_ptr_equal(node->strong, items[i]);
+    }
+    assert_ptr_equal(atomic_load(&object->head), node);
+    assert_null(atomic_load(&node->next));
+    expect_function_calls(on_destroy, 3);
+    assert_int_equal(triggerfish_unbounded_channel_destroy(object), 0);
+}
+
+static void check_receive_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unbounded_channel_receive(NULL, (void *) 1),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_receive_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unbounded_channel_receive((void *) 1, NULL),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OUT_IS_NULL);
+}
+
+static void check_receive_error_on_channel_is_empty(void **state) {
+    struct triggerfish_unbounded_channel *object;
+    assert_int_equal(triggerfish_unbounded_channel_of(&object), 0);
+    struct triggerfish_strong *out;
+    assert_int_equal(
+            triggerfish_unbounded_channel_receive(object, &out),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_CHANNEL_IS_EMPTY);
+    assert_int_equal(triggerfish_unbounded_channel_destroy(object), 0);
+}
+
+static void check_receive(void **state) {
+    struct triggerfish_unbounded_channel *object;
+    assert_int_equal(triggerfish_unbounded_channel_of(&object), 0);
+    struct triggerfish_strong *a = strong();
+    struct triggerfish_strong *b = strong();
+    assert_int_equal(triggerfish_unbounded_channel_send(object, a), 0);
+    assert_int_equal(triggerfish_unbounded_channel_send(object, b), 0);
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_unbounded_channel_receive(object, &out), 0);
+    assert_ptr_equal(out, a);
+    assert_int_equal(triggerfish_unbounded_channel_receive(object, &out), 0);
+    assert_ptr_equal(out, b);
+    assert_ptr_equal(atomic_load(&object->head), object->tail);
+    assert_int_equal(atomic_load(&a->counter), 1);
+    expect_function_calls(on_destroy, 2);
+    assert_int_equal(triggerfish_strong_release(a), 0);
+    assert_int_equal(triggerfish_strong_release(b), 0);
+    assert_int_equal(triggerfish_unbounded_channel_destroy(object), 0);
+}
+
+static void check_receive_batch_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unbounded_channel_receive_batch(
+                    NULL, (void *) 1, 1, (void *) 1),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_receive_batch_error_on_items_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unbounded_channel_receive_batch(
+                    (void *) 1, NULL, 1, (void *) 1),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_ITEMS_IS_NULL);
+}
+
+static void check_receive_batch_error_on_count_is_zero(void **state) {
+    assert_int_equal(
+            triggerfish_unbounded_channel_receive_batch(
+                    (void *) 1, (void *) 1, 0, (void *) 1),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_COUNT_IS_ZERO);
+}
+
+static void check_receive_batch_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unbounded_channel_receive_batch(
+                    (void *) 1, (void *) 1, 1, NULL),
+            TRIGGERFISH_UNBOUNDED_CHANNEL_ERROR_OUT_IS_NULL);
+}
+
+static void check_receive_batch(void **state) {
+    struct triggerfish_unbounded_channel *object;
+    assert_int_equal(triggerfish_unbounded_channel_of(&object), 0);
+    struct triggerfish_strong *items[3];
+    for (uintmax_t i = 0; i < 3; i++) {
+        items[i] = strong();
+    }
+    assert_int_equal(triggerfish_unbounded_channel_send_batch(
+            object, items, 3), 0);
+    struct triggerfish_strong *received[4] = {};
+    uintmax_t out;
+    assert_int_equal(triggerfish_unbounded_channel_receive_batch(
+            object, received, 2, &out), 0);
+    assert_int_equal(out, 2);
+    assert_int_equal(triggerfish_unbounded_channel_receive_batch(
+            object, received + 2, 2, &out), 0);
+    assert_int_equal(out, 1);
+    for (uintmax_t i = 0; i < 3; i++) {
+        assert_ptr_equal(received[i], items[i]);
+    }
+    expect_function_calls(on_destroy, 3);
+    for (uintmax_t i = 0; i < 3; i++) {
+        assert_int_equal(triggerfish_strong_release(items[i]), 0);
+    }
+    assert_int_equal(triggerfish_unbounded_channel_destroy(object), 0);
+}
+
+#define THREADS     4
+#define MESSAGES    10000
+
+static void ignore(void *instance) {
+}
+
+static void *produce(void *arg) {
+    struct triggerfish_unbounded_channel *object = arg;
+    for (uintmax_t i = 0; i < MESSAGES; i++) {
+        struct triggerfish_strong *item;
+        assert_int_equal(triggerfish_strong_of(malloc(1), ignore, &item), 0);
+        assert_int_equal(triggerfish_unbounded_channel_send(object, item), 0);
+    }
+    return NULL;
+}
+
+static void check_concurrent_send_and_receive(void **state) {
+    struct triggerfish_unbounded_channel *object;
+    assert_int_equal(triggerfish_unbounded_channel_of(&object), 0);
+    pthread_t producers[THREADS];
+    for (uintmax_t i = 0; i < THREADS; i++) {
+        assert_int_equal(pthread_create(&producers[i], NULL, produce,
+                                        object), 0);
+    }
+    struct triggerfish_strong *items[8];
+    uintmax_t received = 0;
+    while (received < THREADS * MESSAGES) {
+        uintmax_t count;
+        if (triggerfish_unbounded_channel_receive_batch(
+                object, items, 8, &count)) {
+            sched_yield();
+            continue;
+        }
+        for (uintmax_t i = 0; i < count; i++) {
+            assert_int_equal(triggerfish_strong_release(items[i]), 0);
+        }
+        received += count;
+    }
+    for (uintmax_t i = 0; i < THREADS; i++) {
+        assert_int_equal(pthread_join(producers[i], NULL), 0);
+    }
+    assert_int_equal(received, THREADS * MESSAGES);
+    assert_ptr_equal(atomic_load(&object->head), object->tail);
+    assert_int_equal(triggerfish_unbounded_channel_destroy(object), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_destroy_error_on_object_is_null),
+            cmocka_unit_test(check_destroy),
+            cmocka_unit_test(check_send_error_on_object_is_null),
+            cmocka_unit_test(check_send_error_on_strong_is_null),
+            cmocka_unit_test(check_send_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_send),
+            cmocka_unit_test(check_send_batch_error_on_object_is_null),
+            cmocka_unit_test(check_send_batch_error_on_items_is_null),
+            cmocka_unit_test(check_send_batch_error_on_count_is_zero),
+            cmocka_unit_test(check_send_batch),
+            cmocka_unit_test(check_receive_error_on_object_is_null),
+            cmocka_unit_test(check_receive_error_on_out_is_null),
+            cmocka_unit_test(check_receive_error_on_channel_is_empty),
+            cmocka_unit_test(check_receive),
+            cmocka_unit_test(check_receive_batch_error_on_object_is_null),
+            cmocka_unit_test(check_receive_batch_error_on_items_is_null),
+            cmocka_unit_test(check_receive_batch_error_on_count_is_zero),
+            cmocka_unit_test(check_receive_batch_error_on_out_is_null),
+            cmocka_unit_test(check_receive_batch),
+            cmocka_unit_test(check_concurrent_send_and_receive),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,192 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+#include <errno.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/local.h"
+#include "private/unique.h"
+
+#include <test/cmocka.h>
+
+static void check_of_error_on_instance_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unique_of(NULL, (void *) 1, (void *) 1),
+            TRIGGERFISH_UNIQUE_ERROR_INSTANCE_IS_NULL);
+}
+
+static void check_of_error_on_on_destroy_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unique_of((void *) 1, NULL, (void *) 1),
+            TRIGGERFISH_UNIQUE_ERROR_ON_DESTROY_IS_NULL);
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unique_of((void *) 1, (void *) 1, NULL),
+            TRIGGERFISH_UNIQUE_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_unique *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_unique_of((void *) 1, (void *) 1, &out),
+            TRIGGERFISH_UNIQUE_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+}
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static void check_of(void **state) {
+    void *instance = malloc(1);
+    struct triggerfish_unique *object;
+    assert_int_equal(triggerfish_unique_of(instance, on_destroy, &object), 0);
+    assert_non_null(object);
+    assert_ptr_equal(object->instance, instance);
+    assert_ptr_equal(object->on_destroy, on_destroy);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_unique_destroy(object), 0);
+}
+
+static void check_destroy_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unique_destroy(NULL),
+            TRIGGERFISH_UNIQUE_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_instance_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unique_instance(NULL, (void *) 1),
+            TRIGGERFISH_UNIQUE_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_instance_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unique_instance((void *) 1, NULL),
+            TRIGGERFISH_UNIQUE_ERROR_OUT_IS_NULL);
+}
+
+static void check_instance(void **state) {
+    void *instance = malloc(1);
+    struct triggerfish_unique *object;
+    assert_int_equal(triggerfish_unique_of(instance, on_destroy, &object), 0);
+    void *out;
+    assert_int_equal(triggerfish_unique_instance(object, &out), 0);
+    assert_ptr_equal(out, instance);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_unique_destroy(object), 0);
+}
+
+static void check_strong_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unique_strong(NULL, (void *) 1),
+            TRIGGERFISH_UNIQUE_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_strong_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unique_strong((void *) 1, NULL),
+            TRIGGERFISH_UNIQUE_ERROR_OUT_IS_NULL);
+}
+
+static void check_strong_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_unique *object;
+    assert_int_equal(triggerfish_unique_of(malloc(1), on_destroy, &object), 0);
+    struct triggerfish_strong *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_unique_strong(object, &out),
+            TRIGGERFISH_UNIQUE_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_unique_destroy(object), 0);
+}
+
+static void check_strong(void **state) {
+    void *instance = malloc(1);
+    struct triggerfish_unique *object;
+    assert_int_equal(triggerfish_unique_of(instance, on_destroy, &object), 0);
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_unique_strong(object, &out), 0);
+    assert_ptr_equal(out->instance, instance);
+    assert_ptr_equal(out->on_destroy, on_destroy);
+    assert_int_equal(atomic_load(&out->counter), 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(out), 0);
+}
+
+static void check_local_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unique_local(NULL, (void *) 1),
+            TRIGGERFISH_UNIQUE_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_local_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_unique_local((void *) 1, NULL),
+            TRIGGERFISH_UNIQUE_ERROR_OUT_IS_NULL);
+}
+
+static void check_local_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_unique *object;
+    assert_int_equal(triggerfish_unique_of(malloc(1), on_destroy, &object), 0);
+    struct triggerfish_local *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_unique_local(object, &out),
+            TRIGGERFISH_UNIQUE_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_unique_destroy(object), 0);
+}
+
+static void check_local(void **state) {
+    void *instance = malloc(1);
+    struct triggerfish_unique *object;
+    assert_int_equal(triggerfish_unique_of(instance, on_destroy, &object), 0);
+    struct triggerfish_local *out;
+    assert_int_equal(triggerfish_unique_local(object, &out), 0);
+    assert_ptr_equal(out->instance, instance);
+    assert_ptr_equal(out->on_destroy, on_destroy);
+    assert_int_equal(out->counter, 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_local_release(out), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_instance_is_null),
+            cmocka_unit_test(check_of_error_on_on_destroy_is_null),
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_destroy_error_on_object_is_null),
+            cmocka_unit_test(check_instance_error_on_object_is_null),
+            cmocka_unit_test(check_instance_error_on_out_is_null),
+            cmocka_unit_test(check_instance),
+            cmocka_unit_test(check_strong_error_on_object_is_null),
+            cmocka_unit_test(check_strong_error_on_out_is_null),
+            cmocka_unit_test(check_strong_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_strong),
+            cmocka_unit_test(check_local_error_on_object_is_null),
+            cmocka_unit_test(check_local_error_on_out_is_null),
+            cmocka_unit_test(check_local_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_local),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
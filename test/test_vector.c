@@ -0,0 +1,441 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+#include <errno.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/vector.h"
+
+#include <test/cmocka.h>
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static struct triggerfish_strong *strong(void) {
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &out), 0);
+    return out;
+}
+
+static void ignore(void *instance) {
+}
+
+static struct triggerfish_strong *number(const uintmax_t value) {
+    uintmax_t *instance = malloc(sizeof(*instance));
+    assert_non_null(instance);
+    *instance = value;
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_strong_of(instance, ignore, &out), 0);
+    return out;
+}
+
+static uintmax_t value_at(const struct triggerfish_vector *object,
+                          const uintmax_t index) {
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_vector_get(object, index, &strong), 0);
+    void *instance;
+    assert_int_equal(triggerfish_strong_instance(strong, &instance), 0);
+    const uintmax_t value = *(uintmax_t *) instance;
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    return value;
+}
+
+static void add_numbers(struct triggerfish_vector *object,
+                        const uintmax_t count) {
+    for (uintmax_t i = 0; i < count; i++) {
+        struct triggerfish_strong *item = number(i);
+        assert_int_equal(triggerfish_vector_add(object, item), 0);
+        assert_int_equal(triggerfish_strong_release(item), 0);
+    }
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_vector_of(NULL),
+            TRIGGERFISH_VECTOR_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_vector *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_vector_of(&out),
+            TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+}
+
+static void check_of(void **state) {
+    struct triggerfish_vector *object;
+    assert_int_equal(triggerfish_vector_of(&object), 0);
+    assert_non_null(object);
+    assert_int_equal(object->count, 0);
+    assert_null(object->root);
+    assert_int_equal(triggerfish_vector_destroy(object), 0);
+}
+
+static void check_destroy_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_vector_destroy(NULL),
+            TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_destroy(void **state) {
+    struct triggerfish_vector *object;
+    assert_int_equal(triggerfish_vector_of(&object), 0);
+    for (uintmax_t i = 0; i < 40; i++) {
+        struct triggerfish_strong *item = strong();
+        assert_int_equal(triggerfish_vector_add(object, item), 0);
+        assert_int_equal(triggerfish_strong_release(item), 0);
+    }
+    expect_function_calls(on_destroy, 40);
+    assert_int_equal(triggerfish_vector_destroy(object), 0);
+}
+
+static void check_copy_of_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_vector_copy_of(NULL, (void *) 1),
+            TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_copy_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_vector_copy_of((void *) 1, NULL),
+            TRIGGERFISH_VECTOR_ERROR_OUT_IS_NULL);
+}
+
+static void check_copy_of_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_vector object = {};
+    struct triggerfish_vector *out;
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_vector_copy_of(&object, &out),
+            TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+}
+
+static void check_copy_of(void **state) {
+    struct triggerfish_vector *object;
+    assert_int_equal(triggerfish_vector_of(&object), 0);
+    add_numbers(object, 100);
+    struct triggerfish_vector *copy;
+    assert_int_equal(triggerfish_vector_copy_of(object, &copy), 0);
+    assert_ptr_equal(copy->root, object->root);
+    assert_int_equal(copy->count, 100);
+    assert_int_equal(atomic_load(&object->root->counter), 2);
+    assert_int_equal(triggerfish_vector_destroy(object), 0);
+    for (uintmax_t i = 0; i < 100; i++) {
+        assert_int_equal(value_at(copy, i), i);
+    }
+    assert_int_equal(triggerfish_vector_destroy(copy), 0);
+}
+
+static void check_count_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_vector_count(NULL, (void *) 1),
+            TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_count_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_vector_count((void *) 1, NULL),
+            TRIGGERFISH_VECTOR_ERROR_OUT_IS_NULL);
+}
+
+static void check_count(void **state) {
+    srand(time(NULL));
+    struct triggerfish_vector object = {
+            .count = rand() % UINTMAX_MAX
+    };
+    uintmax_t out;
+    assert_int_equal(triggerfish_vector_count(&object, &out), 0);
+    assert_int_equal(out, object.count);
+}
+
+static void check_add_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_vector_add(NULL, (void *) 1),
+            TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_add_error_on_strong_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_vector_add((void *) 1, NULL),
+            TRIGGERFISH_VECTOR_ERROR_STRONG_IS_NULL);
+}
+
+static void check_add_error_on_strong_is_invalid(void **state) {
+    struct triggerfish_vector object = {};
+    struct triggerfish_strong strong = {};
+    assert_int_equal(
+            triggerfish_vector_add(&object, &strong),
+            TRIGGERFISH_VECTOR_ERROR_STRONG_IS_INVALID);
+}
+
+static void check_add_error_on_vector_is_full(void **state) {
+    struct triggerfish_vector object = {
+            .count = UINTMAX_MAX
+    };
+    assert_int_equal(
+            triggerfish_vector_add(&object, (void *) 1),
+            TRIGGERFISH_VECTOR_ERROR_VECTOR_IS_FULL);
+}
+
+static void check_add_error_on_memory_allocation_failed(void **state) {
+    struct triggerfish_vector *object;
+    assert_int_equal(triggerfish_vector_of(&object), 0);
+    struct triggerfish_strong *item = strong();
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_vector_add(object, item),
+            TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+    assert_int_equal(object->count, 0);
+    assert_int_equal(atomic_load(&item->counter), 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(item), 0);
+    assert_int_equal(triggerfish_vector_destroy(object), 0);
+}
+
+static void check_add(void **state) {
+    struct triggerfish_vector *object;
+    assert_int_equal(triggerfish_vector_of(&object), 0);
+    struct triggerfish_strong *item = strong();
+    assert_int_equal(triggerfish_vector_add(object, item), 0);
+    assert_int_equal(object->count, 1);
+    assert_int_equal(object->shift, 0);
+    assert_int_equal(atomic_load(&item->counter), 2);
+    assert_int_equal(triggerfish_strong_release(item), 0);
+    add_numbers(object, TRIGGERFISH_VECTOR_WIDTH);
+    /* a full root gains a level */
+    assert_int_equal(object->shift, TRIGGERFISH_VECTOR_BITS);
+    assert_int_equal(object->count, 1 + TRIGGERFISH_VECTOR_WIDTH);
+    for (uintmax_t i = 1; i < object->count; i++) {
+        assert_int_equal(value_at(object, i), i - 1);
+    }
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_vector_destroy(object), 0);
+}
+
+static void check_add_shares_nodes(void **state) {
+    struct triggerfish_vector *a;
+    assert_int_equal(triggerfish_vector_of(&a), 0);
+    add_numbers(a, 3 * TRIGGERFISH_VECTOR_WIDTH);
+    struct triggerfish_vector *b;
+    assert_int_equal(triggerfish_vector_copy_of(a, &b), 0);
+    add_numbers(b, 1);
+    assert_int_equal(a->count, 3 * TRIGGERFISH_VECTOR_WIDTH);
+    assert_int_equal(b->count, 1 + 3 * TRIGGERFISH_VECTOR_WIDTH);
+    /* only the path to the new element was copied */
+    assert_ptr_not_equal(a->root, b->root);
+    const struct triggerfish_vector_node *root_a = a->root->instance;
+    const struct triggerfish_vector_node *root_b = b->root->instance;
+    for (uintmax_t i = 0; i < 3; i++) {
+        assert_ptr_equal(root_a->slots[i], root_b->slots[i]);
+        assert_int_equal(atomic_load(&root_a->slots[i]->counter), 2);
+    }
+    assert_null(root_a->slots[3]);
+    assert_non_null(root_b->slots[3]);
+    assert_int_equal(triggerfish_vector_destroy(a), 0);
+    assert_int_equal(triggerfish_vector_destroy(b), 0);
+}
+
+static void check_remove_last_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_vector_remove_last(NULL),
+            TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_remove_last_error_on_vector_is_empty(void **state) {
+    struct triggerfish_vector object = {};
+    assert_int_equal(
+            triggerfish_vector_remove_last(&object),
+            TRIGGERFISH_VECTOR_ERROR_VECTOR_IS_EMPTY);
+}
+
+static void check_remove_last_error_on_memory_allocation_failed(
+        void **state) {
+    struct triggerfish_vector *object;
+    assert_int_equal(triggerfish_vector_of(&object), 0);
+    add_numbers(object, 2);
+    struct triggerfish_vector *copy;
+    assert_int_equal(triggerfish_vector_copy_of(object, &copy), 0);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_vector_remove_last(object),
+            TRIGGERFISH_VECTOR_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden =
+            posix_memalign_is_overridden = false;
+    assert_int_equal(object->count, 2);
+    assert_int_equal(triggerfish_vector_destroy(copy), 0);
+    assert_int_equal(triggerfish_vector_destroy(object), 0);
+}
+
+static void check_remove_last(void **state) {
+    struct triggerfish_vector *object;
+    assert_int_equal(triggerfish_vector_of(&object), 0);
+    const uintmax_t count = 2 + TRIGGERFISH_VECTOR_WIDTH
+                                * TRIGGERFISH_VECTOR_WIDTH;
+    add_numbers(object, count);
+    assert_int_equal(object->shift, 2 * TRIGGERFISH_VECTOR_BITS);
+    struct triggerfish_vector *copy;
+    assert_int_equal(triggerfish_vector_copy_of(object, &copy), 0);
+    for (uintmax_t i = count; i > 0; i--) {
+        assert_int_equal(triggerfish_vector_remove_last(object), 0);
+        assert_int_equal(object->count, i - 1);
+        if (i - 1) {
+            assert_int_equal(value_at(object, i - 2), i - 2);
+        }
+        if (i - 1 == TRIGGERFISH_VECTOR_WIDTH * TRIGGERFISH_VECTOR_WIDTH) {
+            /* the tree shrinks once the first child can hold everything */
+            assert_int_equal(object->shift, TRIGGERFISH_VECTOR_BITS);
+        }
+    }
+    assert_null(object->root);
+    assert_int_equal(object->shift, 0);
+    /* the copy is unaffected */
+    assert_int_equal(copy->count, count);
+    for (uintmax_t i = 0; i < count; i++) {
+        assert_int_equal(value_at(copy, i), i);
+    }
+    assert_int_equal(triggerfish_vector_destroy(object), 0);
+    assert_int_equal(triggerfish_vector_destroy(copy), 0);
+}
+
+static void check_set_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_vector_set(NULL, 0, (void *) 1),
+            TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_set_error_on_strong_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_vector_set((void *) 1, 0, NULL),
+            TRIGGERFISH_VECTOR_ERROR_STRONG_IS_NULL);
+}
+
+static void check_set_error_on_index_is_out_of_bounds(void **state) {
+    struct triggerfish_vector object = {};
+    assert_int_equal(
+            triggerfish_vector_set(&object, 0, (void *) 1),
+            TRIGGERFISH_VECTOR_ERROR_INDEX_IS_OUT_OF_BOUNDS);
+}
+
+static void check_set_error_on_strong_is_invalid(void **state) {
+    struct triggerfish_vector object = {
+            .count = 1
+    };
+    struct triggerfish_strong strong = {};
+    assert_int_equal(
+            triggerfish_vector_set(&object, 0, &strong),
+            TRIGGERFISH_VECTOR_ERROR_STRONG_IS_INVALID);
+}
+
+static void check_set(void **state) {
+    struct triggerfish_vector *object;
+    assert_int_equal(triggerfish_vector_of(&object), 0);
+    add_numbers(object, 100);
+    struct triggerfish_vector *copy;
+    assert_int_equal(triggerfish_vector_copy_of(object, &copy), 0);
+    struct triggerfish_strong *item = number(1000);
+    assert_int_equal(triggerfish_vector_set(object, 50, item), 0);
+    const struct triggerfish_strong *root = object->root;
+    /* unshared nodes are changed in place */
+    assert_int_equal(triggerfish_vector_set(object, 51, item), 0);
+    assert_ptr_equal(object->root, root);
+    assert_int_equal(atomic_load(&item->counter), 3);
+    assert_int_equal(triggerfish_strong_release(item), 0);
+    assert_int_equal(value_at(object, 50), 1000);
+    assert_int_equal(value_at(object, 51), 1000);
+    assert_int_equal(value_at(copy, 50), 50);
+    assert_int_equal(value_at(copy, 51), 51);
+    assert_int_equal(triggerfish_vector_destroy(object), 0);
+    assert_int_equal(triggerfish_vector_destroy(copy), 0);
+}
+
+static void check_get_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_vector_get(NULL, 0, (void *) 1),
+            TRIGGERFISH_VECTOR_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_get_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_vector_get((void *) 1, 0, NULL),
+            TRIGGERFISH_VECTOR_ERROR_OUT_IS_NULL);
+}
+
+static void check_get_error_on_index_is_out_of_bounds(void **state) {
+    struct triggerfish_vector object = {};
+    struct triggerfish_strong *out;
+    assert_int_equal(
+            triggerfish_vector_get(&object, 0, &out),
+            TRIGGERFISH_VECTOR_ERROR_INDEX_IS_OUT_OF_BOUNDS);
+}
+
+static void check_get(void **state) {
+    struct triggerfish_vector *object;
+    assert_int_equal(triggerfish_vector_of(&object), 0);
+    struct triggerfish_strong *item = strong();
+    assert_int_equal(triggerfish_vector_add(object, item), 0);
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_vector_get(object, 0, &out), 0);
+    assert_ptr_equal(out, item);
+    assert_int_equal(atomic_load(&item->counter), 3);
+    assert_int_equal(triggerfish_strong_release(out), 0);
+    assert_int_equal(triggerfish_strong_release(item), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_vector_destroy(object), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_destroy_error_on_object_is_null),
+            cmocka_unit_test(check_destroy),
+            cmocka_unit_test(check_copy_of_error_on_object_is_null),
+            cmocka_unit_test(check_copy_of_error_on_out_is_null),
+            cmocka_unit_test(check_copy_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_copy_of),
+            cmocka_unit_test(check_count_error_on_object_is_null),
+            cmocka_unit_test(check_count_error_on_out_is_null),
+            cmocka_unit_test(check_count),
+            cmocka_unit_test(check_add_error_on_object_is_null),
+            cmocka_unit_test(check_add_error_on_strong_is_null),
+            cmocka_unit_test(check_add_error_on_strong_is_invalid),
+            cmocka_unit_test(check_add_error_on_vector_is_full),
+            cmocka_unit_test(check_add_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_add),
+            cmocka_unit_test(check_add_shares_nodes),
+            cmocka_unit_test(check_remove_last_error_on_object_is_null),
+            cmocka_unit_test(check_remove_last_error_on_vector_is_empty),
+            cmocka_unit_test(
+                    check_remove_last_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_remove_last),
+            cmocka_unit_test(check_set_error_on_object_is_null),
+            cmocka_unit_test(check_set_error_on_strong_is_null),
+            cmocka_unit_test(check_set_error_on_index_is_out_of_bounds),
+            cmocka_unit_test(check_set_error_on_strong_is_invalid),
+            cmocka_unit_test(check_set),
+            cmocka_unit_test(check_get_error_on_object_is_null),
+            cmocka_unit_test(check_get_error_on_out_is_null),
+            cmocka_unit_test(check_get_error_on_index_is_out_of_bounds),
+            cmocka_unit_test(check_get),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -5,6 +5,7 @@
 #include <cmocka.h>
 #include <errno.h>
 #include <string.h>
+#include <pthread.h>
 #include <triggerfish.h>
 
 #include "private/strong.h"
@@ -75,6 +76,22 @@ static void check_of_error_on_strong_is_invalid(void **state) {
     pthread_mutex_lock_is_overridden = false;
 }
 
+static void check_of_error_on_strong_is_alias(void **state) {
+    unsigned char *instance = malloc(2);
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(instance, on_destroy, &strong), 0);
+    struct triggerfish_strong *alias;
+    assert_int_equal(triggerfish_strong_alias_of(strong, &instance[1], &alias),
+                     0);
+    struct triggerfish_weak *out;
+    assert_int_equal(
+            triggerfish_weak_of(alias, &out),
+            TRIGGERFISH_WEAK_ERROR_STRONG_IS_ALIAS);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(alias), 0);
+}
+
 static void check_of(void **state) {
     void *instance = malloc(1);
     struct triggerfish_strong *strong;
@@ -89,6 +106,71 @@ static void check_of(void **state) {
     assert_int_equal(triggerfish_weak_destroy(out), 0);
 }
 
+static void check_of_queue_error_on_strong_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weak_of_queue(NULL, (void *) 1, NULL, (void *) 1),
+            TRIGGERFISH_WEAK_ERROR_STRONG_IS_NULL);
+}
+
+static void check_of_queue_error_on_queue_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weak_of_queue((void *) 1, NULL, NULL, (void *) 1),
+            TRIGGERFISH_WEAK_ERROR_QUEUE_IS_NULL);
+}
+
+static void check_of_queue_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weak_of_queue((void *) 1, (void *) 1, NULL, NULL),
+            TRIGGERFISH_WEAK_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_queue_error_on_memory_allocation_failed(void **state) {
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_weak_of_queue(
+                    (void *) 1, (void *) 1, NULL, (void *) 1),
+            TRIGGERFISH_WEAK_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+}
+
+static void check_of_queue_error_on_strong_is_invalid(void **state) {
+    struct triggerfish_reference_queue *queue;
+    assert_int_equal(triggerfish_reference_queue_of(&queue), 0);
+    struct triggerfish_strong strong = {};
+    struct triggerfish_weak *out;
+    pthread_mutex_lock_is_overridden = true;
+    will_return(cmocka_test_pthread_mutex_lock, EINVAL);
+    assert_int_equal(
+            triggerfish_weak_of_queue(&strong, queue, NULL, &out),
+            TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID);
+    pthread_mutex_lock_is_overridden = false;
+    assert_int_equal(triggerfish_reference_queue_destroy(queue), 0);
+}
+
+static void check_of_queue(void **state) {
+    struct triggerfish_reference_queue *queue;
+    assert_int_equal(triggerfish_reference_queue_of(&queue), 0);
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_weak *out;
+    assert_int_equal(triggerfish_weak_of_queue(
+            strong, queue, (void *) 1, &out), 0);
+    assert_non_null(out->entry);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    assert_null(out->entry);
+    void *cookie;
+    uintmax_t count;
+    assert_int_equal(
+            triggerfish_reference_queue_poll(queue, &cookie, 1, &count), 0);
+    assert_int_equal(count, 1);
+    assert_ptr_equal(cookie, (void *) 1);
+    assert_int_equal(triggerfish_weak_destroy(out), 0);
+    assert_int_equal(triggerfish_reference_queue_destroy(queue), 0);
+}
+
 static void check_copy_of_error_on_other_is_null(void **state) {
     assert_int_equal(
             triggerfish_weak_copy_of(NULL, (void *) 1),
@@ -129,6 +211,33 @@ static void check_copy_of(void **state) {
     assert_int_equal(triggerfish_weak_destroy(copy), 0);
 }
 
+static void check_copy_of_when_strong_is_invalid(void **state) {
+    struct triggerfish_weak other = {};
+    struct triggerfish_weak *copy;
+    assert_int_equal(triggerfish_weak_copy_of(&other, &copy), 0);
+    assert_ptr_equal(atomic_load(&copy->strong), 0);
+    assert_int_equal(triggerfish_weak_destroy(copy), 0);
+}
+
+static void check_copy_of_does_not_touch_counter(void **state) {
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_weak *other;
+    assert_int_equal(triggerfish_weak_of(strong, &other), 0);
+    atomic_store(&strong->counter, 3);
+    struct triggerfish_weak *copy;
+    assert_int_equal(triggerfish_weak_copy_of(other, &copy), 0);
+    assert_int_equal(atomic_load(&strong->counter), 3);
+    assert_int_equal(atomic_load(&other->borrows), 0);
+    assert_ptr_equal(atomic_load(&copy->strong), strong);
+    atomic_store(&strong->counter, 1);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    assert_ptr_equal(atomic_load(&copy->strong), 0);
+    assert_int_equal(triggerfish_weak_destroy(other), 0);
+    assert_int_equal(triggerfish_weak_destroy(copy), 0);
+}
+
 static void check_strong_error_on_object_is_null(void **state) {
     assert_int_equal(
             triggerfish_weak_strong(NULL, (void *) 1),
@@ -167,6 +276,158 @@ static void check_strong(void **state) {
     assert_int_equal(triggerfish_weak_destroy(object), 0);
 }
 
+static void check_strong_take_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weak_strong_take(NULL, (void *) 1),
+            TRIGGERFISH_WEAK_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_strong_take_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weak_strong_take((void *) 1, NULL),
+            TRIGGERFISH_WEAK_ERROR_OUT_IS_NULL);
+}
+
+static void check_strong_take_error_on_strong_is_invalid(void **state) {
+    struct triggerfish_weak object = {};
+    assert_int_equal(
+            triggerfish_weak_strong_take(&object, (void *) 1),
+            TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID);
+}
+
+static void check_strong_take(void **state) {
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_weak *object;
+    assert_int_equal(triggerfish_weak_of(strong, &object), 0);
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_weak_strong_take(object, &out), 0);
+    assert_ptr_equal(out, strong);
+    assert_int_equal(atomic_load(&strong->counter), 2);
+    uintmax_t count;
+    assert_int_equal(coral_red_black_tree_container_count(
+            &strong->weak_refs, &count), 0);
+    assert_int_equal(count, 0);
+#ifdef TRIGGERFISH_DEBUG_OWNERSHIP
+    assert_true(atomic_load(&object->borrows) & TRIGGERFISH_WEAK_TAKEN);
+#endif
+    assert_int_equal(triggerfish_strong_release(out), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+}
+
+static void check_borrow_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weak_borrow(NULL, (void *) 1),
+            TRIGGERFISH_WEAK_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_borrow_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weak_borrow((void *) 1, NULL),
+            TRIGGERFISH_WEAK_ERROR_OUT_IS_NULL);
+}
+
+static void check_borrow_error_on_strong_is_invalid(void **state) {
+    struct triggerfish_weak object = {};
+    void *out;
+    assert_int_equal(
+            triggerfish_weak_borrow(&object, &out),
+            TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID);
+    assert_int_equal(atomic_load(&object.borrows), 0);
+    struct triggerfish_strong strong = {};
+    atomic_store(&object.strong, (uintptr_t) &strong);
+    assert_int_equal(
+            triggerfish_weak_borrow(&object, &out),
+            TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID);
+    assert_int_equal(atomic_load(&object.borrows), 0);
+}
+
+static void check_borrow(void **state) {
+    void *instance = malloc(1);
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(instance, on_destroy, &strong), 0);
+    struct triggerfish_weak *object;
+    assert_int_equal(triggerfish_weak_of(strong, &object), 0);
+    void *out;
+    assert_int_equal(triggerfish_weak_borrow(object, &out), 0);
+    assert_ptr_equal(out, instance);
+    assert_int_equal(atomic_load(&object->borrows), 1);
+    assert_int_equal(atomic_load(&strong->counter), 1);
+    assert_int_equal(triggerfish_weak_borrow_end(object), 0);
+    assert_int_equal(atomic_load(&object->borrows), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    assert_int_equal(triggerfish_weak_destroy(object), 0);
+}
+
+static atomic_bool destroyed;
+
+static void on_destroy_flag(void *instance) {
+    assert_non_null(instance);
+    atomic_store(&destroyed, true);
+}
+
+static void *release(void *strong) {
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    return NULL;
+}
+
+static void check_borrow_delays_destroy(void **state) {
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(
+            malloc(1), on_destroy_flag, &strong), 0);
+    struct triggerfish_weak *object;
+    assert_int_equal(triggerfish_weak_of(strong, &object), 0);
+    void *out;
+    assert_int_equal(triggerfish_weak_borrow(object, &out), 0);
+    atomic_store(&destroyed, false);
+    pthread_t thread;
+    assert_int_equal(pthread_create(&thread, NULL, release, strong), 0);
+    while (atomic_load(&object->strong)) {
+        sched_yield();
+    }
+    assert_false(atomic_load(&destroyed));
+    assert_int_equal(triggerfish_weak_borrow_end(object), 0);
+    assert_int_equal(pthread_join(thread, NULL), 0);
+    assert_true(atomic_load(&destroyed));
+    assert_int_equal(
+            triggerfish_weak_borrow(object, &out),
+            TRIGGERFISH_WEAK_ERROR_STRONG_IS_INVALID);
+    assert_int_equal(triggerfish_weak_destroy(object), 0);
+}
+
+static void check_destroy_while_strong_is_destroyed(void **state) {
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(
+            malloc(1), on_destroy_flag, &strong), 0);
+    struct triggerfish_weak *borrowed;
+    assert_int_equal(triggerfish_weak_of(strong, &borrowed), 0);
+    struct triggerfish_weak *object;
+    assert_int_equal(triggerfish_weak_of(strong, &object), 0);
+    void *out;
+    assert_int_equal(triggerfish_weak_borrow(borrowed, &out), 0);
+    atomic_store(&destroyed, false);
+    pthread_t thread;
+    assert_int_equal(pthread_create(&thread, NULL, release, strong), 0);
+    while (atomic_load(&borrowed->strong)) {
+        sched_yield();
+    }
+    /* the destroyer waits for the borrow while it holds the lock */
+    assert_int_equal(triggerfish_weak_destroy(object), 0);
+    assert_false(atomic_load(&destroyed));
+    assert_int_equal(triggerfish_weak_borrow_end(borrowed), 0);
+    assert_int_equal(pthread_join(thread, NULL), 0);
+    assert_true(atomic_load(&destroyed));
+    assert_int_equal(triggerfish_weak_destroy(borrowed), 0);
+}
+
+static void check_borrow_end_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weak_borrow_end(NULL),
+            TRIGGERFISH_WEAK_ERROR_OBJECT_IS_NULL);
+}
+
 int main(int argc, char *argv[]) {
     const struct CMUnitTest tests[] = {
             cmocka_unit_test(check_destroy_error_on_object_is_null),
@@ -176,15 +437,35 @@ int main(int argc, char *argv[]) {
             cmocka_unit_test(check_of_error_on_out_is_null),
             cmocka_unit_test(check_of_error_on_memory_allocation_failed),
             cmocka_unit_test(check_of_error_on_strong_is_invalid),
+            cmocka_unit_test(check_of_error_on_strong_is_alias),
             cmocka_unit_test(check_of),
+            cmocka_unit_test(check_of_queue_error_on_strong_is_null),
+            cmocka_unit_test(check_of_queue_error_on_queue_is_null),
+            cmocka_unit_test(check_of_queue_error_on_out_is_null),
+            cmocka_unit_test(check_of_queue_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of_queue_error_on_strong_is_invalid),
+            cmocka_unit_test(check_of_queue),
             cmocka_unit_test(check_copy_of_error_on_other_is_null),
             cmocka_unit_test(check_copy_of_error_on_out_is_null),
             cmocka_unit_test(check_copy_of_error_on_memory_allocation_failed),
             cmocka_unit_test(check_copy_of),
+            cmocka_unit_test(check_copy_of_when_strong_is_invalid),
+            cmocka_unit_test(check_copy_of_does_not_touch_counter),
             cmocka_unit_test(check_strong_error_on_object_is_null),
             cmocka_unit_test(check_strong_error_on_out_is_null),
             cmocka_unit_test(check_strong_error_strong_is_invalid),
             cmocka_unit_test(check_strong),
+            cmocka_unit_test(check_strong_take_error_on_object_is_null),
+            cmocka_unit_test(check_strong_take_error_on_out_is_null),
+            cmocka_unit_test(check_strong_take_error_on_strong_is_invalid),
+            cmocka_unit_test(check_strong_take),
+            cmocka_unit_test(check_borrow_error_on_object_is_null),
+            cmocka_unit_test(check_borrow_error_on_out_is_null),
+            cmocka_unit_test(check_borrow_error_on_strong_is_invalid),
+            cmocka_unit_test(check_borrow),
+            cmocka_unit_test(check_borrow_delays_destroy),
+            cmocka_unit_test(check_destroy_while_strong_is_destroyed),
+            cmocka_unit_test(check_borrow_end_error_on_object_is_null),
     };
     //cmocka_set_message_output(CM_OUTPUT_XML);
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,255 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <errno.h>
+#include <string.h>
+#include <pthread.h>
+#include <triggerfish.h>
+
+#include "private/strong.h"
+#include "private/weighted.h"
+
+#include <test/cmocka.h>
+
+static void on_destroy(void *instance) {
+    assert_non_null(instance);
+    function_called();
+}
+
+static void check_of_error_on_strong_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weighted_of(NULL, (void *) 1),
+            TRIGGERFISH_WEIGHTED_ERROR_STRONG_IS_NULL);
+}
+
+static void check_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weighted_of((void *) 1, NULL),
+            TRIGGERFISH_WEIGHTED_ERROR_OUT_IS_NULL);
+}
+
+static void check_of_error_on_memory_allocation_failed(void **state) {
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_weighted_of((void *) 1, (void *) 1),
+            TRIGGERFISH_WEIGHTED_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+}
+
+static void check_of_error_on_strong_is_invalid(void **state) {
+    struct triggerfish_strong strong = {};
+    struct triggerfish_weighted *out;
+    assert_int_equal(
+            triggerfish_weighted_of(&strong, &out),
+            TRIGGERFISH_WEIGHTED_ERROR_STRONG_IS_INVALID);
+}
+
+static void check_of(void **state) {
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_weighted *out;
+    assert_int_equal(triggerfish_weighted_of(strong, &out), 0);
+    assert_ptr_equal(out->block->strong, strong);
+    assert_int_equal(out->weight, TRIGGERFISH_WEIGHTED_WEIGHT);
+    assert_int_equal(atomic_load(&out->block->weight),
+                     TRIGGERFISH_WEIGHTED_WEIGHT);
+    assert_int_equal(atomic_load(&strong->counter), 2);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_weighted_destroy(out), 0);
+}
+
+static void check_copy_of_error_on_other_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weighted_copy_of(NULL, (void *) 1),
+            TRIGGERFISH_WEIGHTED_ERROR_OTHER_IS_NULL);
+}
+
+static void check_copy_of_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weighted_copy_of((void *) 1, NULL),
+            TRIGGERFISH_WEIGHTED_ERROR_OUT_IS_NULL);
+}
+
+static void check_copy_of_error_on_memory_allocation_failed(void **state) {
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = true;
+    assert_int_equal(
+            triggerfish_weighted_copy_of((void *) 1, (void *) 1),
+            TRIGGERFISH_WEIGHTED_ERROR_MEMORY_ALLOCATION_FAILED);
+    malloc_is_overridden = calloc_is_overridden = realloc_is_overridden
+            = posix_memalign_is_overridden = false;
+}
+
+static void check_copy_of(void **state) {
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_weighted *object;
+    assert_int_equal(triggerfish_weighted_of(strong, &object), 0);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    struct triggerfish_weighted *out;
+    assert_int_equal(triggerfish_weighted_copy_of(object, &out), 0);
+    assert_ptr_equal(out->block, object->block);
+    assert_int_equal(out->weight, TRIGGERFISH_WEIGHTED_WEIGHT / 2);
+    assert_int_equal(object->weight, TRIGGERFISH_WEIGHTED_WEIGHT / 2);
+    /* nothing shared was written */
+    assert_int_equal(atomic_load(&object->block->weight),
+                     TRIGGERFISH_WEIGHTED_WEIGHT);
+    assert_int_equal(atomic_load(&strong->counter), 1);
+    assert_int_equal(triggerfish_weighted_destroy(object), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_weighted_destroy(out), 0);
+}
+
+static void check_copy_of_borrows_weight(void **state) {
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_weighted *object;
+    assert_int_equal(triggerfish_weighted_of(strong, &object), 0);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    struct triggerfish_weighted *copies[17];
+    for (uintmax_t i = 0; i < 16; i++) {
+        assert_int_equal(triggerfish_weighted_copy_of(object, &copies[i]), 0);
+    }
+    assert_int_equal(object->weight, 1);
+    assert_int_equal(triggerfish_weighted_copy_of(object, &copies[16]), 0);
+    assert_int_equal(atomic_load(&object->block->weight),
+                     2 * TRIGGERFISH_WEIGHTED_WEIGHT);
+    assert_int_equal(object->weight + copies[16]->weight,
+                     TRIGGERFISH_WEIGHTED_WEIGHT + 1);
+    for (uintmax_t i = 0; i < 17; i++) {
+        assert_int_equal(triggerfish_weighted_destroy(copies[i]), 0);
+    }
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_weighted_destroy(object), 0);
+}
+
+static void check_destroy_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weighted_destroy(NULL),
+            TRIGGERFISH_WEIGHTED_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_instance_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weighted_instance(NULL, (void *) 1),
+            TRIGGERFISH_WEIGHTED_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_instance_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weighted_instance((void *) 1, NULL),
+            TRIGGERFISH_WEIGHTED_ERROR_OUT_IS_NULL);
+}
+
+static void check_instance(void **state) {
+    void *instance = malloc(1);
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(instance, on_destroy, &strong), 0);
+    struct triggerfish_weighted *object;
+    assert_int_equal(triggerfish_weighted_of(strong, &object), 0);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    void *out;
+    assert_int_equal(triggerfish_weighted_instance(object, &out), 0);
+    assert_ptr_equal(out, instance);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_weighted_destroy(object), 0);
+}
+
+static void check_strong_error_on_object_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weighted_strong(NULL, (void *) 1),
+            TRIGGERFISH_WEIGHTED_ERROR_OBJECT_IS_NULL);
+}
+
+static void check_strong_error_on_out_is_null(void **state) {
+    assert_int_equal(
+            triggerfish_weighted_strong((void *) 1, NULL),
+            TRIGGERFISH_WEIGHTED_ERROR_OUT_IS_NULL);
+}
+
+static void check_strong(void **state) {
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_weighted *object;
+    assert_int_equal(triggerfish_weighted_of(strong, &object), 0);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    struct triggerfish_strong *out;
+    assert_int_equal(triggerfish_weighted_strong(object, &out), 0);
+    assert_ptr_equal(out, strong);
+    assert_int_equal(triggerfish_weighted_destroy(object), 0);
+    expect_function_call(on_destroy);
+    assert_int_equal(triggerfish_strong_release(out), 0);
+}
+
+#define WORKERS     8
+#define COPIES      1000
+
+/* cmocka is not thread-safe, workers only record their failures */
+static atomic_bool failed;
+
+static void *fan_out(void *arg) {
+    struct triggerfish_weighted *const object = arg;
+    for (uintmax_t i = 0; i < COPIES; i++) {
+        struct triggerfish_weighted *copy;
+        if (triggerfish_weighted_copy_of(object, &copy)
+            || triggerfish_weighted_destroy(copy)) {
+            atomic_store(&failed, true);
+        }
+    }
+    if (triggerfish_weighted_destroy(object)) {
+        atomic_store(&failed, true);
+    }
+    return NULL;
+}
+
+static void check_copy_of_concurrently(void **state) {
+    atomic_store(&failed, false);
+    struct triggerfish_strong *strong;
+    assert_int_equal(triggerfish_strong_of(malloc(1), on_destroy, &strong), 0);
+    struct triggerfish_weighted *object;
+    assert_int_equal(triggerfish_weighted_of(strong, &object), 0);
+    assert_int_equal(triggerfish_strong_release(strong), 0);
+    /* object holds the last weight, returned after the workers are done */
+    expect_function_call(on_destroy);
+    pthread_t threads[WORKERS];
+    for (uintmax_t i = 0; i < WORKERS; i++) {
+        struct triggerfish_weighted *copy;
+        assert_int_equal(triggerfish_weighted_copy_of(object, &copy), 0);
+        assert_int_equal(pthread_create(&threads[i], NULL, fan_out, copy), 0);
+    }
+    for (uintmax_t i = 0; i < WORKERS; i++) {
+        assert_int_equal(pthread_join(threads[i], NULL), 0);
+    }
+    assert_false(atomic_load(&failed));
+    assert_int_equal(triggerfish_weighted_destroy(object), 0);
+}
+
+int main(int argc, char *argv[]) {
+    const struct CMUnitTest tests[] = {
+            cmocka_unit_test(check_of_error_on_strong_is_null),
+            cmocka_unit_test(check_of_error_on_out_is_null),
+            cmocka_unit_test(check_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_of_error_on_strong_is_invalid),
+            cmocka_unit_test(check_of),
+            cmocka_unit_test(check_copy_of_error_on_other_is_null),
+            cmocka_unit_test(check_copy_of_error_on_out_is_null),
+            cmocka_unit_test(check_copy_of_error_on_memory_allocation_failed),
+            cmocka_unit_test(check_copy_of),
+            cmocka_unit_test(check_copy_of_borrows_weight),
+            cmocka_unit_test(check_copy_of_concurrently),
+            cmocka_unit_test(check_destroy_error_on_object_is_null),
+            cmocka_unit_test(check_instance_error_on_object_is_null),
+            cmocka_unit_test(check_instance_error_on_out_is_null),
+            cmocka_unit_test(check_instance),
+            cmocka_unit_test(check_strong_error_on_object_is_null),
+            cmocka_unit_test(check_strong_error_on_out_is_null),
+            cmocka_unit_test(check_strong),
+    };
+    //cmocka_set_message_output(CM_OUTPUT_XML);
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
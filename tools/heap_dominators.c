@@ -0,0 +1,479 @@
+/*
+ * Read a heap dump written by triggerfish_heap_dump and list the instances
+ * which retain the most memory, that is the memory which would be freed
+ * once their strong reference is destroyed.
+ *
+ * usage: aquarium-triggerfish-heap-dominators [-n count] [dump]
+ *
+ * Strong references which are held more often than by the instances in the
+ * dump are held from outside, by the stack or globals, and are the roots of
+ * the graph. Strong references which cannot be reached from such a root only
+ * hold each other alive in a cycle, they are leaked and reported as roots of
+ * their own. The dominator tree is computed with the iterative algorithm by
+ * Cooper, Harvey and Kennedy over a virtual root holding every root.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+
+#define VERSION         1
+#define ROOT            0
+#define UNDEFINED       SIZE_MAX
+
+struct type {
+    uint32_t id;
+    char *name;
+};
+
+struct edge {
+    size_t from;
+    uint64_t to;
+};
+
+struct graph {
+    struct type *types;
+    size_t types_count;
+    /* nodes are numbered from 1 as 0 is the virtual root */
+    uint64_t *ids;
+    uint32_t *type_ids;
+    uint64_t *sizes;
+    uint64_t *counts;
+    size_t count;
+    size_t capacity;
+    struct edge *edges;
+    size_t edges_count;
+    size_t edges_capacity;
+    /* open addressing from node id to node */
+    size_t *slots;
+    size_t slots_count;
+};
+
+static _Noreturn void die(const char *const message) {
+    fprintf(stderr, "heap-dominators: %s\n", message);
+    exit(EXIT_FAILURE);
+}
+
+static void *allocate(void *const data, const size_t count, const size_t size) {
+    if (count && SIZE_MAX / count < size) {
+        die("dump is too large");
+    }
+    const size_t bytes = count * size;
+    void *const result = realloc(data, bytes ? bytes : 1);
+    if (!result) {
+        die("out of memory");
+    }
+    return result;
+}
+
+static uint64_t get(FILE *const file, const size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) {
+        const int c = fgetc(file);
+        if (EOF == c) {
+            die("dump is truncated");
+        }
+        value |= (uint64_t) (unsigned char) c << (8 * i);
+    }
+    return value;
+}
+
+static size_t hash(const uint64_t id) {
+    return (size_t) ((id >> 3) * UINT64_C(0x9e3779b97f4a7c15));
+}
+
+static size_t *slot_of(const struct graph *const graph, const uint64_t id) {
+    const size_t mask = graph->slots_count - 1;
+    for (size_t i = hash(id) & mask;; i = (i + 1) & mask) {
+        const size_t node = graph->slots[i];
+        if (!node || graph->ids[node] == id) {
+            return &graph->slots[i];
+        }
+    }
+}
+
+static size_t node_of(const struct graph *const graph, const uint64_t id) {
+    return graph->slots_count ? *slot_of(graph, id) : 0;
+}
+
+static void grow_slots(struct graph *const graph) {
+    const size_t count = graph->slots_count ? 2 * graph->slots_count : 1024;
+    free(graph->slots);
+    graph->slots = allocate(NULL, count, sizeof(*graph->slots));
+    memset(graph->slots, 0, count * sizeof(*graph->slots));
+    graph->slots_count = count;
+    for (size_t node = 1; node <= graph->count; node++) {
+        *slot_of(graph, graph->ids[node]) = node;
+    }
+}
+
+static size_t add_node(struct graph *const graph, const uint64_t id) {
+    if (node_of(graph, id)) {
+        die("dump contains a strong reference twice");
+    }
+    if (graph->count + 1 == graph->capacity) {
+        graph->capacity *= 2;
+        graph->ids = allocate(graph->ids, graph->capacity,
+                              sizeof(*graph->ids));
+        graph->type_ids = allocate(graph->type_ids, graph->capacity,
+                                   sizeof(*graph->type_ids));
+        graph->sizes = allocate(graph->sizes, graph->capacity,
+                                sizeof(*graph->sizes));
+        graph->counts = allocate(graph->counts, graph->capacity,
+                                 sizeof(*graph->counts));
+    }
+    const size_t node = ++graph->count;
+    graph->ids[node] = id;
+    if (2 * graph->count >= graph->slots_count) {
+        grow_slots(graph);
+    } else {
+        *slot_of(graph, id) = node;
+    }
+    return node;
+}
+
+static void read_graph(FILE *const file, struct graph *const graph) {
+    char magic[4];
+    if (sizeof(magic) != fread(magic, 1, sizeof(magic), file)
+        || memcmp(magic, "TFHD", sizeof(magic))) {
+        die("not a heap dump");
+    }
+    if (VERSION != get(file, 1)) {
+        die("unsupported heap dump version");
+    }
+    graph->capacity = 1024;
+    graph->ids = allocate(NULL, graph->capacity, sizeof(*graph->ids));
+    graph->type_ids = allocate(NULL, graph->capacity,
+                               sizeof(*graph->type_ids));
+    graph->sizes = allocate(NULL, graph->capacity, sizeof(*graph->sizes));
+    graph->counts = allocate(NULL, graph->capacity, sizeof(*graph->counts));
+    size_t last = 0;
+    for (;;) {
+        switch (get(file, 1)) {
+            default: {
+                die("dump contains an unknown record");
+            }
+            case 'T': {
+                struct type type = {.id = (uint32_t) get(file, 4)};
+                const size_t length = (size_t) get(file, 2);
+                type.name = allocate(NULL, length + 1, 1);
+                if (length != fread(type.name, 1, length, file)) {
+                    die("dump is truncated");
+                }
+                type.name[length] = 0;
+                graph->types = allocate(graph->types, graph->types_count + 1,
+                                        sizeof(*graph->types));
+                graph->types[graph->types_count++] = type;
+                break;
+            }
+            case 'N': {
+                last = add_node(graph, get(file, 8));
+                graph->type_ids[last] = (uint32_t) get(file, 4);
+                graph->sizes[last] = get(file, 8);
+                graph->counts[last] = get(file, 8);
+                break;
+            }
+            case 'E': {
+                const uint64_t from = get(file, 8);
+                const uint64_t to = get(file, 8);
+                if (!last || graph->ids[last] != from) {
+                    die("dump contains an edge outside of its node");
+                }
+                if (graph->edges_count == graph->edges_capacity) {
+                    graph->edges_capacity = graph->edges_capacity
+                                            ? 2 * graph->edges_capacity
+                                            : 1024;
+                    graph->edges = allocate(graph->edges,
+                                            graph->edges_capacity,
+                                            sizeof(*graph->edges));
+                }
+                graph->edges[graph->edges_count++] = (struct edge) {
+                        .from = last,
+                        .to = to
+                };
+                break;
+            }
+            case 'Z': {
+                return;
+            }
+        }
+    }
+}
+
+static const char *name_of(const struct graph *const graph,
+                           const uint32_t id) {
+    for (size_t i = 0; i < graph->types_count; i++) {
+        if (graph->types[i].id == id) {
+            return graph->types[i].name;
+        }
+    }
+    return "?";
+}
+
+/* adjacency of every node in compressed sparse row form */
+struct adjacency {
+    size_t *first;
+    size_t *nodes;
+};
+
+static void adjacency_of(const size_t count,
+                         const size_t *const from,
+                         const size_t *const to,
+                         const size_t edges,
+                         struct adjacency *const out) {
+    out->first = allocate(NULL, count + 2, sizeof(*out->first));
+    memset(out->first, 0, (count + 2) * sizeof(*out->first));
+    out->nodes = allocate(NULL, edges, sizeof(*out->nodes));
+    for (size_t i = 0; i < edges; i++) {
+        out->first[from[i] + 2]++;
+    }
+    for (size_t node = 0; node < count; node++) {
+        out->first[node + 2] += out->first[node + 1];
+    }
+    for (size_t i = 0; i < edges; i++) {
+        out->nodes[out->first[from[i] + 1]++] = to[i];
+    }
+}
+
+struct frame {
+    size_t node;
+    size_t next;
+};
+
+/* mark every node reachable from start */
+static void reach(const struct adjacency *const successors,
+                  const size_t start,
+                  bool *const reached,
+                  size_t *const stack) {
+    size_t top = 0;
+    reached[start] = true;
+    stack[top++] = start;
+    while (top) {
+        const size_t node = stack[--top];
+        for (size_t i = successors->first[node];
+             i < successors->first[node + 1]; i++) {
+            const size_t next = successors->nodes[i];
+            if (!reached[next]) {
+                reached[next] = true;
+                stack[top++] = next;
+            }
+        }
+    }
+}
+
+static size_t intersect(const size_t *const idom,
+                        const size_t *const order,
+                        size_t a,
+                        size_t b) {
+    while (a != b) {
+        while (order[a] < order[b]) {
+            a = idom[a];
+        }
+        while (order[b] < order[a]) {
+            b = idom[b];
+        }
+    }
+    return a;
+}
+
+static const uint64_t *sort_by;
+
+static int compare(const void *const a, const void *const b) {
+    const uint64_t A = sort_by[*(const size_t *) a];
+    const uint64_t B = sort_by[*(const size_t *) b];
+    return A < B ? 1 : A > B ? -1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long top = 20;
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            char *end;
+            top = strtoul(argv[++i], &end, 10);
+            if (*end || !*argv[i]) {
+                die("usage: heap-dominators [-n count] [dump]");
+            }
+        } else if (!path && '-' != argv[i][0]) {
+            path = argv[i];
+        } else {
+            die("usage: heap-dominators [-n count] [dump]");
+        }
+    }
+    FILE *const file = path ? fopen(path, "rb") : stdin;
+    if (!file) {
+        die("could not open dump");
+    }
+    struct graph graph = {0};
+    read_graph(file, &graph);
+    if (path) {
+        fclose(file);
+    }
+    const size_t count = graph.count + 1;
+    /* resolve edges, a held strong reference may have been destroyed or be
+     * allocated in a region and therefore be missing from the dump */
+    size_t *from = allocate(NULL, graph.edges_count + count, sizeof(*from));
+    size_t *to = allocate(NULL, graph.edges_count + count, sizeof(*to));
+    uint64_t *held = allocate(NULL, count, sizeof(*held));
+    memset(held, 0, count * sizeof(*held));
+    size_t edges = 0;
+    for (size_t i = 0; i < graph.edges_count; i++) {
+        const size_t node = node_of(&graph, graph.edges[i].to);
+        if (node) {
+            from[edges] = graph.edges[i].from;
+            to[edges++] = node;
+            held[node]++;
+        }
+    }
+    const size_t resolved = edges;
+    for (size_t node = 1; node < count; node++) {
+        if (graph.counts[node] > held[node]) {
+            from[edges] = ROOT;
+            to[edges++] = node;
+        }
+    }
+    struct adjacency successors;
+    adjacency_of(count, from, to, edges, &successors);
+    bool *reached = allocate(NULL, count, sizeof(*reached));
+    memset(reached, 0, count * sizeof(*reached));
+    size_t *stack = allocate(NULL, edges + count, sizeof(*stack));
+    reach(&successors, ROOT, reached, stack);
+    bool *leaked = allocate(NULL, count, sizeof(*leaked));
+    memset(leaked, 0, count * sizeof(*leaked));
+    size_t leaks = 0;
+    for (size_t node = 1; node < count; node++) {
+        if (!reached[node]) {
+            leaked[node] = true;
+            leaks++;
+            from[edges] = ROOT;
+            to[edges++] = node;
+            reach(&successors, node, reached, stack);
+        }
+    }
+    if (leaks) {
+        free(successors.first);
+        free(successors.nodes);
+        adjacency_of(count, from, to, edges, &successors);
+    }
+    struct adjacency predecessors;
+    adjacency_of(count, to, from, edges, &predecessors);
+    /* number the nodes in depth first postorder */
+    size_t *order = allocate(NULL, count, sizeof(*order));
+    size_t *nodes = allocate(NULL, count, sizeof(*nodes));
+    struct frame *frames = allocate(NULL, count, sizeof(*frames));
+    memset(reached, 0, count * sizeof(*reached));
+    size_t numbered = 0;
+    size_t top_frame = 0;
+    reached[ROOT] = true;
+    frames[top_frame++] = (struct frame) {ROOT, successors.first[ROOT]};
+    while (top_frame) {
+        struct frame *const frame = &frames[top_frame - 1];
+        if (frame->next < successors.first[frame->node + 1]) {
+            const size_t next = successors.nodes[frame->next++];
+            if (!reached[next]) {
+                reached[next] = true;
+                frames[top_frame++] = (struct frame) {
+                        next, successors.first[next]
+                };
+            }
+            continue;
+        }
+        order[frame->node] = numbered;
+        nodes[numbered++] = frame->node;
+        top_frame--;
+    }
+    size_t *idom = allocate(NULL, count, sizeof(*idom));
+    for (size_t node = 0; node < count; node++) {
+        idom[node] = UNDEFINED;
+    }
+    idom[ROOT] = ROOT;
+    for (bool changed = true; changed;) {
+        changed = false;
+        /* reverse postorder without the root, which is numbered last */
+        for (size_t i = numbered - 1; i--;) {
+            const size_t node = nodes[i];
+            size_t dominator = UNDEFINED;
+            for (size_t j = predecessors.first[node];
+                 j < predecessors.first[node + 1]; j++) {
+                const size_t predecessor = predecessors.nodes[j];
+                if (UNDEFINED == idom[predecessor]) {
+                    continue;
+                }
+                dominator = UNDEFINED == dominator
+                            ? predecessor
+                            : intersect(idom, order, predecessor, dominator);
+            }
+            if (idom[node] != dominator) {
+                idom[node] = dominator;
+                changed = true;
+            }
+        }
+    }
+    /* a dominator is numbered after every node it dominates */
+    uint64_t *retained = allocate(NULL, count, sizeof(*retained));
+    retained[ROOT] = 0;
+    for (size_t node = 1; node < count; node++) {
+        retained[node] = graph.sizes[node];
+    }
+    for (size_t i = 0; i + 1 < numbered; i++) {
+        const size_t node = nodes[i];
+        retained[idom[node]] += retained[node];
+    }
+    printf("%zu strong references, %zu references between them, "
+           "%" PRIu64 " bytes, %zu cycles leaked\n",
+           graph.count, resolved, retained[ROOT], leaks);
+    size_t *ranked = allocate(NULL, count, sizeof(*ranked));
+    for (size_t node = 1; node < count; node++) {
+        ranked[node - 1] = node;
+    }
+    sort_by = retained;
+    qsort(ranked, graph.count, sizeof(*ranked), compare);
+    printf("%-18s %-24s %12s %12s %-18s\n",
+           "id", "type", "shallow", "retained", "dominator");
+    for (size_t i = 0; i < graph.count && i < top; i++) {
+        const size_t node = ranked[i];
+        char dominator[19];
+        if (ROOT == idom[node]) {
+            snprintf(dominator, sizeof(dominator), "%s",
+                     leaked[node] ? "leaked" : "root");
+        } else {
+            snprintf(dominator, sizeof(dominator), "0x%" PRIx64,
+                     graph.ids[idom[node]]);
+        }
+        printf("0x%-16" PRIx64 " %-24s %12" PRIu64 " %12" PRIu64 " %-18s\n",
+               graph.ids[node],
+               graph.type_ids[node]
+               ? name_of(&graph, graph.type_ids[node])
+               : "-",
+               graph.sizes[node], retained[node], dominator);
+    }
+    free(ranked);
+    free(retained);
+    free(idom);
+    free(frames);
+    free(nodes);
+    free(order);
+    free(predecessors.first);
+    free(predecessors.nodes);
+    free(leaked);
+    free(stack);
+    free(reached);
+    free(successors.first);
+    free(successors.nodes);
+    free(held);
+    free(to);
+    free(from);
+    for (size_t i = 0; i < graph.types_count; i++) {
+        free(graph.types[i].name);
+    }
+    free(graph.types);
+    free(graph.ids);
+    free(graph.type_ids);
+    free(graph.sizes);
+    free(graph.counts);
+    free(graph.edges);
+    free(graph.slots);
+    return EXIT_SUCCESS;
+}